@@ -0,0 +1,49 @@
+#include "AsOfCatalog.hpp"
+
+AsOfCatalog::AsOfCatalog(const PriceHistory& history, int64_t time) :
+    mHistory(history), mTime(time), mEpoch(0), mItems{}
+{}
+
+const Item* AsOfCatalog::findItem(std::string_view name) const {
+    auto it = mItems.find(name);
+    if (it != mItems.end()) {
+        return &it->second;
+    }
+    return cache(mHistory.getItemAsOf(name, mTime));
+}
+
+const Item* AsOfCatalog::findItemByGtin(uint64_t gtin) const {
+    std::optional<Item> item = mHistory.getItemAsOfGtin(gtin, mTime);
+    if (!item) {
+        return nullptr;
+    }
+    auto it = mItems.find(item->getName());
+    if (it != mItems.end()) {
+        return &it->second;
+    }
+    return cache(std::move(item));
+}
+
+uint64_t AsOfCatalog::getEpoch() const {
+    return mEpoch;
+}
+
+int64_t AsOfCatalog::getTime() const {
+    return mTime;
+}
+
+void AsOfCatalog::setTime(int64_t time) {
+    if (time != mTime) {
+        mTime = time;
+        mItems.clear();
+        ++mEpoch;
+    }
+}
+
+const Item* AsOfCatalog::cache(std::optional<Item> item) const {
+    if (!item) {
+        return nullptr;
+    }
+    std::string name = item->getName();
+    return &mItems.emplace(std::move(name), std::move(*item)).first->second;
+}
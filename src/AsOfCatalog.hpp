@@ -0,0 +1,51 @@
+#ifndef __ASOFCATALOG_HPP__
+#define __ASOFCATALOG_HPP__
+
+#include "ItemCatalog.hpp"
+#include "PriceHistory.hpp"
+#include "StringHash.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// ItemCatalog view of a PriceHistory at one point in time, so an Order can reprice a basket as
+// it would have been priced then. Items are built from the history the first time they are
+// looked up and kept until the time is changed. For a time not yet recorded, an item already
+// looked up keeps its pricing, but one first looked up after a later record is built from that
+// record. Not thread safe.
+class AsOfCatalog : public ItemCatalog {
+public:
+    // Constructor. History must outlive the view
+    AsOfCatalog(const PriceHistory& history, int64_t time);
+
+    // Returns pointer to item as priced at the time of the view or nullptr if not recorded by
+    // then. Pointer is invalidated when the time is changed
+    const Item* findItem(std::string_view name) const override;
+
+    // Returns pointer to item with the given GTIN as priced at the time of the view or nullptr
+    const Item* findItemByGtin(uint64_t gtin) const override;
+
+    // Return current epoch. Incremented whenever the time is changed
+    uint64_t getEpoch() const override;
+
+    // Return time of the view
+    int64_t getTime() const;
+
+    // Move the view to another point in time. Items found before are invalidated
+    void setTime(int64_t time);
+
+private:
+    // Keep item in the view. Returns pointer to the kept item or nullptr if there is no item
+    const Item* cache(std::optional<Item> item) const;
+
+private:
+    const PriceHistory& mHistory;   // History the view reads
+    int64_t mTime;                  // Point in time of the view
+    uint64_t mEpoch;                // Number of time changes
+    mutable std::unordered_map<std::string, Item, StringHash, std::equal_to<>> mItems; // Items built so far by name
+};
+
+#endif
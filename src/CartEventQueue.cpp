@@ -0,0 +1,50 @@
+#include "CartEventQueue.hpp"
+
+#include <algorithm>
+#include <bit>
+
+CartEventQueue::CartEventQueue(std::size_t capacity) :
+    mEvents(std::bit_ceil(std::max<std::size_t>(capacity, 1))), mMask(mEvents.size() - 1),
+    mHead(0), mCachedTail(0), mTail(0), mCachedHead(0), mOverflow(false)
+{}
+
+bool CartEventQueue::push(const CartEvent& event) {
+    const std::size_t tail = mTail.load(std::memory_order_relaxed);
+
+    // Only read the consumer position again when the queue looks full
+    if (tail - mCachedHead == mEvents.size()) {
+        mCachedHead = mHead.load(std::memory_order_acquire);
+        if (tail - mCachedHead == mEvents.size()) {
+            mOverflow.store(true, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    mEvents[tail & mMask] = event;
+    mTail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool CartEventQueue::pop(CartEvent& event) {
+    const std::size_t head = mHead.load(std::memory_order_relaxed);
+
+    // Only read the producer position again when the queue looks empty
+    if (head == mCachedTail) {
+        mCachedTail = mTail.load(std::memory_order_acquire);
+        if (head == mCachedTail) {
+            return false;
+        }
+    }
+
+    event = mEvents[head & mMask];
+    mHead.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+bool CartEventQueue::takeOverflow() {
+    return mOverflow.exchange(false, std::memory_order_relaxed);
+}
+
+std::size_t CartEventQueue::getCapacity() const {
+    return mEvents.size();
+}
@@ -0,0 +1,64 @@
+#ifndef __CARTEVENTQUEUE_HPP__
+#define __CARTEVENTQUEUE_HPP__
+
+#include "Special.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Change of an order sent to customer displays
+struct CartEvent {
+    enum class Type_t : uint8_t { LineAdded, LineChanged, LineRemoved, SpecialApplied, TotalChanged };
+
+    static constexpr std::size_t kNameSize = 32; // Size of the name buffer including the terminator
+
+    Type_t type;
+    uint64_t sequence;      // Sequence of the line the event is about. Unused for TotalChanged
+    char name[kNameSize];   // Item name, truncated to fit and null terminated. Empty for TotalChanged
+    float amount;           // Quantity or weight of the line after the change
+    float price;            // Price of the line after the change, or order total for TotalChanged
+    float savings;          // Discount of the special on the line, or order savings for TotalChanged
+    SpecialParams special;  // Special of the line
+};
+
+// Bounded single-producer/single-consumer queue of cart events. The order thread pushes and one
+// display thread pops, neither takes a lock or allocates. When the display falls behind and the
+// queue fills up, further events are dropped and the queue is marked overflowed; the display
+// should then clear the flag and rebuild its view from Order::getReceipt.
+class CartEventQueue {
+public:
+    // Constructor. Capacity is rounded up to a power of two and allocated up front
+    explicit CartEventQueue(std::size_t capacity);
+
+    CartEventQueue(const CartEventQueue&) = delete;
+    CartEventQueue& operator=(const CartEventQueue&) = delete;
+
+    // Add event to the queue. Producer only. Returns false and marks the queue overflowed if full
+    bool push(const CartEvent& event);
+
+    // Take the oldest event from the queue into event. Consumer only. Returns false if empty
+    bool pop(CartEvent& event);
+
+    // Returns true if events were dropped since the last call and clears the flag. Consumer only
+    bool takeOverflow();
+
+    // Return maximum number of queued events
+    std::size_t getCapacity() const;
+
+private:
+    std::vector<CartEvent> mEvents;     // Ring buffer of events
+    std::size_t mMask;                  // Capacity - 1
+
+    // Consumer side. Kept on its own cache line so the two threads dont invalidate each other
+    alignas(64) std::atomic<std::size_t> mHead; // Position of the next event to pop
+    std::size_t mCachedTail;                    // Last tail seen by the consumer
+
+    // Producer side
+    alignas(64) std::atomic<std::size_t> mTail; // Position of the next event to push
+    std::size_t mCachedHead;                    // Last head seen by the producer
+    std::atomic<bool> mOverflow;                // Events were dropped
+};
+
+#endif
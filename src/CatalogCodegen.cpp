@@ -0,0 +1,121 @@
+#include "CatalogCodegen.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+namespace {
+// Returns true if name is a valid C++ identifier
+bool isIdentifier(const std::string& name) {
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) {
+        return false;
+    }
+    return std::all_of(name.begin(), name.end(), [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; });
+}
+
+// Write str as a C++ string literal
+void writeString(std::ostream& out, const std::string& str) {
+    out << '"';
+    for (char c : str) {
+        const unsigned char uc = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (std::isprint(uc)) {
+            out << c;
+        } else {
+            // Octal escapes stop after three digits, so they cant swallow the next character
+            out << '\\' << std::oct << std::setw(3) << std::setfill('0') << static_cast<unsigned int>(uc) << std::dec;
+        }
+    }
+    out << '"';
+}
+
+// Write value as a float literal that reads back exactly
+void writeFloat(std::ostream& out, float value) {
+    std::ostringstream str;
+    str << std::setprecision(std::numeric_limits<float>::max_digits10) << value;
+    out << str.str();
+    if (str.str().find_first_of(".e") == std::string::npos) {
+        out << ".0";
+    }
+    out << 'f';
+}
+
+// Returns name of the enumerator of a special type
+const char* specialTypeName(SpecialParams::Type_t type) {
+    switch (type) {
+        case SpecialParams::Type_t::BuyOneGetOneUnit:   return "BuyOneGetOneUnit";
+        case SpecialParams::Type_t::BuyOneGetOneWeight: return "BuyOneGetOneWeight";
+        case SpecialParams::Type_t::NforX:              return "NforX";
+        default:                                        return "None";
+    }
+}
+}
+
+bool writeCatalogHeader(const ItemDatabase& db, const std::string& typeName, std::ostream& out) {
+    if (!isIdentifier(typeName)) {
+        std::cerr << "Invalid catalog type name" << std::endl;
+        return false;
+    }
+
+    // Items are sorted by name and GTINs by number so StaticOrder can binary search them
+    const std::vector<Item>& items = db.getItems();
+    std::vector<const Item*> sorted;
+    sorted.reserve(items.size());
+    for (const auto& item : items) {
+        sorted.push_back(&item);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const Item* a, const Item* b) { return a->getName() < b->getName(); });
+
+    std::vector<std::pair<uint64_t, std::size_t>> gtins;
+    for (std::size_t i = 0; i < sorted.size(); ++i) {
+        if (sorted[i]->getGtin() != 0) {
+            gtins.emplace_back(sorted[i]->getGtin(), i);
+        }
+    }
+    std::sort(gtins.begin(), gtins.end());
+
+    std::string guard = typeName;
+    std::transform(guard.begin(), guard.end(), guard.begin(), [](unsigned char c) { return std::toupper(c); });
+
+    out << "// Generated by catalog_codegen. Do not edit\n"
+        << "#ifndef __" << guard << "_HPP__\n"
+        << "#define __" << guard << "_HPP__\n\n"
+        << "#include \"StaticCatalog.hpp\"\n\n"
+        << "#include <array>\n\n"
+        << "struct " << typeName << " {\n"
+        << "    static constexpr std::array<StaticItem, " << sorted.size() << "> kItems = {{\n";
+    for (const Item* item : sorted) {
+        const SpecialParams special = item->getSpecial() ? item->getSpecial()->getParams() : SpecialParams{};
+        out << "        { ";
+        writeString(out, item->getName());
+        out << ", Item::Sale_t::" << ((Item::Sale_t::Unit == item->getSaleType()) ? "Unit" : "Weight") << ", ";
+        writeFloat(out, item->getPrice());
+        out << ", ";
+        writeFloat(out, item->getMarkdown());
+        out << ", " << item->getGtin() << "ULL, " << static_cast<unsigned int>(item->getTaxCategory())
+            << ", { SpecialParams::Type_t::" << specialTypeName(special.type) << ", ";
+        writeFloat(out, special.needed);
+        out << ", ";
+        writeFloat(out, special.receive);
+        out << ", ";
+        writeFloat(out, special.value);
+        out << ", ";
+        writeFloat(out, special.limit);
+        out << " } },\n";
+    }
+    out << "    }};\n\n"
+        << "    static constexpr std::array<StaticGtin, " << gtins.size() << "> kGtins = {{\n";
+    for (const auto& [gtin, index] : gtins) {
+        out << "        { " << gtin << "ULL, " << index << " },\n";
+    }
+    out << "    }};\n"
+        << "};\n\n"
+        << "#endif\n";
+
+    return static_cast<bool>(out);
+}
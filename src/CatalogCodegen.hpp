@@ -0,0 +1,14 @@
+#ifndef __CATALOGCODEGEN_HPP__
+#define __CATALOGCODEGEN_HPP__
+
+#include "ItemDatabase.hpp"
+
+#include <ostream>
+#include <string>
+
+// Write a header defining struct typeName with the items of the database as constexpr tables
+// for StaticOrder (see StaticCatalog.hpp). Prices are written with enough digits to read back
+// exactly. Type name must be a valid identifier. Returns status of operation
+bool writeCatalogHeader(const ItemDatabase& db, const std::string& typeName, std::ostream& out);
+
+#endif
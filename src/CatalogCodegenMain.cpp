@@ -0,0 +1,40 @@
+#include "CatalogCodegen.hpp"
+#include "CatalogFile.hpp"
+#include "ItemDatabase.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+int main(int argc, char* argv[]) {
+    if (argc != 4) {
+        std::cerr << "Usage: " << argv[0] << " <catalog-file> <output-header> <type-name>" << std::endl;
+        return 1;
+    }
+
+    ItemDatabase db;
+    if (!loadCatalogFile(argv[1], db)) {
+        return 1;
+    }
+
+    std::ostringstream header;
+    if (!writeCatalogHeader(db, argv[3], header)) {
+        return 1;
+    }
+
+    // Leave an unchanged header alone so targets including it are not rebuilt
+    std::ifstream current(argv[2], std::ios::binary);
+    std::ostringstream existing;
+    existing << current.rdbuf();
+    if (current && existing.str() == header.str()) {
+        return 0;
+    }
+
+    std::ofstream out(argv[2], std::ios::binary);
+    out << header.str();
+    if (!out) {
+        std::cerr << "Could not write " << argv[2] << std::endl;
+        return 1;
+    }
+    return 0;
+}
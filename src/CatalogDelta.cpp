@@ -0,0 +1,177 @@
+#include "CatalogDelta.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+// Split a record line into its comma separated fields
+std::vector<std::string> splitFields(const std::string& line) {
+    std::vector<std::string> fields;
+    std::stringstream ss(line);
+    std::string field;
+    while (std::getline(ss, field, ',')) {
+        fields.push_back(field);
+    }
+    return fields;
+}
+
+// Parse a float field. Returns status of operation
+bool parseFloat(const std::string& field, float& value) {
+    char* end = nullptr;
+    value = std::strtof(field.c_str(), &end);
+    return !field.empty() && end == field.c_str() + field.size();
+}
+
+// Parse an unsigned integer field. Returns status of operation
+bool parseUnsigned(const std::string& field, unsigned int& value) {
+    char* end = nullptr;
+    unsigned long parsed = std::strtoul(field.c_str(), &end, 10);
+    value = static_cast<unsigned int>(parsed);
+    return !field.empty() && field[0] != '-' && end == field.c_str() + field.size();
+}
+
+// Parse a GTIN field. Leading zeros are allowed. Returns status of operation
+bool parseGtin(const std::string& field, uint64_t& value) {
+    char* end = nullptr;
+    value = std::strtoull(field.c_str(), &end, 10);
+    return !field.empty() && field[0] != '-' && end == field.c_str() + field.size();
+}
+}
+
+bool CatalogDelta::parse(std::istream& in) {
+    std::string line;
+    unsigned int lineNum = 0;
+    while (std::getline(in, line)) {
+        ++lineNum;
+        // Accept files saved with Windows line endings
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        auto fields = splitFields(line);
+        const std::string& type = fields[0];
+        bool ok = false;
+
+        if (type == "item" && (fields.size() == 4 || fields.size() == 5)) {
+            float price;
+            uint64_t gtin = 0;
+            if (parseFloat(fields[3], price) && (fields[2] == "unit" || fields[2] == "weight") &&
+                (fields.size() == 4 || parseGtin(fields[4], gtin))) {
+                insertItem(fields[1], fields[2] == "unit" ? Item::Sale_t::Unit : Item::Sale_t::Weight, price, gtin);
+                ok = true;
+            }
+        } else if (type == "price" && fields.size() == 3) {
+            float price;
+            if ((ok = parseFloat(fields[2], price))) {
+                setItemPrice(fields[1], price);
+            }
+        } else if (type == "markdown" && fields.size() == 3) {
+            float markdown;
+            if ((ok = parseFloat(fields[2], markdown))) {
+                setItemMarkdown(fields[1], markdown);
+            }
+        } else if (type == "bogo" && (fields.size() == 5 || fields.size() == 6)) {
+            float needed, receive, percent, limit = 0;
+            if ((ok = parseFloat(fields[2], needed) && parseFloat(fields[3], receive) && parseFloat(fields[4], percent) &&
+                      (fields.size() == 5 || parseFloat(fields[5], limit)))) {
+                setItemBogo(fields[1], needed, receive, percent, limit);
+            }
+        } else if (type == "nforx" && (fields.size() == 4 || fields.size() == 5)) {
+            unsigned int needed, limit = 0;
+            float price;
+            if ((ok = parseUnsigned(fields[2], needed) && parseFloat(fields[3], price) &&
+                      (fields.size() == 4 || parseUnsigned(fields[4], limit)))) {
+                setItemNforX(fields[1], needed, price, limit);
+            }
+        } else if (type == "nospecial" && fields.size() == 2) {
+            clearItemSpecial(fields[1]);
+            ok = true;
+        } else if (type == "tax" && fields.size() == 3) {
+            unsigned int category;
+            if ((ok = parseUnsigned(fields[2], category))) {
+                setItemTaxCategory(fields[1], category);
+            }
+        }
+
+        if (!ok) {
+            std::cerr << "Invalid catalog record on line " << lineNum << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CatalogDelta::parseFile(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Unable to open catalog file " << path << std::endl;
+        return false;
+    }
+    return parse(in);
+}
+
+void CatalogDelta::insertItem(const std::string& name, Item::Sale_t type, float price, uint64_t gtin) {
+    Change change{Change::Type_t::Insert, name};
+    change.saleType = type;
+    change.price = price;
+    change.gtin = gtin;
+    mChanges.push_back(change);
+}
+
+void CatalogDelta::setItemPrice(const std::string& name, float price) {
+    Change change{Change::Type_t::Price, name};
+    change.price = price;
+    mChanges.push_back(change);
+}
+
+void CatalogDelta::setItemMarkdown(const std::string& name, float markdown) {
+    Change change{Change::Type_t::Markdown, name};
+    change.price = markdown;
+    mChanges.push_back(change);
+}
+
+void CatalogDelta::setItemBogo(const std::string& name, float needed, float receive, float percent, float limit) {
+    Change change{Change::Type_t::Bogo, name};
+    change.needed = needed;
+    change.receive = receive;
+    change.price = percent;
+    change.limit = limit;
+    mChanges.push_back(change);
+}
+
+void CatalogDelta::setItemNforX(const std::string& name, unsigned int needed, float price, unsigned int limit) {
+    Change change{Change::Type_t::NforX, name};
+    change.needed = static_cast<float>(needed);
+    change.price = price;
+    change.limit = static_cast<float>(limit);
+    mChanges.push_back(change);
+}
+
+void CatalogDelta::clearItemSpecial(const std::string& name) {
+    mChanges.push_back({Change::Type_t::ClearSpecial, name});
+}
+
+void CatalogDelta::setItemSpecial(const std::string& name, const std::shared_ptr<Special>& special) {
+    Change change{Change::Type_t::Special, name};
+    change.special = special;
+    mChanges.push_back(change);
+}
+
+void CatalogDelta::setItemTaxCategory(const std::string& name, unsigned int category) {
+    Change change{Change::Type_t::TaxCategory, name};
+    change.taxCategory = category;
+    mChanges.push_back(change);
+}
+
+const std::vector<CatalogDelta::Change>& CatalogDelta::getChanges() const {
+    return mChanges;
+}
+
+std::size_t CatalogDelta::size() const {
+    return mChanges.size();
+}
@@ -0,0 +1,87 @@
+#ifndef __CATALOGDELTA_HPP__
+#define __CATALOGDELTA_HPP__
+
+#include "Item.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Set of catalog changes applied to an ItemDatabase as one unit. Either every change is
+// applied or none are.
+//
+// Deltas are stored as plain text with one comma separated record per line. Empty lines and
+// lines starting with '#' are ignored. Records:
+//   item,<name>,unit|weight,<price>[,<gtin>]
+//   price,<name>,<price>
+//   markdown,<name>,<markdown>
+//   bogo,<name>,<needed>,<receive>,<percent>[,<limit>]   (unit or weight based on the item)
+//   nforx,<name>,<needed>,<price>[,<limit>]
+//   nospecial,<name>
+//   tax,<name>,<category>
+class CatalogDelta {
+public:
+    // Single change to the catalog
+    struct Change {
+        enum class Type_t { Insert, Price, Markdown, Bogo, NforX, ClearSpecial, TaxCategory, Special };
+
+        Type_t type;
+        std::string name;
+        Item::Sale_t saleType = Item::Sale_t::Unit; // Sale type of inserted item
+        float price = 0;    // Price, markdown, NforX price or BOGO percent off
+        float needed = 0;   // Amount needed for special
+        float receive = 0;  // Amount received by BOGO special
+        float limit = 0;    // Limit of special. 0 = no limit
+        uint64_t gtin = 0;  // GTIN of inserted item. 0 = none
+        unsigned int taxCategory = 0; // Tax category
+        std::shared_ptr<Special> special = nullptr; // Special to set. nullptr = none
+    };
+
+    // Default constructor
+    CatalogDelta() {}
+
+    // Append all records in the stream. Stops at the first invalid record. Returns status of operation
+    bool parse(std::istream& in);
+
+    // Append all records in the file at path. Returns status of operation
+    bool parseFile(const std::string& path);
+
+    // Add a new item with an optional GTIN
+    void insertItem(const std::string& name, Item::Sale_t type, float price, uint64_t gtin = 0);
+
+    // Set a new price for an item
+    void setItemPrice(const std::string& name, float price);
+
+    // Set a new markdown for an item
+    void setItemMarkdown(const std::string& name, float markdown);
+
+    // Set the BOGO special for an item. Amounts must be whole numbers for items sold by unit
+    void setItemBogo(const std::string& name, float needed, float receive, float percent, float limit = 0);
+
+    // Set the NforX special for an item
+    void setItemNforX(const std::string& name, unsigned int needed, float price, unsigned int limit = 0);
+
+    // Remove the special of an item
+    void clearItemSpecial(const std::string& name);
+
+    // Set an already built special, or nullptr to remove the special of an item. Not available
+    // as a record since it is meant for specials shared between deltas
+    void setItemSpecial(const std::string& name, const std::shared_ptr<Special>& special);
+
+    // Set the tax category of an item
+    void setItemTaxCategory(const std::string& name, unsigned int category);
+
+    // Return changes in the order they were added
+    const std::vector<Change>& getChanges() const;
+
+    // Return number of changes
+    std::size_t size() const;
+
+private:
+    std::vector<Change> mChanges; // Changes to apply
+};
+
+#endif
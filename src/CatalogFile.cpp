@@ -0,0 +1,12 @@
+#include "CatalogFile.hpp"
+#include "CatalogDelta.hpp"
+
+bool loadCatalog(std::istream& in, ItemDatabase& db) {
+    CatalogDelta delta;
+    return delta.parse(in) && db.applyDelta(delta);
+}
+
+bool loadCatalogFile(const std::string& path, ItemDatabase& db) {
+    CatalogDelta delta;
+    return delta.parseFile(path) && db.applyDelta(delta);
+}
@@ -0,0 +1,19 @@
+#ifndef __CATALOGFILE_HPP__
+#define __CATALOGFILE_HPP__
+
+#include "ItemDatabase.hpp"
+
+#include <istream>
+#include <string>
+
+// Catalog files use the same record format as catalog deltas (see CatalogDelta.hpp). A full
+// catalog is simply a delta applied to an empty database.
+
+// Load all records from the stream into the database. Nothing is loaded if any record is
+// invalid. Returns status of operation
+bool loadCatalog(std::istream& in, ItemDatabase& db);
+
+// Load all records from the file at path into the database. Returns status of operation
+bool loadCatalogFile(const std::string& path, ItemDatabase& db);
+
+#endif
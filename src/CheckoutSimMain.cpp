@@ -0,0 +1,302 @@
+#include "ItemDatabase.hpp"
+#include "Order.hpp"
+#include "ReplicatedCatalog.hpp"
+#include "StoreWorkload.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+// Simulation settings besides the workload shape
+struct SimConfig {
+    unsigned int lanes = 8;         // Number of lanes, one thread each
+    std::size_t orders = 2000;      // Orders completed per lane
+    std::size_t open = 4;           // Orders open at the same time per lane
+    bool replicate = false;         // Replicate the catalog per NUMA node and pin lanes to nodes
+};
+
+// Histogram of latencies in nanoseconds with 32 buckets per power of two, about 3% resolution
+class LatencyHistogram {
+public:
+    void add(uint64_t ns) {
+        ++mCounts[bucket(ns)];
+        ++mCount;
+        mMax = std::max(mMax, ns);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (std::size_t i = 0; i < kNumBuckets; ++i) {
+            mCounts[i] += other.mCounts[i];
+        }
+        mCount += other.mCount;
+        mMax = std::max(mMax, other.mMax);
+    }
+
+    // Returns lower bound of the bucket holding the given fraction of samples
+    uint64_t percentile(double fraction) const {
+        const uint64_t target = static_cast<uint64_t>(fraction * mCount);
+        uint64_t seen = 0;
+        for (std::size_t i = 0; i < kNumBuckets; ++i) {
+            seen += mCounts[i];
+            if (seen > target) {
+                return lowerBound(i);
+            }
+        }
+        return mMax;
+    }
+
+    uint64_t getCount() const { return mCount; }
+    uint64_t getMax() const { return mMax; }
+
+private:
+    static constexpr std::size_t kSubBuckets = 32;
+    static constexpr std::size_t kNumBuckets = 64 * kSubBuckets;
+
+    static std::size_t bucket(uint64_t ns) {
+        if (ns < kSubBuckets) {
+            return ns;
+        }
+        const unsigned int exponent = std::bit_width(ns) - 1;
+        const uint64_t sub = (ns >> (exponent - 5)) & (kSubBuckets - 1);
+        return (exponent - 4) * kSubBuckets + sub;
+    }
+
+    static uint64_t lowerBound(std::size_t b) {
+        if (b < kSubBuckets) {
+            return b;
+        }
+        const unsigned int exponent = static_cast<unsigned int>(b / kSubBuckets) + 4;
+        return (uint64_t(1) << exponent) | (uint64_t(b % kSubBuckets) << (exponent - 5));
+    }
+
+    std::array<uint64_t, kNumBuckets> mCounts{};
+    uint64_t mCount = 0;
+    uint64_t mMax = 0;
+};
+
+// Results of one lane
+struct LaneResult {
+    LatencyHistogram scans;     // Latency of scans
+    LatencyHistogram removals;  // Latency of removals
+    std::size_t orders = 0;     // Orders completed
+    double revenue = 0;         // Sum of order totals, to compare runs
+};
+
+// Open order of a lane and the basket it works through
+struct OpenOrder {
+    std::optional<Order> order;
+    std::vector<StoreWorkload::Action> basket;
+    std::size_t next = 0;
+};
+
+// Returns value in kB of a field of /proc/self/status or 0 if unavailable
+std::size_t readStatusKb(const std::string& field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, field.size() + 1, field + ":") == 0) {
+            return std::strtoull(line.c_str() + field.size() + 1, nullptr, 10);
+        }
+    }
+    return 0;
+}
+
+// Time a single order operation
+template <typename Op>
+bool timed(LatencyHistogram& histogram, Op op) {
+    const auto start = std::chrono::steady_clock::now();
+    const bool ok = op();
+    const auto end = std::chrono::steady_clock::now();
+    histogram.add(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    return ok;
+}
+
+// Run the orders of one lane, interleaving its open orders one action at a time
+void runLane(const StoreWorkload& workload, const ItemDatabase& db, const SimConfig& config, unsigned int lane, LaneResult& result) {
+    std::mt19937_64 rng(workload.getParams().seed * 1000003 + lane + 1);
+    std::vector<OpenOrder> open(std::max<std::size_t>(config.open, 1));
+    std::size_t started = 0;
+
+    auto start = [&](OpenOrder& slot) {
+        if (started == config.orders) {
+            slot.order.reset();
+            return;
+        }
+        ++started;
+        // Orders are reused like a lane would, so steady state scans dont allocate
+        if (slot.order) {
+            slot.order->Reset();
+        } else {
+            slot.order.emplace(db);
+        }
+        workload.generateBasket(rng, slot.basket);
+        slot.next = 0;
+    };
+    for (auto& slot : open) {
+        start(slot);
+    }
+
+    bool busy = true;
+    while (busy) {
+        busy = false;
+        for (auto& slot : open) {
+            if (!slot.order) {
+                continue;
+            }
+            busy = true;
+
+            const StoreWorkload::Action& action = slot.basket[slot.next++];
+            const std::string& name = workload.getName(action.item);
+            Order& order = *slot.order;
+            const bool byWeight = (Item::Sale_t::Weight == workload.getSaleType(action.item));
+            if (StoreWorkload::Action::Type_t::Scan == action.type) {
+                timed(result.scans, [&]() { return byWeight ? order.ScanItem(name, action.weight) : order.ScanItem(name); });
+            } else {
+                timed(result.removals, [&]() { return byWeight ? order.RemoveItem(name, action.weight) : order.RemoveItem(name, 1U); });
+            }
+
+            if (slot.next == slot.basket.size()) {
+                result.revenue += order.getTotalPrice();
+                ++result.orders;
+                start(slot);
+            }
+        }
+    }
+}
+
+void printLatency(const char* label, const LatencyHistogram& histogram) {
+    std::cout << std::left << std::setw(10) << label << std::right << std::setw(12) << histogram.getCount()
+              << std::setw(8) << histogram.percentile(0.5) << std::setw(8) << histogram.percentile(0.9)
+              << std::setw(8) << histogram.percentile(0.99) << std::setw(9) << histogram.percentile(0.999)
+              << std::setw(10) << histogram.getMax() << std::endl;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --items N            Items in the catalog (50000)\n"
+              << "  --lanes N            Lanes, one thread each (8)\n"
+              << "  --orders N           Orders per lane (2000)\n"
+              << "  --open N             Orders open at the same time per lane (4)\n"
+              << "  --zipf S             Zipf exponent of item popularity (1.0)\n"
+              << "  --basket N           Average scans per basket (25)\n"
+              << "  --weight-share F     Share of items sold by weight (0.15)\n"
+              << "  --void-rate F        Share of scans voided (0.02)\n"
+              << "  --markdown-share F   Share of items with a markdown (0.10)\n"
+              << "  --bogo-unit F        Share of unit items with a BOGO special (0.05)\n"
+              << "  --nforx F            Share of unit items with an NforX special (0.05)\n"
+              << "  --bogo-weight F      Share of weight items with a BOGO special (0.05)\n"
+              << "  --replicate 0|1      Catalog replica per NUMA node, lanes pinned to nodes (0)\n"
+              << "  --seed N             Random seed (1)" << std::endl;
+}
+
+// Parse command line into params and config. Returns status of operation
+bool parseArgs(int argc, char* argv[], StoreWorkload::Params& params, SimConfig& config) {
+    for (int i = 1; i < argc; i += 2) {
+        const std::string option = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        char* end = nullptr;
+        const double value = std::strtod(argv[i + 1], &end);
+        if (*end != '\0' || value < 0) {
+            return false;
+        }
+
+        if (option == "--items") params.numItems = static_cast<std::size_t>(value);
+        else if (option == "--lanes") config.lanes = std::max(1U, static_cast<unsigned int>(value));
+        else if (option == "--orders") config.orders = static_cast<std::size_t>(value);
+        else if (option == "--open") config.open = static_cast<std::size_t>(value);
+        else if (option == "--zipf") params.zipfExponent = value;
+        else if (option == "--basket") params.meanBasketSize = value;
+        else if (option == "--weight-share") params.weightShare = value;
+        else if (option == "--void-rate") params.voidRate = value;
+        else if (option == "--markdown-share") params.markdownShare = value;
+        else if (option == "--bogo-unit") params.bogoUnitShare = value;
+        else if (option == "--nforx") params.nforxShare = value;
+        else if (option == "--bogo-weight") params.bogoWeightShare = value;
+        else if (option == "--replicate") config.replicate = (value != 0);
+        else if (option == "--seed") params.seed = static_cast<uint64_t>(value);
+        else return false;
+    }
+
+    // Baskets are drawn from the catalog, so it cannot be empty
+    return params.numItems > 0;
+}
+}
+
+int main(int argc, char* argv[]) {
+    StoreWorkload::Params params;
+    SimConfig config;
+    if (!parseArgs(argc, argv, params, config)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    const std::size_t rssStart = readStatusKb("VmRSS");
+    const auto loadStart = std::chrono::steady_clock::now();
+    StoreWorkload workload(params);
+    ItemDatabase db;
+    if (!workload.fillCatalog(db)) {
+        std::cerr << "Could not build catalog" << std::endl;
+        return 1;
+    }
+    std::optional<ReplicatedCatalog> replicas;
+    if (config.replicate) {
+        replicas.emplace(db);
+    }
+    const double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+    const std::size_t rssCatalog = readStatusKb("VmRSS");
+
+    std::vector<LaneResult> results(config.lanes);
+    std::vector<std::thread> lanes;
+    const auto runStart = std::chrono::steady_clock::now();
+    for (unsigned int l = 0; l < config.lanes; ++l) {
+        lanes.emplace_back([&, l]() {
+            std::shared_ptr<const ItemDatabase> replica;
+            if (replicas) {
+                replicas->pinLane(l);
+                replica = replicas->getReplica(replicas->getLaneNode(l));
+            }
+            runLane(workload, replica ? *replica : db, config, l, results[l]);
+        });
+    }
+    for (auto& lane : lanes) {
+        lane.join();
+    }
+    const double runSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+
+    LaneResult total;
+    for (const auto& result : results) {
+        total.scans.merge(result.scans);
+        total.removals.merge(result.removals);
+        total.orders += result.orders;
+        total.revenue += result.revenue;
+    }
+    const uint64_t operations = total.scans.getCount() + total.removals.getCount();
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "Catalog     " << params.numItems << " items loaded in " << loadSeconds << " s\n"
+              << "Run         " << config.lanes << " lanes on "
+              << (replicas ? replicas->getTopology().getNumNodes() : 1U) << " catalog replicas, " << total.orders << " orders, " << operations << " operations in "
+              << runSeconds << " s\n"
+              << "Throughput  " << operations / runSeconds << " operations/s, " << total.orders / runSeconds << " orders/s\n"
+              << "Revenue     " << total.revenue << "\n"
+              << "Memory      " << rssCatalog - std::min(rssCatalog, rssStart) << " kB catalog (" << db.memoryBytes() / 1024
+              << " kB counted), " << readStatusKb("VmHWM")
+              << " kB peak resident\n\n"
+              << "Latency (ns)       count     p50     p90     p99    p99.9       max\n";
+    printLatency("scan", total.scans);
+    printLatency("remove", total.removals);
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include "CouponBook.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+bool CouponBook::addCoupon(const Coupon& coupon) {
+    if (mIdIndex.count(coupon.id)) {
+        std::cerr << "Coupon already exists" << std::endl;
+        return false;
+    }
+    if (coupon.value < 0 || coupon.minAmount < 0 ||
+        (Coupon::Discount_t::Percent == coupon.discount && coupon.value > 100)) {
+        std::cerr << "Invalid coupon discount" << std::endl;
+        return false;
+    }
+
+    bool validItems = false;
+    switch (coupon.scope) {
+        case Coupon::Scope_t::Item:
+            validItems = (coupon.items.size() == 1);
+            break;
+        case Coupon::Scope_t::Group:
+            validItems = !coupon.items.empty();
+            break;
+        case Coupon::Scope_t::Order:
+            validItems = coupon.items.empty();
+            break;
+    }
+    if (!validItems) {
+        std::cerr << "Invalid coupon items" << std::endl;
+        return false;
+    }
+
+    // An item listed twice in a group still qualifies once
+    Coupon added = coupon;
+    std::sort(added.items.begin(), added.items.end());
+    added.items.erase(std::unique(added.items.begin(), added.items.end()), added.items.end());
+
+    const uint32_t pos = static_cast<uint32_t>(mCoupons.size());
+    for (const auto& name : added.items) {
+        mItemIndex[name].push_back(pos);
+    }
+    mIdIndex.emplace(added.id, pos);
+    mCoupons.push_back(std::move(added));
+    return true;
+}
+
+int CouponBook::findCoupon(uint32_t id) const {
+    auto it = mIdIndex.find(id);
+    return (it == mIdIndex.end()) ? -1 : static_cast<int>(it->second);
+}
+
+const Coupon& CouponBook::getCoupon(std::size_t pos) const {
+    return mCoupons[pos];
+}
+
+const std::vector<uint32_t>& CouponBook::getItemCoupons(std::string_view name) const {
+    static const std::vector<uint32_t> none;
+    auto it = mItemIndex.find(name);
+    return (it == mItemIndex.end()) ? none : it->second;
+}
+
+bool CouponBook::qualifies(std::size_t pos, std::string_view name) const {
+    const auto& coupons = getItemCoupons(name);
+    return std::find(coupons.begin(), coupons.end(), pos) != coupons.end();
+}
+
+std::size_t CouponBook::size() const {
+    return mCoupons.size();
+}
@@ -0,0 +1,63 @@
+#ifndef __COUPONBOOK_HPP__
+#define __COUPONBOOK_HPP__
+
+#include "StringHash.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Manufacturer or loyalty coupon
+struct Coupon {
+    // What the coupon applies to
+    enum class Scope_t { Item, Group, Order };
+    // How the discount is given
+    enum class Discount_t { Fixed, Percent };
+
+    uint32_t id = 0;                        // Unique coupon id
+    Scope_t scope = Scope_t::Item;
+    Discount_t discount = Discount_t::Fixed;
+    float value = 0;                        // Dollars off for Fixed, percent off for Percent
+    float minAmount = 0;                    // Item and Group: quantity or weight of qualifying items needed.
+                                            // Order: order price needed in dollars
+    bool loyalty = false;                   // Only redeemable by loyalty members
+    std::vector<std::string> items;         // Qualifying items. One for Item, any number for Group, none for Order
+};
+
+// Set of coupons with an index from item name to the coupons it qualifies for, so matching a
+// coupon against an order only looks at the order lines it affects.
+class CouponBook {
+public:
+    // Default constructor. Creates an empty book
+    CouponBook() {}
+
+    // Add coupon to the book. Id must be unique, value must not be negative and percent must
+    // not be over 100. Item coupons need exactly one item, Group coupons at least one and Order
+    // coupons none. Returns status of operation
+    bool addCoupon(const Coupon& coupon);
+
+    // Returns position of coupon with the given id or -1 if not found
+    int findCoupon(uint32_t id) const;
+
+    // Returns coupon at a position returned by findCoupon
+    const Coupon& getCoupon(std::size_t pos) const;
+
+    // Returns positions of Item and Group coupons the item qualifies for
+    const std::vector<uint32_t>& getItemCoupons(std::string_view name) const;
+
+    // Returns true if the item qualifies for the coupon at position pos
+    bool qualifies(std::size_t pos, std::string_view name) const;
+
+    // Return number of coupons
+    std::size_t size() const;
+
+private:
+    std::vector<Coupon> mCoupons;                       // All coupons
+    std::unordered_map<uint32_t, uint32_t> mIdIndex;    // Position of coupon by id
+    std::unordered_map<std::string, std::vector<uint32_t>, StringHash, std::equal_to<>> mItemIndex; // Coupon positions by item
+};
+
+#endif
@@ -0,0 +1,160 @@
+#include "FrozenCatalog.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace {
+// File header of a saved catalog
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t numRecords;
+    uint64_t namesSize;
+    uint64_t numGtinSlots;
+};
+
+constexpr char kMagic[4] = {'F', 'C', 'A', 'T'};
+constexpr uint32_t kVersion = 1;
+}
+
+FrozenCatalog::FrozenCatalog(const ItemDatabase& db) {
+    const auto& items = db.getItems();
+
+    // Lay out records and names in name order so lookups and page-in walk memory sequentially
+    std::vector<const Item*> sorted;
+    sorted.reserve(items.size());
+    std::size_t namesSize = 0;
+    for (const auto& item : items) {
+        sorted.push_back(&item);
+        namesSize += item.getName().size();
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const Item* a, const Item* b) { return a->getName() < b->getName(); });
+
+    mRecords.reserve(sorted.size());
+    mNames.reserve(namesSize);
+    std::vector<uint64_t> gtins;
+    std::vector<uint32_t> gtinRecords;
+    for (const Item* item : sorted) {
+        Record record{};
+        record.gtin = item->getGtin();
+        record.nameOffset = static_cast<uint32_t>(mNames.size());
+        record.nameLength = static_cast<uint32_t>(item->getName().size());
+        record.price = item->getPrice();
+        record.markdown = item->getMarkdown();
+        record.saleType = item->getSaleType();
+        if (item->getSpecial()) {
+            record.special = item->getSpecial()->getParams();
+        }
+
+        if (record.gtin != 0) {
+            gtins.push_back(record.gtin);
+            gtinRecords.push_back(static_cast<uint32_t>(mRecords.size()));
+        }
+        mNames += item->getName();
+        mRecords.push_back(record);
+    }
+
+    // GTINs are unique in the database so the build cannot fail on duplicates
+    if (mGtinIndex.build(gtins)) {
+        mGtinSlots.resize(gtins.size());
+        for (std::size_t k = 0; k < gtins.size(); ++k) {
+            mGtinSlots[mGtinIndex.slot(gtins[k])] = gtinRecords[k];
+        }
+    }
+}
+
+const FrozenCatalog::Record* FrozenCatalog::findItem(std::string_view name) const {
+    auto it = std::lower_bound(mRecords.begin(), mRecords.end(), name,
+        [this](const Record& record, std::string_view key) { return getName(record) < key; });
+    if (it == mRecords.end() || getName(*it) != name) {
+        return nullptr;
+    }
+    return &*it;
+}
+
+const FrozenCatalog::Record* FrozenCatalog::findItemByGtin(uint64_t gtin) const {
+    if (mGtinIndex.empty()) {
+        return nullptr;
+    }
+    const Record& record = mRecords[mGtinSlots[mGtinIndex.slot(gtin)]];
+    return (record.gtin == gtin) ? &record : nullptr;
+}
+
+std::string_view FrozenCatalog::getName(const Record& record) const {
+    return std::string_view(mNames.data() + record.nameOffset, record.nameLength);
+}
+
+float FrozenCatalog::calcPrice(const Record& record, float amount) {
+    // Use special if available otherwise calculate manually
+    if (SpecialParams::Type_t::None != record.special.type) {
+        return record.special.calcPrice(amount, record.price - record.markdown);
+    } else {
+        return (record.price - record.markdown) * amount;
+    }
+}
+
+std::size_t FrozenCatalog::size() const {
+    return mRecords.size();
+}
+
+std::size_t FrozenCatalog::memoryBytes() const {
+    return sizeof(*this) + mRecords.capacity() * sizeof(Record) + mNames.capacity() +
+           mGtinIndex.memoryBytes() + mGtinSlots.capacity() * sizeof(uint32_t);
+}
+
+bool FrozenCatalog::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        std::cerr << "Unable to open " << path << std::endl;
+        return false;
+    }
+
+    FileHeader header{{kMagic[0], kMagic[1], kMagic[2], kMagic[3]}, kVersion, mRecords.size(), mNames.size(), mGtinSlots.size()};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(mRecords.data()), mRecords.size() * sizeof(Record));
+    out.write(mNames.data(), mNames.size());
+    out.write(reinterpret_cast<const char*>(mGtinSlots.data()), mGtinSlots.size() * sizeof(uint32_t));
+    return mGtinIndex.write(out);
+}
+
+bool FrozenCatalog::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Unable to open " << path << std::endl;
+        return false;
+    }
+
+    FileHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        !std::equal(kMagic, kMagic + 4, header.magic) || header.version != kVersion) {
+        std::cerr << "Invalid catalog file " << path << std::endl;
+        return false;
+    }
+
+    // Read into temporaries so a bad file leaves the catalog untouched
+    std::vector<Record> records(header.numRecords);
+    std::string names(header.namesSize, '\0');
+    std::vector<uint32_t> gtinSlots(header.numGtinSlots);
+    GtinIndex gtinIndex;
+    if (!in.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(Record)) ||
+        !in.read(names.data(), names.size()) ||
+        !in.read(reinterpret_cast<char*>(gtinSlots.data()), gtinSlots.size() * sizeof(uint32_t)) ||
+        !gtinIndex.read(in) || gtinIndex.size() != gtinSlots.size()) {
+        std::cerr << "Truncated catalog file " << path << std::endl;
+        return false;
+    }
+    bool valid = std::all_of(records.begin(), records.end(), [&names](const Record& record) {
+        return static_cast<uint64_t>(record.nameOffset) + record.nameLength <= names.size();
+    }) && std::all_of(gtinSlots.begin(), gtinSlots.end(), [&records](uint32_t slot) { return slot < records.size(); });
+    if (!valid) {
+        std::cerr << "Corrupt catalog file " << path << std::endl;
+        return false;
+    }
+
+    mRecords = std::move(records);
+    mNames = std::move(names);
+    mGtinSlots = std::move(gtinSlots);
+    mGtinIndex = std::move(gtinIndex);
+    return true;
+}
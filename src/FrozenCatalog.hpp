@@ -0,0 +1,68 @@
+#ifndef __FROZENCATALOG_HPP__
+#define __FROZENCATALOG_HPP__
+
+#include "GtinIndex.hpp"
+#include "ItemDatabase.hpp"
+#include "Special.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Read-only snapshot of an ItemDatabase packed for lookup after loading is done. All item
+// names live in one contiguous arena and all records in one array sorted by name, with
+// specials stored inline, so the catalog holds no per item heap objects. The snapshot can be
+// saved to and loaded from a single file with sequential reads.
+class FrozenCatalog {
+public:
+    // Packed item record
+    struct Record {
+        uint64_t gtin;          // Barcode number. 0 = none
+        uint32_t nameOffset;    // Offset of name in the name arena
+        uint32_t nameLength;    // Length of name
+        float price;            // Price in dollars per unit or per pound
+        float markdown;         // Amount in dollars to lower price
+        SpecialParams special;  // Special if type is not None
+        Item::Sale_t saleType;  // Sale type
+    };
+
+    // Default constructor. Creates an empty catalog
+    FrozenCatalog() {}
+
+    // Freeze the current contents of the database
+    explicit FrozenCatalog(const ItemDatabase& db);
+
+    // Returns record of item or nullptr if not found
+    const Record* findItem(std::string_view name) const;
+
+    // Returns record of item with the given GTIN or nullptr if not found
+    const Record* findItemByGtin(uint64_t gtin) const;
+
+    // Returns name of the item of a record
+    std::string_view getName(const Record& record) const;
+
+    // Returns total price of amount of the item after markdown and special
+    static float calcPrice(const Record& record, float amount);
+
+    // Return number of items
+    std::size_t size() const;
+
+    // Return bytes used by the catalog
+    std::size_t memoryBytes() const;
+
+    // Write catalog to file at path. Returns status of operation
+    bool save(const std::string& path) const;
+
+    // Replace catalog with one written by save(). Returns status of operation
+    bool load(const std::string& path);
+
+private:
+    std::vector<Record> mRecords;   // Item records sorted by name
+    std::string mNames;             // Arena holding all item names
+    GtinIndex mGtinIndex;           // Perfect hash of GTINs
+    std::vector<uint32_t> mGtinSlots; // Index into mRecords by GtinIndex slot
+};
+
+#endif
@@ -0,0 +1,167 @@
+#include "GtinIndex.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+namespace {
+// 64 bit finalizer (splitmix64) used to spread GTINs, which are mostly sequential
+inline uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// Map a hash uniformly onto [0, n) without a division
+inline std::size_t reduce(uint64_t hash, std::size_t n) {
+    return static_cast<std::size_t>((static_cast<unsigned __int128>(hash) * n) >> 64);
+}
+
+// Slot of a key hash for a given bucket displacement
+inline std::size_t displacedSlot(uint64_t hash, uint32_t displacement, std::size_t n) {
+    return reduce(mix(hash + displacement * 0x9e3779b97f4a7c15ULL), n);
+}
+}
+
+bool GtinIndex::build(const std::vector<uint64_t>& keys) {
+    const std::size_t n = keys.size();
+    if (n >= kDirectSlot) {
+        std::cerr << "Too many keys for GTIN index" << std::endl;
+        return false;
+    }
+
+    mNumKeys = 0;
+    mDisplacements.clear();
+    if (n == 0) {
+        return true;
+    }
+
+    // Group key hashes by bucket with a counting sort
+    const std::size_t numBuckets = (n + kKeysPerBucket - 1) / kKeysPerBucket;
+    std::vector<uint64_t> hashes(n);
+    std::vector<uint32_t> bucketStart(numBuckets + 1, 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        hashes[i] = mix(keys[i]);
+        ++bucketStart[reduce(hashes[i], numBuckets) + 1];
+    }
+    for (std::size_t b = 0; b < numBuckets; ++b) {
+        bucketStart[b + 1] += bucketStart[b];
+    }
+    std::vector<uint64_t> grouped(n);
+    std::vector<uint32_t> fill(bucketStart.begin(), bucketStart.end() - 1);
+    for (std::size_t i = 0; i < n; ++i) {
+        grouped[fill[reduce(hashes[i], numBuckets)]++] = hashes[i];
+    }
+
+    // Place the largest buckets first while the table is mostly empty
+    std::vector<uint32_t> order(numBuckets);
+    for (std::size_t b = 0; b < numBuckets; ++b) {
+        order[b] = static_cast<uint32_t>(b);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return (bucketStart[a + 1] - bucketStart[a]) > (bucketStart[b + 1] - bucketStart[b]);
+    });
+
+    std::vector<uint32_t> displacements(numBuckets, 0);
+    std::vector<bool> taken(n, false);
+    std::vector<std::size_t> slots;
+    std::size_t nextFree = 0;
+
+    for (uint32_t b : order) {
+        const uint64_t* first = grouped.data() + bucketStart[b];
+        const std::size_t size = bucketStart[b + 1] - bucketStart[b];
+        if (size == 0) {
+            break; // Remaining buckets are empty
+        }
+
+        if (size == 1) {
+            // Single keys take the next free slot directly
+            while (taken[nextFree]) {
+                ++nextFree;
+            }
+            taken[nextFree] = true;
+            displacements[b] = kDirectSlot | static_cast<uint32_t>(nextFree);
+            continue;
+        }
+
+        // Equal hashes can never be separated
+        std::vector<uint64_t> sorted(first, first + size);
+        std::sort(sorted.begin(), sorted.end());
+        if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+            std::cerr << "Duplicate keys in GTIN index" << std::endl;
+            return false;
+        }
+
+        // Search for a displacement sending every key of the bucket to a distinct free slot
+        bool placed = false;
+        for (uint32_t d = 0; d < kDirectSlot && !placed; ++d) {
+            slots.clear();
+            placed = true;
+            for (std::size_t k = 0; k < size && placed; ++k) {
+                std::size_t s = displacedSlot(first[k], d, n);
+                placed = !taken[s] && std::find(slots.begin(), slots.end(), s) == slots.end();
+                slots.push_back(s);
+            }
+            if (placed) {
+                for (std::size_t s : slots) {
+                    taken[s] = true;
+                }
+                displacements[b] = d;
+            }
+        }
+        if (!placed) {
+            std::cerr << "Unable to build GTIN index" << std::endl;
+            return false;
+        }
+    }
+
+    mDisplacements = std::move(displacements);
+    mNumKeys = n;
+    return true;
+}
+
+std::size_t GtinIndex::slot(uint64_t key) const {
+    const uint64_t hash = mix(key);
+    const uint32_t displacement = mDisplacements[reduce(hash, mDisplacements.size())];
+    if (displacement & kDirectSlot) {
+        return displacement & ~kDirectSlot;
+    }
+    return displacedSlot(hash, displacement, mNumKeys);
+}
+
+std::size_t GtinIndex::size() const {
+    return mNumKeys;
+}
+
+bool GtinIndex::empty() const {
+    return mNumKeys == 0;
+}
+
+std::size_t GtinIndex::memoryBytes() const {
+    return mDisplacements.capacity() * sizeof(uint32_t);
+}
+
+bool GtinIndex::write(std::ostream& out) const {
+    uint64_t header[2] = {mNumKeys, mDisplacements.size()};
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(mDisplacements.data()), mDisplacements.size() * sizeof(uint32_t));
+    return static_cast<bool>(out);
+}
+
+bool GtinIndex::read(std::istream& in) {
+    uint64_t header[2];
+    if (!in.read(reinterpret_cast<char*>(header), sizeof(header)) || header[0] >= kDirectSlot ||
+        (header[0] > 0) != (header[1] > 0)) {
+        return false;
+    }
+
+    std::vector<uint32_t> displacements(header[1]);
+    if (!in.read(reinterpret_cast<char*>(displacements.data()), displacements.size() * sizeof(uint32_t))) {
+        return false;
+    }
+    mDisplacements = std::move(displacements);
+    mNumKeys = header[0];
+    return true;
+}
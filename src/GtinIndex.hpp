@@ -0,0 +1,53 @@
+#ifndef __GTININDEX_HPP__
+#define __GTININDEX_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+// Minimal perfect hash over a fixed set of GTINs (CHD style hash and displace). Every key of
+// the set maps to a distinct slot in [0, size). Keys are hashed into small buckets and each
+// bucket stores one 32 bit displacement, so a lookup reads a single displacement and the
+// index itself takes about 6.4 bits per key. Keys outside the set map to an arbitrary slot, so
+// callers must verify the key stored at the slot. Callers mapping slots to records through a
+// uint32_t table, as ItemDatabase and FrozenCatalog do, pay 32 bits per key more, about 38
+// bits per key in total.
+class GtinIndex {
+public:
+    // Default constructor. Creates an empty index
+    GtinIndex() {}
+
+    // Build the index over keys. Keys must be unique. Returns status of operation
+    bool build(const std::vector<uint64_t>& keys);
+
+    // Return slot of key. Only meaningful for keys the index was built over
+    std::size_t slot(uint64_t key) const;
+
+    // Return number of keys in the index
+    std::size_t size() const;
+
+    // Return true if index holds no keys
+    bool empty() const;
+
+    // Return bytes used by the index
+    std::size_t memoryBytes() const;
+
+    // Write the index in binary form. Returns status of operation
+    bool write(std::ostream& out) const;
+
+    // Replace the index with one previously written by write(). Returns status of operation
+    bool read(std::istream& in);
+
+private:
+    // Average number of keys per bucket
+    static constexpr std::size_t kKeysPerBucket = 5;
+    // Displacement flag meaning the remaining bits are the slot itself (used for single key buckets)
+    static constexpr uint32_t kDirectSlot = 0x80000000U;
+
+    std::vector<uint32_t> mDisplacements; // Displacement per bucket
+    std::size_t mNumKeys = 0;             // Number of keys and slots
+};
+
+#endif
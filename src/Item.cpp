@@ -5,7 +5,7 @@
 #include <iostream>
 
 Item::Item(const std::string& name, Sale_t type, float price) :
-    mName(name), mType(type), mPrice(fabs(price)), mMarkdown(0), mSpecial(nullptr)
+    mName(name), mType(type), mPrice(fabs(price)), mMarkdown(0), mSpecial(nullptr), mGtin(0), mTaxCategory(0), mCatalogIndex(kNoCatalogIndex)
 {}
 
 const std::string& Item::getName() const {
@@ -54,3 +54,59 @@ void Item::setSpecial(const std::shared_ptr<Special>& special) {
 const Special* Item::getSpecial() const {
     return mSpecial.get();
 }
+
+const std::shared_ptr<Special>& Item::shareSpecial() const {
+    return mSpecial;
+}
+
+uint64_t Item::getGtin() const {
+    return mGtin;
+}
+
+bool Item::setGtin(uint64_t gtin) {
+    if (gtin != 0 && !isValidGtin(gtin)) {
+        std::cerr << "Invalid GTIN" << std::endl;
+        return false;
+    }
+
+    mGtin = gtin;
+    return true;
+}
+
+bool Item::isValidGtin(uint64_t gtin) {
+    if (gtin == 0 || gtin >= 100000000000000ULL) {
+        return false; // More than 14 digits
+    }
+
+    // Digits left of the check digit are weighted 3,1,3,... starting from the right
+    unsigned int check = gtin % 10;
+    unsigned int sum = 0;
+    unsigned int weight = 3;
+    for (uint64_t rest = gtin / 10; rest > 0; rest /= 10) {
+        sum += (rest % 10) * weight;
+        weight = 4 - weight;
+    }
+    return check == (10 - sum % 10) % 10;
+}
+
+uint8_t Item::getTaxCategory() const {
+    return mTaxCategory;
+}
+
+bool Item::setTaxCategory(unsigned int category) {
+    if (category >= kNumTaxCategories) {
+        std::cerr << "Invalid tax category" << std::endl;
+        return false;
+    }
+
+    mTaxCategory = static_cast<uint8_t>(category);
+    return true;
+}
+
+uint32_t Item::getCatalogIndex() const {
+    return mCatalogIndex;
+}
+
+void Item::setCatalogIndex(uint32_t index) {
+    mCatalogIndex = index;
+}
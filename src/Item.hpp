@@ -3,6 +3,7 @@
 
 #include "Special.hpp"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -12,6 +13,12 @@ public:
     // Describes if item is sold per individual unit or by weight in $/lb
     enum class Sale_t { Unit, Weight };
 
+    // Number of tax categories. Items are in category 0 unless set otherwise
+    static constexpr unsigned int kNumTaxCategories = 16;
+
+    // Catalog index of items not inserted into an ItemDatabase
+    static constexpr uint32_t kNoCatalogIndex = UINT32_MAX;
+
     // Constructor. Price should be positive, if not the absolute value will be used.
     Item(const std::string& name, Sale_t type, float price);
 
@@ -39,12 +46,41 @@ public:
     // Returns raw pointer to current special or nullptr if none
     const Special* getSpecial() const;
 
+    // Returns shared pointer to current special or nullptr if none
+    const std::shared_ptr<Special>& shareSpecial() const;
+
+    // Return GTIN (UPC/EAN barcode number) of item or 0 if none
+    uint64_t getGtin() const;
+
+    // Set GTIN of item or 0 to remove. GTIN must have at most 14 digits and a valid check digit.
+    // Returns success of operation
+    bool setGtin(uint64_t gtin);
+
+    // Returns true if gtin has at most 14 digits and a valid GS1 check digit
+    static bool isValidGtin(uint64_t gtin);
+
+    // Return tax category of item
+    uint8_t getTaxCategory() const;
+
+    // Set tax category of item. Category must be less than kNumTaxCategories. Returns success of operation
+    bool setTaxCategory(unsigned int category);
+
+    // Return dense index of the item in its ItemDatabase or kNoCatalogIndex. Copies of the item,
+    // such as store overrides, keep the index of the original
+    uint32_t getCatalogIndex() const;
+
+    // Set catalog index of item. Done by ItemDatabase when the item is inserted
+    void setCatalogIndex(uint32_t index);
+
 private:
     std::string mName; // Name of item
     Sale_t mType;   // Sale type
     float mPrice;   // Price in dollars per unit or per pound
     float mMarkdown;    // Amount in dollars to lower price
     std::shared_ptr<Special> mSpecial; // Special if available
+    uint64_t mGtin; // Barcode number. 0 = none
+    uint8_t mTaxCategory; // Tax category
+    uint32_t mCatalogIndex; // Position in the item database
 };
 
 #endif
\ No newline at end of file
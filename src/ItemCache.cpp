@@ -0,0 +1,93 @@
+#include "ItemCache.hpp"
+#include "StringHash.hpp"
+
+#include <iostream>
+#include <new>
+
+namespace {
+// Entry returned for items not found
+const ItemCache::Entry kNotFound{};
+
+// Run a catalog lookup, treating running out of memory as not found
+template <typename Find>
+const Item* lookup(Find find) noexcept {
+    try {
+        return find();
+    } catch (const std::bad_alloc&) {
+        std::cerr << "Out of memory looking up item" << std::endl;
+        return nullptr;
+    }
+}
+}
+
+static_assert((ItemCache::kNumSlots & (ItemCache::kNumSlots - 1)) == 0, "Slot count must be a power of two");
+
+ItemCache::ItemCache(const ItemCatalog& catalog) :
+    mCatalog(catalog), mEpoch(catalog.getEpoch()), mNameSlots{}, mGtinSlots{}, mHits(0), mMisses(0)
+{}
+
+const Item* ItemCache::findItem(std::string_view name) noexcept {
+    return findEntry(name).item;
+}
+
+const Item* ItemCache::findItemByGtin(uint64_t gtin) noexcept {
+    return findEntryByGtin(gtin).item;
+}
+
+const ItemCache::Entry& ItemCache::findEntry(std::string_view name) noexcept {
+    checkEpoch();
+    const uint64_t hash = StringHash{}(name);
+    Slot& slot = mNameSlots[hash & (kNumSlots - 1)];
+    // The hash only picks the slot, the name decides
+    if (slot.entry.item && slot.key == hash && slot.entry.item->getName() == name) {
+        ++mHits;
+        return slot.entry;
+    }
+
+    ++mMisses;
+    return fill(slot, hash, lookup([&]() { return mCatalog.findItem(name); }));
+}
+
+const ItemCache::Entry& ItemCache::findEntryByGtin(uint64_t gtin) noexcept {
+    checkEpoch();
+    // GTINs end in a check digit, so the low bits of the body pick the slot
+    Slot& slot = mGtinSlots[(gtin / 10) & (kNumSlots - 1)];
+    if (slot.entry.item && slot.key == gtin) {
+        ++mHits;
+        return slot.entry;
+    }
+
+    ++mMisses;
+    return fill(slot, gtin, lookup([&]() { return mCatalog.findItemByGtin(gtin); }));
+}
+
+const ItemCatalog& ItemCache::getCatalog() const {
+    return mCatalog;
+}
+
+uint64_t ItemCache::getHits() const {
+    return mHits;
+}
+
+uint64_t ItemCache::getMisses() const {
+    return mMisses;
+}
+
+const ItemCache::Entry& ItemCache::fill(Slot& slot, uint64_t key, const Item* item) {
+    if (!item) {
+        return kNotFound;
+    }
+    slot.key = key;
+    slot.entry.item = item;
+    slot.entry.special = item->getSpecial() ? item->getSpecial()->getParams() : SpecialParams{};
+    return slot.entry;
+}
+
+void ItemCache::checkEpoch() {
+    const uint64_t epoch = mCatalog.getEpoch();
+    if (epoch != mEpoch) {
+        mNameSlots.fill({});
+        mGtinSlots.fill({});
+        mEpoch = epoch;
+    }
+}
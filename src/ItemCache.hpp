@@ -0,0 +1,75 @@
+#ifndef __ITEMCACHE_HPP__
+#define __ITEMCACHE_HPP__
+
+#include "ItemCatalog.hpp"
+#include "Special.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Small direct-mapped cache of items in front of a catalog. Basket traffic is skewed and the
+// same items are scanned over and over, so repeat lookups are answered from a few slots
+// without touching the catalog index. Each slot also keeps a copy of the special of its item,
+// so repeat scans price through SpecialParams without calling into the item's Special. The
+// cache is emptied whenever the catalog epoch changes, which is the only time cached items and
+// specials can become invalid. Not thread safe; use one cache per order or lane.
+class ItemCache {
+public:
+    static constexpr std::size_t kNumSlots = 32; // Slots per key type. Power of two
+
+    // Item found through the cache with the special it prices with
+    struct Entry {
+        const Item* item = nullptr;   // Item or nullptr if not found
+        SpecialParams special;        // Special of the item, type None if it has none
+    };
+
+    // Constructor. Catalog must outlive the cache
+    explicit ItemCache(const ItemCatalog& catalog);
+
+    // Returns pointer to item or nullptr if not found. Catalogs that build items on lookup may
+    // run out of memory, which is reported as not found
+    const Item* findItem(std::string_view name) noexcept;
+
+    // Returns pointer to item with the given GTIN or nullptr if not found
+    const Item* findItemByGtin(uint64_t gtin) noexcept;
+
+    // Returns entry of item by name. Valid until the next lookup
+    const Entry& findEntry(std::string_view name) noexcept;
+
+    // Returns entry of item with the given GTIN. Valid until the next lookup
+    const Entry& findEntryByGtin(uint64_t gtin) noexcept;
+
+    // Return catalog behind the cache
+    const ItemCatalog& getCatalog() const;
+
+    // Return number of lookups answered from the cache
+    uint64_t getHits() const;
+
+    // Return number of lookups that went to the catalog
+    uint64_t getMisses() const;
+
+private:
+    // Cached entry and the key it was found by
+    struct Slot {
+        uint64_t key;   // Name hash or GTIN
+        Entry entry;    // Cached entry. Item is nullptr if the slot is empty
+    };
+
+    // Returns entry of an item looked up in the catalog, kept in slot if found
+    static const Entry& fill(Slot& slot, uint64_t key, const Item* item);
+
+    // Empty all slots if the catalog changed since they were filled
+    void checkEpoch();
+
+private:
+    const ItemCatalog& mCatalog;                // Catalog behind the cache
+    uint64_t mEpoch;                            // Catalog epoch the slots were filled at
+    std::array<Slot, kNumSlots> mNameSlots;     // Items by hash of name
+    std::array<Slot, kNumSlots> mGtinSlots;     // Items by GTIN
+    uint64_t mHits;                             // Lookups answered from the cache
+    uint64_t mMisses;                           // Lookups that went to the catalog
+};
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef __ITEMCATALOG_HPP__
+#define __ITEMCATALOG_HPP__
+
+#include "Item.hpp"
+
+#include <cstdint>
+#include <string_view>
+
+// Read access to items by name or GTIN. Orders price against this, so the same Order works on
+// an ItemDatabase or on a store overlay of one
+class ItemCatalog {
+public:
+    virtual ~ItemCatalog() {}
+
+    // Returns pointer to item or nullptr if not found
+    virtual const Item* findItem(std::string_view name) const = 0;
+
+    // Returns pointer to item with the given GTIN or nullptr if not found
+    virtual const Item* findItemByGtin(uint64_t gtin) const = 0;
+
+    // Return current epoch. Changes whenever items found before may have moved or been replaced
+    virtual uint64_t getEpoch() const = 0;
+};
+
+#endif
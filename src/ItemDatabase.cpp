@@ -1,55 +1,133 @@
 #include "ItemDatabase.hpp"
+#include "MemoryUsage.hpp"
 
-#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <unordered_set>
 
-std::optional<Item> ItemDatabase::getItem(const std::string& name) const {
-    auto it = std::find_if(mItems.begin(), mItems.end(), [&name](const Item& obj) { return obj.getName() == name; });
-    if (it == mItems.end()) {
+std::optional<Item> ItemDatabase::getItem(std::string_view name) const {
+    auto it = mIndex.find(name);
+    if (it == mIndex.end()) {
         return std::nullopt;
     }
-    return *it;
+    return mItems[it->second];
+}
+
+const Item* ItemDatabase::findItemByGtin(uint64_t gtin) const {
+    // Check perfect hash first. Slot must be verified since unknown GTINs map to any slot
+    if (!mGtinIndex.empty()) {
+        const Item& item = mItems[mGtinSlots[mGtinIndex.slot(gtin)]];
+        if (item.getGtin() == gtin) {
+            return &item;
+        }
+    }
+
+    auto it = mGtinOverflow.find(gtin);
+    return (it == mGtinOverflow.end()) ? nullptr : &mItems[it->second];
 }
 
 bool ItemDatabase::insertItem(const Item& item) {
     // Check to make sure item isn't already in database
-    if (getItem(item.getName()).has_value()) {
+    if (mIndex.find(item.getName()) != mIndex.end()) {
         std::cerr << "Item already exists" << std::endl;
         return false;
     }
 
+    if (item.getGtin() != 0 && hasGtin(item.getGtin())) {
+        std::cerr << "GTIN already exists" << std::endl;
+        return false;
+    }
+
+    mIndex.emplace(item.getName(), mItems.size());
+    if (item.getGtin() != 0) {
+        mGtinOverflow.emplace(item.getGtin(), mItems.size());
+    }
     mItems.push_back(item);
+    mItems.back().setCatalogIndex(static_cast<uint32_t>(mItems.size() - 1));
+    mSearchIndex.insert(mItems, static_cast<uint32_t>(mItems.size() - 1));
+    ++mEpoch;
+    return true;
+}
+
+bool ItemDatabase::finalize() {
+    std::vector<uint64_t> gtins;
+    std::vector<uint32_t> itemIdx;
+    for (std::size_t i = 0; i < mItems.size(); ++i) {
+        if (mItems[i].getGtin() != 0) {
+            gtins.push_back(mItems[i].getGtin());
+            itemIdx.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    GtinIndex index;
+    if (!index.build(gtins)) {
+        return false;
+    }
+
+    // Order items by slot so a lookup is displacement then slot
+    std::vector<uint32_t> slots(gtins.size());
+    for (std::size_t k = 0; k < gtins.size(); ++k) {
+        slots[index.slot(gtins[k])] = itemIdx[k];
+    }
+
+    mGtinIndex = std::move(index);
+    mGtinSlots = std::move(slots);
+    std::unordered_map<uint64_t, std::size_t>().swap(mGtinOverflow); // Release overflow memory
     return true;
 }
 
-bool ItemDatabase::setItemPrice(const std::string& name, float price) {
+bool ItemDatabase::setItemPrice(std::string_view name, float price) {
     // Find item in database
-    auto item = std::find_if(mItems.begin(), mItems.end(), [&name](const Item& obj) { return obj.getName() == name; });
-    if (item == mItems.end()) {
+    auto item = findMutableItem(name);
+    if (!item) {
         // Item not in database
         std::cerr << "Item not found" << std::endl;
         return false;
     }
 
-    return item->setPrice(price);
+    if (!item->setPrice(price)) {
+        return false;
+    }
+    ++mEpoch;
+    return true;
 }
 
-bool ItemDatabase::setItemMarkdown(const std::string& name, float markdown) {
+bool ItemDatabase::setItemMarkdown(std::string_view name, float markdown) {
     // Find item in database
-    auto item = std::find_if(mItems.begin(), mItems.end(), [&name](const Item& obj) { return obj.getName() == name; });
-    if (item == mItems.end()) {
+    auto item = findMutableItem(name);
+    if (!item) {
         // Item not in database
         std::cerr << "Item not found" << std::endl;
         return false;
     }
 
-    return item->setMarkdown(markdown);
+    if (!item->setMarkdown(markdown)) {
+        return false;
+    }
+    ++mEpoch;
+    return true;
 }
 
-bool ItemDatabase::setItemSpecial(const std::string& name, unsigned int needed, unsigned int receive, float percent, unsigned int limit) {
+bool ItemDatabase::setItemTaxCategory(std::string_view name, unsigned int category) {
     // Find item in database
-    auto item = std::find_if(mItems.begin(), mItems.end(), [&name](const Item& obj) { return obj.getName() == name; });
-    if (item == mItems.end()) {
+    auto item = findMutableItem(name);
+    if (!item) {
+        // Item not in database
+        std::cerr << "Item not found" << std::endl;
+        return false;
+    }
+
+    if (!item->setTaxCategory(category)) {
+        return false;
+    }
+    ++mEpoch;
+    return true;
+}
+
+bool ItemDatabase::setItemSpecial(std::string_view name, unsigned int needed, unsigned int receive, float percent, unsigned int limit) {
+    // Find item in database
+    auto item = findMutableItem(name);
+    if (!item) {
         // Item not in database
         std::cerr << "Item not found" << std::endl;
         return false;
@@ -60,16 +138,22 @@ bool ItemDatabase::setItemSpecial(const std::string& name, unsigned int needed,
         return false;
     }
 
-    // Create the BOGO special
-    item->setSpecial(std::make_shared<BuyOneGetOneUnit>(needed, receive, percent, limit));
+    // Create the special
+    auto special = std::make_shared<BuyOneGetOneUnit>(needed, receive, percent, limit);
+    if (!special->getParams().isValid()) {
+        std::cerr << "Special needs a positive amount" << std::endl;
+        return false;
+    }
+    item->setSpecial(special);
+    ++mEpoch;
 
     return true;
 }
 
-bool ItemDatabase::setItemSpecial(const std::string& name, float needed, float receive, float percent, float limit) {
+bool ItemDatabase::setItemSpecial(std::string_view name, float needed, float receive, float percent, float limit) {
     // Find item in database
-    auto item = std::find_if(mItems.begin(), mItems.end(), [&name](const Item& obj) { return obj.getName() == name; });
-    if (item == mItems.end()) {
+    auto item = findMutableItem(name);
+    if (!item) {
         // Item not in database
         std::cerr << "Item not found" << std::endl;
         return false;
@@ -80,16 +164,22 @@ bool ItemDatabase::setItemSpecial(const std::string& name, float needed, float r
         return false;
     }
 
-    // Create the BOGO special
-    item->setSpecial(std::make_shared<BuyOneGetOneWeight>(needed, receive, percent, limit));
+    // Create the special
+    auto special = std::make_shared<BuyOneGetOneWeight>(needed, receive, percent, limit);
+    if (!special->getParams().isValid()) {
+        std::cerr << "Special needs a positive amount" << std::endl;
+        return false;
+    }
+    item->setSpecial(special);
+    ++mEpoch;
 
     return true;
 }
 
-bool ItemDatabase::setItemSpecial(const std::string& name, unsigned int needed, float price, unsigned int limit) {
+bool ItemDatabase::setItemSpecial(std::string_view name, unsigned int needed, float price, unsigned int limit) {
     // Find item in database
-    auto item = std::find_if(mItems.begin(), mItems.end(), [&name](const Item& obj) { return obj.getName() == name; });
-    if (item == mItems.end()) {
+    auto item = findMutableItem(name);
+    if (!item) {
         // Item not in database
         std::cerr << "Item not found" << std::endl;
         return false;
@@ -100,8 +190,204 @@ bool ItemDatabase::setItemSpecial(const std::string& name, unsigned int needed,
         return false;
     }
 
-    // Create the BOGO special
-    item->setSpecial(std::make_shared<NforX>(needed, price, limit));
+    // Create the special
+    auto special = std::make_shared<NforX>(needed, price, limit);
+    if (!special->getParams().isValid()) {
+        std::cerr << "Special needs a positive amount" << std::endl;
+        return false;
+    }
+    item->setSpecial(special);
+    ++mEpoch;
 
     return true;
-}
\ No newline at end of file
+}
+
+bool ItemDatabase::applyDelta(const CatalogDelta& delta) {
+    // Stage changes on copies of the affected items. Nothing in the database is touched
+    // until every change has been validated
+    std::unordered_map<std::size_t, Item> staged;   // Modified copies of existing items by index
+    std::vector<Item> added;                        // Items new to the database
+    std::unordered_map<std::string, std::size_t> addedIndex; // Index into added by item name
+    std::unordered_set<uint64_t> addedGtins;        // GTINs of added items
+
+    for (const auto& change : delta.getChanges()) {
+        if (CatalogDelta::Change::Type_t::Insert == change.type) {
+            if (mIndex.count(change.name) || addedIndex.count(change.name)) {
+                std::cerr << "Item already exists" << std::endl;
+                return false;
+            }
+            Item item(change.name, change.saleType, change.price);
+            if (!item.setGtin(change.gtin)) {
+                return false;
+            }
+            if (change.gtin != 0 && (hasGtin(change.gtin) || !addedGtins.insert(change.gtin).second)) {
+                std::cerr << "GTIN already exists" << std::endl;
+                return false;
+            }
+            addedIndex.emplace(change.name, added.size());
+            added.push_back(std::move(item));
+            continue;
+        }
+
+        // Find staged copy of item, staging it on first use
+        Item* item = nullptr;
+        auto db_it = mIndex.find(change.name);
+        if (db_it != mIndex.end()) {
+            item = &staged.try_emplace(db_it->second, mItems[db_it->second]).first->second;
+        } else if (auto added_it = addedIndex.find(change.name); added_it != addedIndex.end()) {
+            item = &added[added_it->second];
+        } else {
+            std::cerr << "Item not found" << std::endl;
+            return false;
+        }
+
+        if (!applyChange(change, *item)) {
+            return false;
+        }
+    }
+
+    // Apply all staged changes as one new epoch
+    for (auto& entry : staged) {
+        mItems[entry.first] = std::move(entry.second);
+    }
+    for (auto& item : added) {
+        mIndex.emplace(item.getName(), mItems.size());
+        if (item.getGtin() != 0) {
+            mGtinOverflow.emplace(item.getGtin(), mItems.size());
+        }
+        mItems.push_back(std::move(item));
+        mItems.back().setCatalogIndex(static_cast<uint32_t>(mItems.size() - 1));
+        mSearchIndex.insert(mItems, static_cast<uint32_t>(mItems.size() - 1));
+    }
+    ++mEpoch;
+
+    return true;
+}
+
+uint64_t ItemDatabase::getEpoch() const {
+    return mEpoch;
+}
+
+std::vector<const Item*> ItemDatabase::searchItems(std::string_view query, std::size_t maxResults) const {
+    std::vector<const Item*> results;
+    for (uint32_t idx : mSearchIndex.search(mItems, query, maxResults)) {
+        results.push_back(&mItems[idx]);
+    }
+    return results;
+}
+
+void ItemDatabase::reserve(std::size_t numItems) {
+    // Growing the records moves every item, so pointers handed out before are stale
+    if (numItems > mItems.capacity()) {
+        mItems.reserve(numItems);
+        ++mEpoch;
+    }
+    mIndex.reserve(numItems);
+}
+
+ItemDatabase::MemoryUsage ItemDatabase::getMemoryUsage() const {
+    MemoryUsage usage;
+    usage.records = sizeof(*this) + mItems.capacity() * sizeof(Item);
+
+    // Specials are shared between items and database copies, count each one once
+    std::unordered_set<const Special*> specials;
+    for (const auto& item : mItems) {
+        usage.names += stringHeapBytes(item.getName());
+        const Special* special = item.getSpecial();
+        if (special && specials.insert(special).second) {
+            usage.specials += kSharedControlBytes + special->memoryBytes();
+        }
+    }
+    for (const auto& entry : mIndex) {
+        usage.names += stringHeapBytes(entry.first);
+    }
+
+    usage.indexes = hashTableBytes(mIndex) + mSearchIndex.memoryBytes() + mGtinIndex.memoryBytes() +
+                    mGtinSlots.capacity() * sizeof(uint32_t) + hashTableBytes(mGtinOverflow);
+    return usage;
+}
+
+std::size_t ItemDatabase::memoryBytes() const {
+    return getMemoryUsage().total();
+}
+
+const std::vector<Item>& ItemDatabase::getItems() const {
+    return mItems;
+}
+
+const Item* ItemDatabase::findItem(std::string_view name) const {
+    auto it = mIndex.find(name);
+    return (it == mIndex.end()) ? nullptr : &mItems[it->second];
+}
+
+Item* ItemDatabase::findMutableItem(std::string_view name) {
+    auto it = mIndex.find(name);
+    return (it == mIndex.end()) ? nullptr : &mItems[it->second];
+}
+
+bool ItemDatabase::hasGtin(uint64_t gtin) const {
+    return findItemByGtin(gtin) != nullptr;
+}
+
+bool ItemDatabase::applyChange(const CatalogDelta::Change& change, Item& item) {
+    using Type_t = CatalogDelta::Change::Type_t;
+    const bool byUnit = (Item::Sale_t::Unit == item.getSaleType());
+
+    switch (change.type) {
+        case Type_t::Price:
+            return item.setPrice(change.price);
+
+        case Type_t::Markdown:
+            return item.setMarkdown(change.price);
+
+        case Type_t::Bogo:
+            if (byUnit) {
+                // Unit specials need whole amounts
+                if (change.needed < 0 || change.receive < 0 || change.limit < 0 ||
+                    std::floor(change.needed) != change.needed || std::floor(change.receive) != change.receive ||
+                    std::floor(change.limit) != change.limit) {
+                    std::cerr << "Unit special amounts must be whole numbers" << std::endl;
+                    return false;
+                }
+                return setValidSpecial(item, std::make_shared<BuyOneGetOneUnit>(change.needed, change.receive, change.price, change.limit));
+            }
+            return setValidSpecial(item, std::make_shared<BuyOneGetOneWeight>(change.needed, change.receive, change.price, change.limit));
+
+        case Type_t::NforX:
+            if (!byUnit) {
+                std::cerr << "Item not sold by unit" << std::endl;
+                return false;
+            }
+            return setValidSpecial(item, std::make_shared<NforX>(change.needed, change.price, change.limit));
+
+        case Type_t::ClearSpecial:
+            item.setSpecial(nullptr);
+            return true;
+
+        case Type_t::TaxCategory:
+            return item.setTaxCategory(change.taxCategory);
+
+        case Type_t::Special:
+            if (change.special && change.special->getParams().byUnit() != byUnit) {
+                std::cerr << "Special does not match sale type of item" << std::endl;
+                return false;
+            }
+            if (!change.special) {
+                item.setSpecial(nullptr);
+                return true;
+            }
+            return setValidSpecial(item, change.special);
+
+        default:
+            return false;
+    }
+}
+
+bool ItemDatabase::setValidSpecial(Item& item, const std::shared_ptr<Special>& special) {
+    if (!special->getParams().isValid()) {
+        std::cerr << "Special needs a positive amount" << std::endl;
+        return false;
+    }
+    item.setSpecial(special);
+    return true;
+}
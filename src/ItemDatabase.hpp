@@ -1,43 +1,128 @@
 #ifndef __ITEMDATABASE_HPP__
 #define __ITEMDATABASE_HPP__
 
+#include "CatalogDelta.hpp"
+#include "GtinIndex.hpp"
+#include "ItemCatalog.hpp"
+#include "ItemSearchIndex.hpp"
 #include "Item.hpp"
+#include "StringHash.hpp"
 
-#include <vector>
+#include <cstddef>
+#include <cstdint>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 // Database that stores available item information
-class ItemDatabase {
+class ItemDatabase : public ItemCatalog {
 public:
+    // Bytes used by the database by kind of data
+    struct MemoryUsage {
+        std::size_t records = 0;    // Item records
+        std::size_t names = 0;      // Item names and index keys stored outside of the records
+        std::size_t specials = 0;   // Specials, each counted once however many items share it
+        std::size_t indexes = 0;    // Name, GTIN and search indexes
+
+        // Returns total bytes
+        std::size_t total() const { return records + names + specials + indexes; }
+    };
+
     // Default constructor
     ItemDatabase() {}
 
     // Returns copy of item information in the database if it exists
-    std::optional<Item> getItem(const std::string& name) const;
+    std::optional<Item> getItem(std::string_view name) const;
+
+    // Returns pointer to item in the database or nullptr if not found. Pointer is invalidated
+    // when items are added to the database
+    const Item* findItem(std::string_view name) const override;
 
-    // Insert new item into database. Item names must be unique and not already
+    // Returns pointer to item with the given GTIN or nullptr if not found. Pointer is invalidated
+    // when items are added to the database
+    const Item* findItemByGtin(uint64_t gtin) const override;
+
+    // Insert new item into database. Item names and GTINs must be unique and not already
     // in database. Return status of operation.
     bool insertItem(const Item& item);
 
+    // Pre-size the database for numItems items so loading or updating up to that many does not
+    // reallocate the records or rehash the name index. Growing the records invalidates pointers
+    // to items the same way insertItem does and increments the epoch
+    void reserve(std::size_t numItems);
+
+    // Finalize the catalog once loading is done. Builds the minimal perfect hash GTIN index.
+    // Items inserted afterwards are found through a slower overflow index until the next
+    // finalize. Returns status of operation
+    bool finalize();
+
+    // Returns up to maxResults items whose names best match a partially typed query, best match
+    // first. Each query word must start a word of the name, e.g. "gr app" finds "Granny Smith Apple".
+    // Falls back to names one typo away when there are too few matches
+    std::vector<const Item*> searchItems(std::string_view query, std::size_t maxResults = 10) const;
+
     // Set a new price for a desired item name. Price must be positive and item
     // must be in database
-    bool setItemPrice(const std::string& name, float price);
+    bool setItemPrice(std::string_view name, float price);
 
     // Set a new markdown for a desired item name. Markdown must be positive, less than base price
     // and item must be in database
-    bool setItemMarkdown(const std::string& name, float price);
+    bool setItemMarkdown(std::string_view name, float price);
+
+    // Set the tax category for a desired item name. Category must be less than
+    // Item::kNumTaxCategories and item must be in database
+    bool setItemTaxCategory(std::string_view name, unsigned int category);
 
     // Set the BOGO special for Unit
-    bool setItemSpecial(const std::string& name, unsigned int needed, unsigned int receive, float percent, unsigned int limit = 0);
+    bool setItemSpecial(std::string_view name, unsigned int needed, unsigned int receive, float percent, unsigned int limit = 0);
 
     // Set the BOGO special for Weight
-    bool setItemSpecial(const std::string& name, float needed, float receive, float percent, float limit = 0);
+    bool setItemSpecial(std::string_view name, float needed, float receive, float percent, float limit = 0);
 
     // Set the NforX special
-    bool setItemSpecial(const std::string& name, unsigned int needed, float price, unsigned int limit = 0);
+    bool setItemSpecial(std::string_view name, unsigned int needed, float price, unsigned int limit = 0);
+
+    // Apply all changes of the delta. Changes are staged and validated first and only applied
+    // if all of them are valid. Cost is proportional to the size of the delta. The items are
+    // updated in place, so the database must not be read by other threads during the call;
+    // LiveCatalog publishes deltas to concurrent readers atomically. Returns status of operation
+    bool applyDelta(const CatalogDelta& delta);
+
+    // Apply a single change of a delta to a copy of an item. Returns status of operation
+    static bool applyChange(const CatalogDelta::Change& change, Item& item);
+
+    // Return current epoch. The epoch is incremented every time changes are published
+    uint64_t getEpoch() const override;
+
+    // Return all items in insertion order
+    const std::vector<Item>& getItems() const;
+
+    // Returns bytes used by the database by kind of data
+    MemoryUsage getMemoryUsage() const;
+
+    // Return bytes used by the database
+    std::size_t memoryBytes() const;
+
+private:
+    // Returns modifiable pointer to item in database or nullptr if not found
+    Item* findMutableItem(std::string_view name);
+
+    // Set special of item if it can be priced with. Returns status of operation
+    static bool setValidSpecial(Item& item, const std::shared_ptr<Special>& special);
+
+    // Returns true if an item in the database already uses the GTIN
+    bool hasGtin(uint64_t gtin) const;
 
 private:
     std::vector<Item> mItems; // Items in database
+    std::unordered_map<std::string, std::size_t, StringHash, std::equal_to<>> mIndex; // Index into mItems by item name
+    uint64_t mEpoch = 0; // Number of times changes have been published
+    ItemSearchIndex mSearchIndex; // Type-ahead index over item names
+    GtinIndex mGtinIndex; // Perfect hash of GTINs built at finalize
+    std::vector<uint32_t> mGtinSlots; // Index into mItems by GtinIndex slot
+    std::unordered_map<uint64_t, std::size_t> mGtinOverflow; // Index into mItems by GTIN for items inserted since finalize
 };
 
 #endif
\ No newline at end of file
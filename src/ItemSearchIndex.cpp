@@ -0,0 +1,482 @@
+#include "ItemSearchIndex.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <queue>
+#include <utility>
+
+namespace {
+inline char lower(char c) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+inline bool isWordChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) != 0;
+}
+
+// Case-insensitive a < b
+bool lessNoCase(std::string_view a, std::string_view b) {
+    return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(),
+        [](char x, char y) { return lower(x) < lower(y); });
+}
+
+// Returns true if word starts with prefix, ignoring case. Prefix must be lower case
+bool startsWithNoCase(std::string_view word, std::string_view prefix) {
+    if (word.size() < prefix.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < prefix.size(); ++i) {
+        if (lower(word[i]) != prefix[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Split text into lower case words
+std::vector<std::string> lowerWords(std::string_view text) {
+    std::vector<std::string> words;
+    std::string word;
+    for (char c : text) {
+        if (isWordChar(c)) {
+            word += lower(c);
+        } else if (!word.empty()) {
+            words.push_back(std::move(word));
+            word.clear();
+        }
+    }
+    if (!word.empty()) {
+        words.push_back(std::move(word));
+    }
+    return words;
+}
+
+// Pack the first four lower case characters of a word, padded with zeros, so comparing keys
+// orders words like comparing the characters
+uint32_t packKey(std::string_view word) {
+    uint32_t key = 0;
+    for (std::size_t i = 0; i < 4; ++i) {
+        key = (key << 8) | (i < word.size() ? static_cast<unsigned char>(lower(word[i])) : 0U);
+    }
+    return key;
+}
+
+// Signature bit of the first one and first three characters of a word. A name signature holds
+// the bits of all its words, so a query word whose bit is missing cannot match the name
+uint64_t prefixBit(std::string_view word) {
+    uint64_t hash = 0;
+    for (std::size_t i = 0; i < std::min<std::size_t>(word.size(), 3); ++i) {
+        hash = (hash + static_cast<unsigned char>(lower(word[i])) + 1) * 0x9e3779b97f4a7c15ULL;
+    }
+    return uint64_t(1) << (hash >> 58);
+}
+
+uint64_t wordSignature(std::string_view word) {
+    return prefixBit(word.substr(0, 1)) | ((word.size() >= 3) ? prefixBit(word) : 0);
+}
+
+// Bits that must be in the signature of a name matching the query word
+uint64_t querySignature(std::string_view word) {
+    return prefixBit(word.substr(0, (word.size() >= 3) ? 3 : 1));
+}
+
+// Returns true if every word but skip is a prefix of some word of name
+bool matchesAll(std::string_view name, const std::vector<std::string>& words, std::size_t skip) {
+    for (std::size_t w = 0; w < words.size(); ++w) {
+        if (w == skip) {
+            continue;
+        }
+        bool found = false;
+        for (std::size_t i = 0; i < name.size() && !found; ++i) {
+            if (isWordChar(name[i]) && (i == 0 || !isWordChar(name[i - 1]))) {
+                found = startsWithNoCase(name.substr(i), words[w]);
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// String within one edit of a word, sharing its first shared characters with the word
+struct Variant {
+    std::string text;
+    std::size_t shared;
+};
+
+// Returns all strings within one edit of word. Substitutions and insertions before the first
+// character are left out since those rarely are typos and would each search the whole index
+std::vector<Variant> typoVariants(const std::string& word) {
+    static const std::string alphabet = "abcdefghijklmnopqrstuvwxyz0123456789";
+    std::vector<Variant> variants;
+    for (std::size_t i = 0; i < word.size(); ++i) {
+        // Deletion
+        variants.push_back({word.substr(0, i) + word.substr(i + 1), i});
+        // Transposition
+        if (i + 1 < word.size() && word[i] != word[i + 1]) {
+            std::string swapped = word;
+            std::swap(swapped[i], swapped[i + 1]);
+            variants.push_back({swapped, i});
+        }
+        if (i == 0) {
+            continue;
+        }
+        // Substitution
+        for (char c : alphabet) {
+            if (c != word[i]) {
+                std::string sub = word;
+                sub[i] = c;
+                variants.push_back({sub, i});
+            }
+        }
+        // Insertion. Insertion at the end is already covered by prefix matching
+        for (char c : alphabet) {
+            variants.push_back({word.substr(0, i) + c + word.substr(i), i});
+        }
+    }
+    return variants;
+}
+}
+
+void ItemSearchIndex::addEntries(const std::vector<Item>& items, uint32_t itemIdx, std::vector<Entry>& entries) {
+    const std::string& name = items[itemIdx].getName();
+    const uint32_t nameRank = static_cast<uint32_t>(std::min<std::size_t>(name.size(), 0xffff));
+    const std::size_t first = entries.size();
+    uint64_t signature = 0;
+    uint8_t position = 0;
+    std::size_t i = 0;
+    while (i < name.size() && i <= 0xffff) {
+        if (!isWordChar(name[i])) {
+            ++i;
+            continue;
+        }
+        std::size_t start = i;
+        while (i < name.size() && isWordChar(name[i])) {
+            ++i;
+        }
+        Entry entry;
+        entry.item = itemIdx;
+        entry.rank = (static_cast<uint32_t>(std::min<uint8_t>(position, 15)) << 16) | nameRank;
+        entry.offset = static_cast<uint16_t>(start);
+        entry.length = static_cast<uint8_t>(std::min<std::size_t>(i - start, 0xff));
+        entry.position = position;
+        entry.key = packKey(getWord(items, entry));
+        signature |= wordSignature(getWord(items, entry));
+        entries.push_back(entry);
+        if (position < 0xff) {
+            ++position;
+        }
+    }
+    for (std::size_t e = first; e < entries.size(); ++e) {
+        entries[e].signature = signature;
+    }
+}
+
+std::string_view ItemSearchIndex::getWord(const std::vector<Item>& items, const Entry& entry) {
+    return std::string_view(items[entry.item].getName()).substr(entry.offset, entry.length);
+}
+
+bool ItemSearchIndex::entryLess(const std::vector<Item>& items, const Entry& a, const Entry& b) {
+    if (a.key != b.key) {
+        return a.key < b.key;
+    }
+    std::string_view wa = getWord(items, a), wb = getWord(items, b);
+    if (lessNoCase(wa, wb)) return true;
+    if (lessNoCase(wb, wa)) return false;
+    return a.rank < b.rank;
+}
+
+void ItemSearchIndex::insert(const std::vector<Item>& items, uint32_t itemIdx) {
+    std::vector<Entry> added;
+    addEntries(items, itemIdx, added);
+
+    auto less = [&items](const Entry& a, const Entry& b) { return entryLess(items, a, b); };
+    for (const auto& entry : added) {
+        mPending.entries.insert(std::upper_bound(mPending.entries.begin(), mPending.entries.end(), entry, less), entry);
+    }
+    if (mPending.entries.size() >= kPendingSize) {
+        flushPending(items);
+    }
+}
+
+void ItemSearchIndex::flushPending(const std::vector<Item>& items) {
+    Run run;
+    run.entries = std::move(mPending.entries);
+    mPending.entries.clear();
+    buildBlockBest(run);
+    mRuns.push_back(std::move(run));
+
+    // Merge the newest runs while they are of similar size, so each entry is merged O(log n) times
+    auto less = [&items](const Entry& a, const Entry& b) { return entryLess(items, a, b); };
+    while (mRuns.size() >= 2 && mRuns[mRuns.size() - 2].entries.size() < kRunGrowth * mRuns.back().entries.size()) {
+        Run& older = mRuns[mRuns.size() - 2];
+        const Run& newer = mRuns.back();
+        std::vector<Entry> merged;
+        merged.reserve(older.entries.size() + newer.entries.size());
+        std::merge(older.entries.begin(), older.entries.end(), newer.entries.begin(), newer.entries.end(),
+                   std::back_inserter(merged), less);
+        older.entries = std::move(merged);
+        mRuns.pop_back();
+        buildBlockBest(mRuns.back());
+    }
+}
+
+void ItemSearchIndex::buildBlockBest(Run& run) {
+    const auto& entries = run.entries;
+
+    // Level 0 holds the best entry of each block, level l the best of 2^l blocks
+    const std::size_t numBlocks = (entries.size() + kBlockSize - 1) / kBlockSize;
+    run.blockBest.assign(1, std::vector<uint32_t>(numBlocks));
+    for (std::size_t b = 0; b < numBlocks; ++b) {
+        std::size_t best = b * kBlockSize;
+        for (std::size_t e = best + 1; e < std::min(entries.size(), (b + 1) * kBlockSize); ++e) {
+            if (entries[e].rank < entries[best].rank) {
+                best = e;
+            }
+        }
+        run.blockBest[0][b] = static_cast<uint32_t>(best);
+    }
+    for (std::size_t level = 1; (std::size_t(1) << level) <= numBlocks; ++level) {
+        const auto& prev = run.blockBest[level - 1];
+        std::vector<uint32_t> cur(numBlocks - (std::size_t(1) << level) + 1);
+        for (std::size_t b = 0; b < cur.size(); ++b) {
+            uint32_t x = prev[b], y = prev[b + (std::size_t(1) << (level - 1))];
+            cur[b] = (entries[y].rank < entries[x].rank) ? y : x;
+        }
+        run.blockBest.push_back(std::move(cur));
+    }
+}
+
+std::size_t ItemSearchIndex::rangeBest(const Run& run, std::size_t lo, std::size_t hi) {
+    const auto& entries = run.entries;
+    auto better = [&entries](std::size_t x, std::size_t y) { return (entries[y].rank < entries[x].rank) ? y : x; };
+
+    std::size_t best = lo;
+    const std::size_t firstBlock = (lo + kBlockSize - 1) / kBlockSize; // First whole block
+    const std::size_t lastBlock = hi / kBlockSize;                     // One past last whole block
+    if (run.blockBest.empty() || firstBlock >= lastBlock) {
+        for (std::size_t e = lo + 1; e < hi; ++e) {
+            best = better(best, e);
+        }
+        return best;
+    }
+
+    // Partial blocks at both ends
+    for (std::size_t e = lo + 1; e < firstBlock * kBlockSize; ++e) {
+        best = better(best, e);
+    }
+    for (std::size_t e = lastBlock * kBlockSize; e < hi; ++e) {
+        best = better(best, e);
+    }
+
+    // Whole blocks through two overlapping sparse table lookups
+    std::size_t level = 0;
+    while ((std::size_t(2) << level) <= lastBlock - firstBlock) {
+        ++level;
+    }
+    best = better(best, run.blockBest[level][firstBlock]);
+    best = better(best, run.blockBest[level][lastBlock - (std::size_t(1) << level)]);
+    return best;
+}
+
+std::pair<std::size_t, std::size_t> ItemSearchIndex::prefixRange(const std::vector<Item>& items, const std::vector<Entry>& entries,
+                                                                 std::size_t lo, std::size_t hi, std::string_view prefix) {
+    // Most comparisons are decided by the packed keys without touching the names
+    const uint32_t key = packKey(prefix);
+    const uint32_t mask = (prefix.size() >= 4) ? ~0U : ~(~0U >> (8 * prefix.size()));
+    auto first = std::lower_bound(entries.begin() + lo, entries.begin() + hi, prefix, [&](const Entry& entry, std::string_view p) {
+        if (entry.key != key) {
+            return entry.key < key;
+        }
+        return lessNoCase(getWord(items, entry), p);
+    });
+    auto last = std::upper_bound(first, entries.begin() + hi, prefix, [&](std::string_view p, const Entry& entry) {
+        if ((entry.key & mask) != key) {
+            return key < (entry.key & mask);
+        }
+        if (p.size() <= 4) {
+            return false;
+        }
+        std::string_view word = getWord(items, entry);
+        return lessNoCase(p, word.substr(0, std::min(word.size(), p.size())));
+    });
+    return {static_cast<std::size_t>(first - entries.begin()), static_cast<std::size_t>(last - entries.begin())};
+}
+
+const ItemSearchIndex::Run& ItemSearchIndex::runAt(std::size_t r) const {
+    return (r < mRuns.size()) ? mRuns[r] : mPending;
+}
+
+std::size_t ItemSearchIndex::numRuns() const {
+    return mRuns.size() + 1;
+}
+
+template <typename Accept>
+void ItemSearchIndex::collect(const std::vector<std::pair<std::size_t, std::size_t>>& runRanges, std::size_t count, Accept accept,
+                              std::vector<Candidate>& out) const {
+    // Entries of all runs are visited best first by splitting each range around its best entry
+    struct Range {
+        std::size_t run, best, lo, hi;
+    };
+    auto rankOf = [this](const Range& r) { return runAt(r.run).entries[r.best].rank; };
+    auto worse = [&rankOf](const Range& a, const Range& b) { return rankOf(a) > rankOf(b); };
+    std::priority_queue<Range, std::vector<Range>, decltype(worse)> ranges(worse);
+    for (std::size_t r = 0; r < runRanges.size(); ++r) {
+        if (runRanges[r].first < runRanges[r].second) {
+            ranges.push({r, rangeBest(runAt(r), runRanges[r].first, runRanges[r].second), runRanges[r].first, runRanges[r].second});
+        }
+    }
+
+    std::size_t taken = 0, visited = 0;
+    while (taken < count && !ranges.empty() && visited++ < kMaxVisits) {
+        Range r = ranges.top();
+        ranges.pop();
+        const Run& run = runAt(r.run);
+        const Entry& entry = run.entries[r.best];
+        if (r.lo < r.best) {
+            ranges.push({r.run, rangeBest(run, r.lo, r.best), r.lo, r.best});
+        }
+        if (r.best + 1 < r.hi) {
+            ranges.push({r.run, rangeBest(run, r.best + 1, r.hi), r.best + 1, r.hi});
+        }
+
+        if (accept(entry)) {
+            out.push_back({entry.rank, entry.item});
+            ++taken;
+        }
+    }
+}
+
+std::vector<uint32_t> ItemSearchIndex::search(const std::vector<Item>& items, std::string_view query, std::size_t maxResults) const {
+    std::vector<uint32_t> results;
+    auto words = lowerWords(query);
+    if (words.empty() || maxResults == 0) {
+        return results;
+    }
+
+    // Candidates come from the query word with the fewest matching entries. Other words filter
+    // them. The most selective word other than the last is kept for the typo search below
+    std::vector<std::pair<std::size_t, std::size_t>> ranges(numRuns()), bestRanges, leadRanges;
+    std::size_t bestWord = 0, bestCount = 0, leadCount = 0;
+    for (std::size_t w = 0; w < words.size(); ++w) {
+        std::size_t count = 0;
+        for (std::size_t r = 0; r < numRuns(); ++r) {
+            ranges[r] = prefixRange(items, runAt(r).entries, 0, runAt(r).entries.size(), words[w]);
+            count += ranges[r].second - ranges[r].first;
+        }
+        if (w == 0 || count < bestCount) {
+            bestWord = w;
+            bestCount = count;
+            bestRanges = ranges;
+        }
+        if (w + 1 < words.size() && (w == 0 || count < leadCount)) {
+            leadCount = count;
+            leadRanges = ranges;
+        }
+    }
+
+    uint64_t filter = 0;
+    for (std::size_t w = 0; w < words.size(); ++w) {
+        filter |= querySignature(words[w]);
+    }
+    auto accept = [&](const Entry& entry) {
+        if ((entry.signature & filter) != filter ||
+            std::find(results.begin(), results.end(), entry.item) != results.end() ||
+            !matchesAll(items[entry.item].getName(), words, bestWord)) {
+            return false;
+        }
+        results.push_back(entry.item);
+        return true;
+    };
+    std::vector<Candidate> found;
+    collect(bestRanges, maxResults, accept, found);
+    const std::string& last = words.back();
+    if (results.size() >= maxResults || last.size() < 2 || (words.size() > 1 && leadCount == 0)) {
+        return results; // Typos are only fixed in the last word, so the other words must match
+    }
+
+    // Too few prefix matches, so try names one typo away from the last word. Ranges of each
+    // prefix of the last word narrow the search of every variant sharing that prefix
+    std::vector<std::vector<std::pair<std::size_t, std::size_t>>> narrowed(last.size() + 1, ranges);
+    for (std::size_t r = 0; r < numRuns(); ++r) {
+        narrowed[0][r] = {0, runAt(r).entries.size()};
+        for (std::size_t i = 1; i <= last.size(); ++i) {
+            narrowed[i][r] = prefixRange(items, runAt(r).entries, narrowed[i - 1][r].first, narrowed[i - 1][r].second,
+                                         std::string_view(last).substr(0, i));
+        }
+    }
+
+    // Typo matches rank after exact ones
+    std::vector<Candidate> fuzzy;
+    std::vector<uint32_t> exact = results;
+    filter = 0;
+    for (std::size_t w = 0; w + 1 < words.size(); ++w) {
+        filter |= querySignature(words[w]);
+    }
+    auto acceptTypo = [&](const Entry& entry) {
+        return (entry.signature & filter) == filter &&
+               std::find(exact.begin(), exact.end(), entry.item) == exact.end() &&
+               matchesAll(items[entry.item].getName(), words, words.size() - 1);
+    };
+    std::vector<std::string> variants;  // Variants found in the index
+    std::vector<std::vector<std::pair<std::size_t, std::size_t>>> variantRanges; // Their ranges
+    std::size_t variantCount = 0;
+    for (const auto& variant : typoVariants(last)) {
+        std::size_t count = 0;
+        for (std::size_t r = 0; r < numRuns(); ++r) {
+            const auto& within = narrowed[variant.shared][r];
+            ranges[r] = prefixRange(items, runAt(r).entries, within.first, within.second, variant.text);
+            count += ranges[r].second - ranges[r].first;
+        }
+        if (count > 0) {
+            variants.push_back(variant.text);
+            variantRanges.push_back(ranges);
+            variantCount += count;
+        }
+    }
+
+    if (words.size() > 1 && leadCount < variantCount) {
+        // The other words are more selective than the variants, so take candidates from them
+        // and check the names for a variant instead of walking every variant range
+        std::vector<std::string> lastWord(1);
+        auto acceptLead = [&](const Entry& entry) {
+            if (!acceptTypo(entry)) {
+                return false;
+            }
+            for (const auto& text : variants) {
+                lastWord[0] = text;
+                if (matchesAll(items[entry.item].getName(), lastWord, lastWord.size())) {
+                    return true;
+                }
+            }
+            return false;
+        };
+        collect(leadRanges, maxResults - exact.size(), acceptLead, fuzzy);
+    } else {
+        for (const auto& within : variantRanges) {
+            collect(within, maxResults - exact.size(), acceptTypo, fuzzy);
+        }
+    }
+    std::stable_sort(fuzzy.begin(), fuzzy.end(), [](const Candidate& a, const Candidate& b) { return a.rank < b.rank; });
+    for (const auto& candidate : fuzzy) {
+        if (results.size() >= maxResults) {
+            break;
+        }
+        if (std::find(results.begin(), results.end(), candidate.item) == results.end()) {
+            results.push_back(candidate.item);
+        }
+    }
+    return results;
+}
+
+std::size_t ItemSearchIndex::memoryBytes() const {
+    std::size_t bytes = mPending.entries.capacity() * sizeof(Entry);
+    for (const auto& run : mRuns) {
+        bytes += run.entries.capacity() * sizeof(Entry);
+        for (const auto& level : run.blockBest) {
+            bytes += level.capacity() * sizeof(uint32_t);
+        }
+    }
+    return bytes;
+}
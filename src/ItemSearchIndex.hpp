@@ -0,0 +1,112 @@
+#ifndef __ITEMSEARCHINDEX_HPP__
+#define __ITEMSEARCHINDEX_HPP__
+
+#include "Item.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Type-ahead search over item names for manual entry. Every word of every name is kept in
+// case-insensitive sorted runs, so the words starting with a prefix form one contiguous range
+// per run. Each word carries a static rank (first word of the name and shorter names rank
+// higher) and every run has a block range-minimum table over the ranks, so the top matches of
+// a range are found without visiting all of it. Multi-word queries take candidates from the
+// most selective word and check the others against a small prefix signature of the name first.
+//
+// New items land in a small sorted pending buffer. Full buffers become runs and runs of
+// similar size are merged (log-structured), so inserts stay cheap and the number of runs
+// stays logarithmic.
+//
+// The index stores item positions, not names, so the item vector is passed to every call.
+class ItemSearchIndex {
+public:
+    // Default constructor. Creates an empty index
+    ItemSearchIndex() {}
+
+    // Add the item at position itemIdx of items to the index
+    void insert(const std::vector<Item>& items, uint32_t itemIdx);
+
+    // Returns positions of up to maxResults items best matching the query. Every word of the
+    // query must be a prefix of a word in the item name. If too few items match, names within
+    // one typo (insertion, deletion, substitution or transposition) of the last word are added.
+    // The first letter of the last word is assumed to be correct except for transpositions.
+    // Matches are searched best ranked first with a bounded number of entries visited, so very
+    // rare matches within many similar names may be left out
+    std::vector<uint32_t> search(const std::vector<Item>& items, std::string_view query, std::size_t maxResults) const;
+
+    // Return bytes used by the index
+    std::size_t memoryBytes() const;
+
+private:
+    // Single word of an item name
+    struct Entry {
+        uint32_t item;      // Position of item
+        uint32_t rank;      // Static rank of the word. Lower is better
+        uint32_t key;       // First four lower case characters of the word, for cheap comparisons
+        uint64_t signature; // Bits of word prefixes in the whole name, to filter without the name
+        uint16_t offset;    // Offset of word in name
+        uint8_t length;     // Length of word
+        uint8_t position;   // Index of word in name
+    };
+
+    // Sorted entries with a sparse table of the best ranked entry per 2^level blocks
+    struct Run {
+        std::vector<Entry> entries;
+        std::vector<std::vector<uint32_t>> blockBest;
+    };
+
+    // Candidate item and the rank of its best matching word
+    struct Candidate {
+        uint32_t rank;
+        uint32_t item;
+    };
+
+    // Append the entries of the words of an item
+    static void addEntries(const std::vector<Item>& items, uint32_t itemIdx, std::vector<Entry>& entries);
+
+    // Returns word of an entry
+    static std::string_view getWord(const std::vector<Item>& items, const Entry& entry);
+
+    // Returns true if entry a sorts before entry b
+    static bool entryLess(const std::vector<Item>& items, const Entry& a, const Entry& b);
+
+    // Returns range of entries in [lo, hi) whose words start with prefix
+    static std::pair<std::size_t, std::size_t> prefixRange(const std::vector<Item>& items, const std::vector<Entry>& entries,
+                                                           std::size_t lo, std::size_t hi, std::string_view prefix);
+
+    // Build the range-minimum table of a run
+    static void buildBlockBest(Run& run);
+
+    // Returns position of the best ranked entry in [lo, hi) of a run
+    static std::size_t rangeBest(const Run& run, std::size_t lo, std::size_t hi);
+
+    // Returns run at position r. The pending buffer is the last run
+    const Run& runAt(std::size_t r) const;
+
+    // Returns the number of runs including the pending buffer
+    std::size_t numRuns() const;
+
+    // Append up to count best candidates in the given ranges, one range per run, in rank
+    // order. Candidates are only taken if accept returns true for their entry. Stops after
+    // kMaxVisits entries, so a query whose matches are rare within large ranges stays cheap
+    template <typename Accept>
+    void collect(const std::vector<std::pair<std::size_t, std::size_t>>& runRanges, std::size_t count, Accept accept,
+                 std::vector<Candidate>& out) const;
+
+    // Turn the pending buffer into a run and merge runs of similar size
+    void flushPending(const std::vector<Item>& items);
+
+private:
+    static constexpr std::size_t kBlockSize = 32;       // Entries per block of the range-minimum table
+    static constexpr std::size_t kPendingSize = 256;    // Entries buffered before forming a run
+    static constexpr std::size_t kRunGrowth = 4;        // Runs are merged while within this size factor
+    static constexpr std::size_t kMaxVisits = 1024;     // Entries visited per collect call
+
+    std::vector<Run> mRuns;     // Sorted runs, largest first
+    Run mPending;               // Sorted entries not yet in a run. Has no range-minimum table
+};
+
+#endif
@@ -0,0 +1,160 @@
+#include "LiveCatalog.hpp"
+
+#include <iostream>
+
+namespace {
+constexpr std::size_t kLayerGrowth = 4;    // Layers are merged while within this size factor
+constexpr std::size_t kFoldFraction = 4;   // Layers are folded once they hold 1/kFoldFraction of the base
+}
+
+LiveCatalog::LiveCatalog(std::shared_ptr<const ItemDatabase> base) :
+    mSnapshot{}, mUpdateMutex{}
+{
+    auto snapshot = std::make_shared<Snapshot>();
+    snapshot->mNumItems = base->getItems().size();
+    snapshot->mBase = std::move(base);
+    mSnapshot.store(std::move(snapshot), std::memory_order_release);
+}
+
+std::shared_ptr<const LiveCatalog::Snapshot> LiveCatalog::getSnapshot() const {
+    return mSnapshot.load(std::memory_order_acquire);
+}
+
+bool LiveCatalog::applyDelta(const CatalogDelta& delta) {
+    std::lock_guard<std::mutex> lock(mUpdateMutex);
+
+    // Stage changes on copies of the affected items in a new layer. Published snapshots are
+    // never touched, so a failure anywhere leaves nothing behind
+    std::shared_ptr<const Snapshot> current = mSnapshot.load(std::memory_order_acquire);
+    auto layer = std::make_shared<Layer>();
+    std::size_t numItems = current->mNumItems;
+    for (const auto& change : delta.getChanges()) {
+        if (CatalogDelta::Change::Type_t::Insert == change.type) {
+            if (current->findItem(change.name) || layer->items.count(change.name)) {
+                std::cerr << "Item already exists" << std::endl;
+                return false;
+            }
+            Item item(change.name, change.saleType, change.price);
+            if (!item.setGtin(change.gtin)) {
+                return false;
+            }
+            if (change.gtin != 0) {
+                if (current->findItemByGtin(change.gtin) || !layer->gtins.emplace(change.gtin, change.name).second) {
+                    std::cerr << "GTIN already exists" << std::endl;
+                    return false;
+                }
+            }
+            item.setCatalogIndex(static_cast<uint32_t>(numItems++));
+            layer->items.emplace(change.name, std::move(item));
+            continue;
+        }
+
+        // Find staged copy of item, staging it on first use
+        auto staged_it = layer->items.find(change.name);
+        if (staged_it == layer->items.end()) {
+            const Item* item = current->findItem(change.name);
+            if (!item) {
+                std::cerr << "Item not found" << std::endl;
+                return false;
+            }
+            staged_it = layer->items.emplace(change.name, *item).first;
+        }
+        if (!ItemDatabase::applyChange(change, staged_it->second)) {
+            return false;
+        }
+    }
+    layer->deltas.push_back(std::make_shared<const CatalogDelta>(delta));
+
+    // Build the next snapshot on the side and publish it with one store
+    auto next = std::make_shared<Snapshot>();
+    next->mBase = current->mBase;
+    next->mLayers = current->mLayers;
+    next->mLayers.push_back(std::move(layer));
+    next->mEpoch = current->mEpoch + 1;
+    next->mNumItems = numItems;
+    mergeLayers(*next);
+    if (!foldLayers(*next)) {
+        return false;
+    }
+    mSnapshot.store(std::move(next), std::memory_order_release);
+    return true;
+}
+
+uint64_t LiveCatalog::getEpoch() const {
+    return mSnapshot.load(std::memory_order_acquire)->mEpoch;
+}
+
+void LiveCatalog::mergeLayers(Snapshot& snapshot) {
+    // Each changed item is merged O(log n) times before it is folded
+    auto& layers = snapshot.mLayers;
+    while (layers.size() >= 2 && layers[layers.size() - 2]->items.size() < kLayerGrowth * layers.back()->items.size()) {
+        auto merged = std::make_shared<Layer>(*layers[layers.size() - 2]);
+        const Layer& newer = *layers.back();
+        for (const auto& entry : newer.items) {
+            merged->items.insert_or_assign(entry.first, entry.second);
+        }
+        merged->gtins.insert(newer.gtins.begin(), newer.gtins.end());
+        merged->deltas.insert(merged->deltas.end(), newer.deltas.begin(), newer.deltas.end());
+        layers.pop_back();
+        layers.back() = std::move(merged);
+    }
+}
+
+bool LiveCatalog::foldLayers(Snapshot& snapshot) {
+    std::size_t numChanged = 0;
+    for (const auto& layer : snapshot.mLayers) {
+        numChanged += layer->items.size();
+    }
+    if (numChanged * kFoldFraction < snapshot.mBase->getItems().size()) {
+        return true;
+    }
+
+    // Replay the deltas of the layers on a copy of the base. They were validated against the
+    // same items, so they apply again
+    auto base = std::make_shared<ItemDatabase>(*snapshot.mBase);
+    for (const auto& layer : snapshot.mLayers) {
+        for (const auto& delta : layer->deltas) {
+            if (!base->applyDelta(*delta)) {
+                return false;
+            }
+        }
+    }
+    base->finalize(); // On failure items added since the last finalize stay in the overflow index
+    snapshot.mBase = std::move(base);
+    snapshot.mLayers.clear();
+    return true;
+}
+
+const Item* LiveCatalog::Snapshot::findItem(std::string_view name) const {
+    for (auto it = mLayers.rbegin(); it != mLayers.rend(); ++it) {
+        auto item_it = (*it)->items.find(name);
+        if (item_it != (*it)->items.end()) {
+            return &item_it->second;
+        }
+    }
+    return mBase->findItem(name);
+}
+
+const Item* LiveCatalog::Snapshot::findItemByGtin(uint64_t gtin) const {
+    // GTINs are only set on insert, so a GTIN names the same item in every layer
+    for (auto it = mLayers.rbegin(); it != mLayers.rend(); ++it) {
+        auto gtin_it = (*it)->gtins.find(gtin);
+        if (gtin_it != (*it)->gtins.end()) {
+            return findItem(gtin_it->second);
+        }
+    }
+    const Item* item = mBase->findItemByGtin(gtin);
+    return (item && !mLayers.empty()) ? findItem(item->getName()) : item;
+}
+
+uint64_t LiveCatalog::Snapshot::getEpoch() const {
+    return mEpoch;
+}
+
+std::size_t LiveCatalog::Snapshot::size() const {
+    return mNumItems;
+}
+
+std::size_t LiveCatalog::Snapshot::numLayers() const {
+    return mLayers.size();
+}
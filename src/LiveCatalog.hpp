@@ -0,0 +1,94 @@
+#ifndef __LIVECATALOG_HPP__
+#define __LIVECATALOG_HPP__
+
+#include "CatalogDelta.hpp"
+#include "ItemCatalog.hpp"
+#include "ItemDatabase.hpp"
+#include "StringHash.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Catalog that takes intraday deltas while lanes keep pricing against it. Every delta is
+// published as a new immutable snapshot with a single pointer swap, so a lane sees either all
+// of a delta or none of it. Lanes take a snapshot per order and keep it alive for as long as
+// the order uses it.
+//
+// A snapshot is a shared base ItemDatabase with layers of changed items on top. A delta only
+// builds a layer holding the items it changes, and layers of similar size are merged
+// (log-structured), so applying a delta costs about the size of the delta and a lookup checks
+// a logarithmic number of layers. Once the layers hold a quarter as many items as the base
+// they are folded into a new base, which adds a constant per changed item when amortized.
+class LiveCatalog {
+public:
+    class Snapshot;
+
+    // Constructor. Base must not be modified while shared
+    explicit LiveCatalog(std::shared_ptr<const ItemDatabase> base);
+
+    // Returns current snapshot
+    std::shared_ptr<const Snapshot> getSnapshot() const;
+
+    // Validate all changes of the delta and publish them as one new snapshot. Nothing is
+    // published if any change is invalid or memory runs out. Returns status of operation
+    bool applyDelta(const CatalogDelta& delta);
+
+    // Return number of deltas published
+    uint64_t getEpoch() const;
+
+private:
+    struct Layer;
+
+    // Merge the newest layers of a snapshot while they are of similar size
+    static void mergeLayers(Snapshot& snapshot);
+
+    // Fold the layers of a snapshot into a new base. Returns status of operation
+    static bool foldLayers(Snapshot& snapshot);
+
+private:
+    std::atomic<std::shared_ptr<const Snapshot>> mSnapshot;  // Published snapshot
+    std::mutex mUpdateMutex;                                // Serializes updates
+};
+
+// Changed items of one or more deltas
+struct LiveCatalog::Layer {
+    std::unordered_map<std::string, Item, StringHash, std::equal_to<>> items;  // Changed or added items by name
+    std::unordered_map<uint64_t, std::string> gtins;                           // Names of added items by GTIN
+    std::vector<std::shared_ptr<const CatalogDelta>> deltas;                   // Deltas of the layer, oldest first
+};
+
+// Immutable view of the catalog after a number of deltas
+class LiveCatalog::Snapshot : public ItemCatalog {
+public:
+    // Returns pointer to item or nullptr if not found. Valid as long as the snapshot
+    const Item* findItem(std::string_view name) const override;
+
+    // Returns pointer to item with the given GTIN or nullptr if not found
+    const Item* findItemByGtin(uint64_t gtin) const override;
+
+    // Return number of deltas published before the snapshot. Never changes
+    uint64_t getEpoch() const override;
+
+    // Return number of items
+    std::size_t size() const;
+
+    // Return number of layers on top of the base
+    std::size_t numLayers() const;
+
+private:
+    friend class LiveCatalog;
+
+    std::shared_ptr<const ItemDatabase> mBase;          // Items as of the last fold
+    std::vector<std::shared_ptr<const Layer>> mLayers;  // Changes since the last fold, largest and oldest first
+    uint64_t mEpoch = 0;                                // Number of deltas before the snapshot
+    std::size_t mNumItems = 0;                          // Number of items
+};
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef __MEMORYUSAGE_HPP__
+#define __MEMORYUSAGE_HPP__
+
+#include <cstddef>
+#include <string>
+
+// Estimates of the heap memory behind standard library types, for the memory reports of
+// catalogs and orders. Allocator overhead per block is not included.
+
+// Bytes of the control block of a shared_ptr made by make_shared: two counts and a vtable
+inline constexpr std::size_t kSharedControlBytes = 2 * sizeof(int) + sizeof(void*);
+
+// Returns heap bytes of a string of any allocator. Short strings are stored inside the string object
+template <typename String>
+std::size_t stringHeapBytes(const String& str) {
+    static const std::size_t inlineCapacity = String().capacity();
+    return (str.capacity() > inlineCapacity) ? str.capacity() + 1 : 0;
+}
+
+// Returns heap bytes of the buckets and nodes of an unordered container, not counting memory
+// the elements own themselves. Nodes hold a next pointer, the element and a cached hash
+template <typename HashTable>
+std::size_t hashTableBytes(const HashTable& table) {
+    return table.bucket_count() * sizeof(void*) +
+           table.size() * (sizeof(void*) + sizeof(typename HashTable::value_type) + sizeof(std::size_t));
+}
+
+#endif
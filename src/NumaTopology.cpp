@@ -0,0 +1,127 @@
+#include "NumaTopology.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+NumaTopology::NumaTopology(const std::vector<std::string>& nodeCpuLists) :
+    mNodes{}
+{
+    for (const auto& list : nodeCpuLists) {
+        std::vector<int> cpus;
+        if (!parseCpuList(list, cpus) || cpus.empty()) {
+            mNodes.clear();
+            break;
+        }
+        mNodes.push_back(std::move(cpus));
+    }
+    if (mNodes.empty()) {
+        mNodes.emplace_back();
+    }
+}
+
+NumaTopology NumaTopology::detect() {
+    // Nodes are numbered densely from 0, memory only nodes have an empty CPU list
+    std::vector<std::string> lists;
+    for (unsigned int node = 0;; ++node) {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        std::string list;
+        if (!file || !std::getline(file, list)) {
+            break;
+        }
+        if (!list.empty()) {
+            lists.push_back(list);
+        }
+    }
+    return NumaTopology(lists);
+}
+
+bool NumaTopology::parseCpuList(std::string_view list, std::vector<int>& cpus) {
+    cpus.clear();
+    const std::string text(list);
+    const char* pos = text.c_str();
+    while (*pos != '\0') {
+        // Each comma separated entry is a CPU or an inclusive range of CPUs
+        char* end = nullptr;
+        const long first = std::strtol(pos, &end, 10);
+        long last = first;
+        if (end == pos || first < 0) {
+            return false;
+        }
+        if (*end == '-') {
+            pos = end + 1;
+            last = std::strtol(pos, &end, 10);
+            if (end == pos || last < first) {
+                return false;
+            }
+        }
+        if (*end != ',' && *end != '\0') {
+            return false;
+        }
+        for (long cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+        pos = (*end == ',') ? end + 1 : end;
+    }
+    return true;
+}
+
+unsigned int NumaTopology::getNumNodes() const {
+    return static_cast<unsigned int>(mNodes.size());
+}
+
+const std::vector<int>& NumaTopology::getCpus(unsigned int node) const {
+    return mNodes[node];
+}
+
+unsigned int NumaTopology::getNodeOfCpu(int cpu) const {
+    for (unsigned int node = 0; node < mNodes.size(); ++node) {
+        for (int nodeCpu : mNodes[node]) {
+            if (nodeCpu == cpu) {
+                return node;
+            }
+        }
+    }
+    return 0;
+}
+
+unsigned int NumaTopology::getCurrentNode() const {
+#ifdef __linux__
+    if (mNodes.size() > 1) {
+        const int cpu = sched_getcpu();
+        return (cpu < 0) ? 0 : getNodeOfCpu(cpu);
+    }
+#endif
+    return 0;
+}
+
+bool NumaTopology::pinThread(unsigned int node) const {
+    if (node >= mNodes.size()) {
+        std::cerr << "Invalid NUMA node" << std::endl;
+        return false;
+    }
+    if (mNodes[node].empty()) {
+        return true; // Single node without CPU information, nothing to restrict
+    }
+
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : mNodes[node]) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        std::cerr << "Could not pin thread to NUMA node" << std::endl;
+        return false;
+    }
+    return true;
+#else
+    return true;
+#endif
+}
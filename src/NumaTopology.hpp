@@ -0,0 +1,42 @@
+#ifndef __NUMATOPOLOGY_HPP__
+#define __NUMATOPOLOGY_HPP__
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// CPUs of each NUMA node of the machine. Read from /sys/devices/system/node on Linux; other
+// systems and machines without NUMA information are treated as a single node with all CPUs.
+class NumaTopology {
+public:
+    // Constructor. Creates a topology from the CPU list of every node, e.g. { "0-3,8-11", "4-7" }.
+    // Invalid or empty lists leave the topology as a single node with all CPUs
+    explicit NumaTopology(const std::vector<std::string>& nodeCpuLists);
+
+    // Returns topology of the machine
+    static NumaTopology detect();
+
+    // Parse a kernel CPU list such as "0-3,8,10-11" into cpus. Returns status of operation
+    static bool parseCpuList(std::string_view list, std::vector<int>& cpus);
+
+    // Return number of nodes. Always at least one
+    unsigned int getNumNodes() const;
+
+    // Return CPUs of a node. Empty means any CPU
+    const std::vector<int>& getCpus(unsigned int node) const;
+
+    // Returns node of a CPU, or node 0 if unknown
+    unsigned int getNodeOfCpu(int cpu) const;
+
+    // Returns node of the CPU the calling thread runs on
+    unsigned int getCurrentNode() const;
+
+    // Restrict the calling thread to the CPUs of a node, so its allocations are first touched
+    // there. Returns status of operation
+    bool pinThread(unsigned int node) const;
+
+private:
+    std::vector<std::vector<int>> mNodes;   // CPUs of each node
+};
+
+#endif
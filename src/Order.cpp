@@ -1,55 +1,222 @@
 #include "Order.hpp"
+#include "MemoryUsage.hpp"
 
-#include <optional>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <iterator>
+#include <new>
 
-Order::Order(const ItemDatabase& db) :
-    mDatabase(db), mTotalPrice(0), mCart{}
+Order::Order(const ItemCatalog& catalog) :
+    mCatalog(catalog), mItemCache(catalog), mTotalPrice(0), mRegularPrice(0), mCouponDiscount(0), mCouponBook(nullptr), mRedemptions{},
+    mLoyaltyMember(false), mTaxableSubtotals{}, mNextSequence(0), mEvents(nullptr), mSales(nullptr), mWeighing{}, mScans{}, mCartMemory{}, mCart(&mCartMemory)
 {}
 
+void Order::setEventQueue(CartEventQueue* queue) {
+    mEvents = queue;
+}
+
+void Order::setSalesLane(SalesAggregator::Lane* lane) {
+    mSales = lane;
+}
+
+void Order::Reset() {
+    mCart.clear();
+    mScans.clear();
+    mRedemptions.clear();
+    mCouponBook = nullptr;
+    mCouponDiscount = 0;
+    mTotalPrice = 0;
+    mRegularPrice = 0;
+    mLoyaltyMember = false;
+    std::fill(std::begin(mTaxableSubtotals), std::end(mTaxableSubtotals), 0.0f);
+    mNextSequence = 0;
+    mWeighing.reset();
+    publishTotal();
+}
+
+void Order::reserve(std::size_t numLines) {
+    mCart.reserve(numLines);
+    mScans.reserve(numLines);
+}
+
+std::size_t Order::memoryBytes() const {
+    std::size_t bytes = sizeof(*this) + hashTableBytes(mCart) + mScans.capacity() * sizeof(ScanRecord) +
+                        mRedemptions.capacity() * sizeof(Redemption);
+    for (const auto& entry : mCart) {
+        bytes += stringHeapBytes(entry.first);
+    }
+    if (mWeighing) {
+        bytes += stringHeapBytes(mWeighing->getName());
+    }
+    return bytes;
+}
+
+const ItemCache& Order::getItemCache() const {
+    return mItemCache;
+}
+
 float Order::getTotalPrice() const {
-    return mTotalPrice;
+    return mTotalPrice - mCouponDiscount;
 }
 
-bool Order::ScanItem(const std::string& name) {
-    // Item must be in database
-    auto item = mDatabase.getItem(name);
-    if (!item.has_value()) {
-        std::cerr << "Item not in database" << std::endl;
-        return false;
+float Order::getSavings() const {
+    return mRegularPrice - getTotalPrice();
+}
+
+float Order::getCouponDiscount() const {
+    return mCouponDiscount;
+}
+
+void Order::setLoyaltyMember(bool member) {
+    mLoyaltyMember = member;
+    if (!member) {
+        // Loyalty coupons no longer apply
+        updateCoupons({});
+        publishTotal();
     }
+}
 
-    // Item must be sold by unit
-    if (Item::Sale_t::Unit != item->getSaleType()) {
-        std::cerr << "Item not sold by unit" << std::endl;
+bool Order::RedeemCoupon(const CouponBook& book, uint32_t id) {
+    // All coupons must come from one book since redemptions refer to coupon positions
+    if (mCouponBook && mCouponBook != &book) {
+        std::cerr << "Coupons must come from one coupon book" << std::endl;
         return false;
     }
 
-    // Find current total price of item and increment quantity
-    float prevPrice = 0;
-    if (mCart.find(name) != mCart.end()) {
-        prevPrice = getItemTotalPrice(item.value(), mCart[name]);
-        mCart[name] = ++std::get<unsigned int>(mCart[name]);
-    } else { // If item isnt already in cart then insert and set the amount to one
-        mCart[name] = 1U;
+    int pos = book.findCoupon(id);
+    if (pos < 0) {
+        std::cerr << "Coupon not found" << std::endl;
+        return false;
+    }
+    for (const auto& redemption : mRedemptions) {
+        if (redemption.coupon == static_cast<uint32_t>(pos)) {
+            std::cerr << "Coupon already redeemed" << std::endl;
+            return false;
+        }
     }
 
-    // Update overall cart total with updated total price of item.
-    mTotalPrice += getItemTotalPrice(item.value(), mCart[name]) - prevPrice;
+    const CouponBook* prevBook = mCouponBook;
+    mCouponBook = &book;
+    float discount = calcCouponDiscount(pos);
+    if (discount < 0) {
+        std::cerr << "Coupon requirements not met" << std::endl;
+        mCouponBook = prevBook;
+        return false;
+    }
 
+    mRedemptions.push_back({static_cast<uint32_t>(pos), discount});
+    mCouponDiscount = std::min(mCouponDiscount + discount, mTotalPrice);
+    publishTotal();
     return true;
 }
 
-bool Order::ScanItem(const std::string& name, float weight) {
-    // Weight must be positive and non zero
-    if (weight <= 0) {
-        std::cerr << "Weight must be positive and non-zero" << std::endl;
+std::size_t Order::RedeemCoupons(const CouponBook& book, const uint32_t* ids, std::size_t count) {
+    std::size_t redeemed = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (RedeemCoupon(book, ids[i])) {
+            ++redeemed;
+        }
+    }
+    return redeemed;
+}
+
+void Order::Reprice(bool onlyIfLower) {
+    mScans.clear();
+    for (auto& [name, line] : mCart) {
+        const Item* item = mCatalog.findItem(name);
+        if (!item || (onlyIfLower && getItemTotalPrice(*item, line.amount) >= line.totalPrice)) {
+            continue;
+        }
+        const float prevDiscount = getSpecialDiscount(line);
+        const float prevRegular = getLineRegularPrice(line);
+        const float priceDelta = updateLine(*item, line);
+        const float regularDelta = getLineRegularPrice(line) - prevRegular;
+        mTotalPrice += priceDelta;
+        mRegularPrice += regularDelta;
+        recordSale(*item, 0, priceDelta, regularDelta);
+        publishLine(CartEvent::Type_t::LineChanged, name, line, prevDiscount);
+    }
+    updateCoupons({}, true);
+    publishTotal();
+}
+
+float Order::getTaxableSubtotal(unsigned int category) const {
+    return (category < Item::kNumTaxCategories) ? mTaxableSubtotals[category] : 0;
+}
+
+float Order::getTax(const TaxTable& taxes) const {
+    return taxes.calcTax(mTaxableSubtotals);
+}
+
+std::size_t Order::getNumLines() const {
+    return mCart.size();
+}
+
+std::size_t Order::getReceipt(ReceiptLine* out, std::size_t capacity) const {
+    // Keep the first capacity lines by scan order in a max-heap so no scratch space is needed
+    auto later = [](const ReceiptLine& a, const ReceiptLine& b) { return a.sequence < b.sequence; };
+    std::size_t count = 0;
+    for (const auto& [name, line] : mCart) {
+        if (count < capacity || (capacity > 0 && line.sequence < out[0].sequence)) {
+            ReceiptLine receipt;
+            receipt.name = name;
+            receipt.unitPrice = line.unitPrice;
+            receipt.markdown = line.markdown;
+            receipt.special = line.special;
+            receipt.totalPrice = line.totalPrice;
+            receipt.sequence = line.sequence;
+            receipt.taxCategory = line.taxCategory;
+            receipt.saleType = std::holds_alternative<unsigned int>(line.amount) ? Item::Sale_t::Unit : Item::Sale_t::Weight;
+            receipt.amount = getLineAmount(line);
+            receipt.regularPrice = line.unitPrice * receipt.amount;
+            receipt.savings = receipt.regularPrice - receipt.totalPrice;
+
+            if (count < capacity) {
+                out[count] = receipt;
+                std::push_heap(out, out + count + 1, later);
+            } else {
+                std::pop_heap(out, out + capacity, later);
+                out[capacity - 1] = receipt;
+                std::push_heap(out, out + capacity, later);
+            }
+        }
+        ++count;
+    }
+    std::sort_heap(out, out + std::min(count, capacity), later);
+    return count;
+}
+
+bool Order::ScanItem(std::string_view name) noexcept {
+    return scanUnit(mItemCache.findEntry(name));
+}
+
+bool Order::ScanItem(std::string_view name, float weight) noexcept {
+    return scanWeight(mItemCache.findEntry(name), weight);
+}
+
+bool Order::ScanUnits(std::string_view name, unsigned int qty) noexcept {
+    return scanUnit(mItemCache.findEntry(name), qty);
+}
+
+bool Order::ScanBarcode(uint64_t gtin) noexcept {
+    return scanUnit(mItemCache.findEntryByGtin(gtin));
+}
+
+bool Order::ScanBarcode(uint64_t gtin, float weight) noexcept {
+    return scanWeight(mItemCache.findEntryByGtin(gtin), weight);
+}
+
+bool Order::OpenWeighing(std::string_view name, const WeightSession::Params& params) {
+    if (mWeighing) {
+        std::cerr << "Weighing session already open" << std::endl;
         return false;
     }
 
     // Item must be in database
-    auto item = mDatabase.getItem(name);
-    if (!item.has_value()) {
+    const Item* item = mItemCache.findItem(name);
+    if (!item) {
         std::cerr << "Item not in database" << std::endl;
         return false;
     }
@@ -60,22 +227,97 @@ bool Order::ScanItem(const std::string& name, float weight) {
         return false;
     }
 
-    // Find current total price of item and update weight
-    float prevPrice = 0;
-    if (mCart.find(name) != mCart.end()) {
-        prevPrice = getItemTotalPrice(item.value(), mCart[name]);
-        mCart[name] = std::get<float>(mCart[name]) + weight;
-    } else { // If item isnt already in cart then insert and set the weight
-        mCart[name] = weight;
+    // Price the weight against what the cart already holds of the item
+    float lineWeight = 0, linePrice = 0;
+    auto cart_it = mCart.find(name);
+    if (cart_it != mCart.end()) {
+        lineWeight = std::get<float>(cart_it->second.amount);
+        linePrice = cart_it->second.totalPrice;
     }
+    const SpecialParams special = item->getSpecial() ? item->getSpecial()->getParams() : SpecialParams{};
+    mWeighing.emplace(item->getName(), item->getPrice() - item->getMarkdown(), special, lineWeight, linePrice, params);
+    return true;
+}
 
-    // Update overall cart total with updated total price of item.
-    mTotalPrice += getItemTotalPrice(item.value(), mCart[name]) - prevPrice;
+WeightSession::State_t Order::AddWeightSample(float weight) {
+    if (!mWeighing) {
+        std::cerr << "No weighing session open" << std::endl;
+        return WeightSession::State_t::Empty;
+    }
+    return mWeighing->addSample(weight);
+}
+
+const WeightSession* Order::getWeighing() const {
+    return mWeighing ? &*mWeighing : nullptr;
+}
+
+bool Order::CommitWeighing() {
+    if (!mWeighing) {
+        std::cerr << "No weighing session open" << std::endl;
+        return false;
+    }
+
+    if (WeightSession::State_t::Stable != mWeighing->getState()) {
+        std::cerr << "Weight not stable" << std::endl;
+        return false;
+    }
+
+    const bool scanned = ScanItem(mWeighing->getName(), mWeighing->getWeight());
+    mWeighing.reset();
+    return scanned;
+}
+
+void Order::CancelWeighing() {
+    mWeighing.reset();
+}
+
+bool Order::VoidLastScan() noexcept {
+    if (mScans.empty()) {
+        std::cerr << "No scan to void" << std::endl;
+        return false;
+    }
+
+    // Grab item info from database
+    const ScanRecord& scan = mScans.back();
+    const Item* item = mItemCache.findItem(scan.name);
+    if (!item) {
+        std::cerr << "Item not in database" << std::endl; // shouldnt be possible
+        return false;
+    }
+
+    // Put the line back as it was, no repricing needed
+    auto cart_it = mCart.find(scan.name);
+    CartLine& line = cart_it->second;
+    const float prevDiscount = getSpecialDiscount(line);
+    const float prevPrice = scan.added ? 0 : scan.prevLine.totalPrice;
+    const float priceDelta = prevPrice - line.totalPrice;
+    const float amountDelta = (scan.added ? 0 : getLineAmount(scan.prevLine)) - getLineAmount(line);
+    const float regularDelta = (scan.added ? 0 : getLineRegularPrice(scan.prevLine)) - getLineRegularPrice(line);
+    mTotalPrice += priceDelta;
+    mRegularPrice += regularDelta;
+    mTaxableSubtotals[line.taxCategory] -= line.totalPrice;
+    recordSale(*item, amountDelta, priceDelta, regularDelta);
+    if (scan.added) {
+        publishLine(CartEvent::Type_t::LineRemoved, item->getName(), line, prevDiscount);
+        mCart.erase(cart_it);
+        --mNextSequence;
+    } else {
+        line = scan.prevLine;
+        mTaxableSubtotals[line.taxCategory] += line.totalPrice;
+        publishLine(CartEvent::Type_t::LineChanged, item->getName(), line, prevDiscount);
+    }
+    mScans.pop_back();
+    updateCoupons(item->getName());
+    publishTotal();
 
     return true;
 }
 
-bool Order::RemoveItem(const std::string& name, unsigned int qty) {
+std::size_t Order::getNumVoidableScans() const {
+    return mScans.size();
+}
+
+bool Order::RemoveItem(std::string_view name, unsigned int qty) noexcept {
     // Item must be in order
     auto cart_it = mCart.find(name);
     if (cart_it == mCart.end()) {
@@ -84,8 +326,9 @@ bool Order::RemoveItem(const std::string& name, unsigned int qty) {
     }
 
     // Grab item info from database
-    auto item = mDatabase.getItem(name);
-    if (!item.has_value()) {
+    const ItemCache::Entry& entry = mItemCache.findEntry(name);
+    const Item* item = entry.item;
+    if (!item) {
         std::cerr << "Item not in database" << std::endl; // shouldnt be possible
         return false;
     }
@@ -97,29 +340,40 @@ bool Order::RemoveItem(const std::string& name, unsigned int qty) {
     }
 
     // Quantity must be at least one
-    unsigned int curQty = std::get<unsigned int>(cart_it->second);
+    unsigned int curQty = std::get<unsigned int>(cart_it->second.amount);
     if (qty == 0) {
         std::cerr << "Removal quantity cannot be zero" << std::endl;
         return false;
     }
 
-    // Find current total price of item
-    float prevPrice = getItemTotalPrice(item.value(), cart_it->second);
-
     //  Update item quantity and overall cart total
+    mScans.clear();
+    const float prevDiscount = getSpecialDiscount(cart_it->second);
     if (qty >= curQty) {
         // Remove item fully from cart
+        publishLine(CartEvent::Type_t::LineRemoved, name, cart_it->second, prevDiscount);
+        recordSale(*item, -static_cast<float>(curQty), -cart_it->second.totalPrice, -getLineRegularPrice(cart_it->second));
+        mTotalPrice -= cart_it->second.totalPrice;
+        mTaxableSubtotals[cart_it->second.taxCategory] -= cart_it->second.totalPrice;
+        mRegularPrice -= getLineRegularPrice(cart_it->second);
         mCart.erase(cart_it);
-        mTotalPrice -= prevPrice;
     } else {
-        cart_it->second = (curQty - qty);
-        mTotalPrice += getItemTotalPrice(item.value(), cart_it->second) - prevPrice;
+        const float prevRegular = getLineRegularPrice(cart_it->second);
+        cart_it->second.amount = (curQty - qty);
+        const float priceDelta = updateLine(*item, entry.special, cart_it->second);
+        const float regularDelta = getLineRegularPrice(cart_it->second) - prevRegular;
+        mTotalPrice += priceDelta;
+        mRegularPrice += regularDelta;
+        recordSale(*item, -static_cast<float>(qty), priceDelta, regularDelta);
+        publishLine(CartEvent::Type_t::LineChanged, name, cart_it->second, prevDiscount);
     }
+    updateCoupons(name);
+    publishTotal();
 
     return true;
 }
 
-bool Order::RemoveItem(const std::string& name, float weight) {
+bool Order::RemoveItem(std::string_view name, float weight) noexcept {
     // Item must be in order
     auto cart_it = mCart.find(name);
     if (cart_it == mCart.end()) {
@@ -128,8 +382,9 @@ bool Order::RemoveItem(const std::string& name, float weight) {
     }
 
     // Grab item info from database
-    auto item = mDatabase.getItem(name);
-    if (!item.has_value()) {
+    const ItemCache::Entry& entry = mItemCache.findEntry(name);
+    const Item* item = entry.item;
+    if (!item) {
         std::cerr << "Item not in database" << std::endl; // shouldnt be possible
         return false;
     }
@@ -141,28 +396,208 @@ bool Order::RemoveItem(const std::string& name, float weight) {
     }
 
     // Quantity must be at least one and not greater than the current quantity in the cart
-    float curWeight = std::get<float>(cart_it->second);
+    float curWeight = std::get<float>(cart_it->second.amount);
     if (weight <= 0) {
         std::cerr << "Removal quantity must be greater than zero" << std::endl;
         return false;
     }
 
-    // Find current total price of item
-    float prevPrice = getItemTotalPrice(item.value(), cart_it->second);
-
     //  Update item weight and overall cart total
+    mScans.clear();
+    const float prevDiscount = getSpecialDiscount(cart_it->second);
     if (weight >= curWeight) {
         // Remove item fully from cart
+        publishLine(CartEvent::Type_t::LineRemoved, name, cart_it->second, prevDiscount);
+        recordSale(*item, -curWeight, -cart_it->second.totalPrice, -getLineRegularPrice(cart_it->second));
+        mTotalPrice -= cart_it->second.totalPrice;
+        mTaxableSubtotals[cart_it->second.taxCategory] -= cart_it->second.totalPrice;
+        mRegularPrice -= getLineRegularPrice(cart_it->second);
         mCart.erase(cart_it);
-        mTotalPrice -= prevPrice;
     } else {
-        cart_it->second = (curWeight - weight);
-        mTotalPrice += getItemTotalPrice(item.value(), cart_it->second) - prevPrice;
+        const float prevRegular = getLineRegularPrice(cart_it->second);
+        cart_it->second.amount = (curWeight - weight);
+        const float priceDelta = updateLine(*item, entry.special, cart_it->second);
+        const float regularDelta = getLineRegularPrice(cart_it->second) - prevRegular;
+        mTotalPrice += priceDelta;
+        mRegularPrice += regularDelta;
+        recordSale(*item, -weight, priceDelta, regularDelta);
+        publishLine(CartEvent::Type_t::LineChanged, name, cart_it->second, prevDiscount);
     }
+    updateCoupons(name);
+    publishTotal();
 
     return true;
 }
 
+float Order::getLineAmount(const CartLine& line) {
+    if (std::holds_alternative<unsigned int>(line.amount)) {
+        return static_cast<float>(std::get<unsigned int>(line.amount));
+    }
+    return std::get<float>(line.amount);
+}
+
+float Order::getLineRegularPrice(const CartLine& line) {
+    return line.unitPrice * getLineAmount(line);
+}
+
+float Order::calcCouponDiscount(std::size_t pos) const {
+    const Coupon& coupon = mCouponBook->getCoupon(pos);
+    if (coupon.loyalty && !mLoyaltyMember) {
+        return -1;
+    }
+
+    // Add up the qualifying lines, going through whichever of coupon items and cart is smaller
+    float amount = 0, price = 0;
+    if (Coupon::Scope_t::Order == coupon.scope) {
+        price = amount = mTotalPrice;
+    } else if (coupon.items.size() <= mCart.size()) {
+        for (const auto& name : coupon.items) {
+            auto cart_it = mCart.find(name);
+            if (cart_it != mCart.end()) {
+                amount += getLineAmount(cart_it->second);
+                price += cart_it->second.totalPrice;
+            }
+        }
+    } else {
+        for (const auto& [name, line] : mCart) {
+            if (mCouponBook->qualifies(pos, name)) {
+                amount += getLineAmount(line);
+                price += line.totalPrice;
+            }
+        }
+    }
+    if (amount <= 0 || amount < coupon.minAmount) {
+        return -1;
+    }
+
+    // A coupon never takes off more than the price of what it applies to
+    if (Coupon::Discount_t::Fixed == coupon.discount) {
+        return std::min(coupon.value, price);
+    }
+    return price * coupon.value / 100;
+}
+
+void Order::updateCoupons(std::string_view name, bool all) {
+    if (mRedemptions.empty()) {
+        return;
+    }
+
+    // Order coupons depend on every line, item and group coupons only on their own lines
+    mCouponDiscount = 0;
+    for (std::size_t i = 0; i < mRedemptions.size();) {
+        auto& redemption = mRedemptions[i];
+        const Coupon& coupon = mCouponBook->getCoupon(redemption.coupon);
+        if (all || coupon.loyalty || Coupon::Scope_t::Order == coupon.scope || mCouponBook->qualifies(redemption.coupon, name)) {
+            redemption.discount = calcCouponDiscount(redemption.coupon);
+        }
+        if (redemption.discount < 0) {
+            mRedemptions.erase(mRedemptions.begin() + i);
+            continue;
+        }
+        mCouponDiscount += redemption.discount;
+        ++i;
+    }
+
+    // Coupons on the same lines stack, but together they never take off more than the order costs
+    mCouponDiscount = std::min(mCouponDiscount, mTotalPrice);
+    if (mRedemptions.empty()) {
+        mCouponBook = nullptr;
+    }
+}
+
+float Order::getSpecialDiscount(const CartLine& line) {
+    return (line.unitPrice - line.markdown) * getLineAmount(line) - line.totalPrice;
+}
+
+void Order::publishLine(CartEvent::Type_t type, std::string_view name, const CartLine& line, float prevDiscount) {
+    if (!mEvents) {
+        return;
+    }
+
+    CartEvent event;
+    event.type = type;
+    event.sequence = line.sequence;
+    const std::size_t length = std::min(name.size(), CartEvent::kNameSize - 1);
+    std::memcpy(event.name, name.data(), length);
+    event.name[length] = '\0';
+    event.amount = getLineAmount(line);
+    event.price = line.totalPrice;
+    event.savings = getSpecialDiscount(line);
+    event.special = line.special;
+    mEvents->push(event);
+
+    // The discount is recomputed from a different amount, so allow half a cent of rounding
+    if (CartEvent::Type_t::LineRemoved != type && SpecialParams::Type_t::None != line.special.type &&
+        std::fabs(event.savings - prevDiscount) >= 0.005f) {
+        event.type = CartEvent::Type_t::SpecialApplied;
+        mEvents->push(event);
+    }
+}
+
+void Order::recordSale(const Item& item, float amount, float price, float regularPrice) {
+    if (mSales) {
+        mSales->record(item.getCatalogIndex(), amount, price, regularPrice - price);
+    }
+}
+
+void Order::publishTotal() {
+    if (!mEvents) {
+        return;
+    }
+
+    CartEvent event{};
+    event.type = CartEvent::Type_t::TotalChanged;
+    event.price = getTotalPrice();
+    event.savings = getSavings();
+    mEvents->push(event);
+}
+
+float Order::updateLine(const Item& item, CartLine& line) {
+    return updateLine(item, item.getSpecial() ? item.getSpecial()->getParams() : SpecialParams{}, line);
+}
+
+float Order::updateLine(const Item& item, const SpecialParams& special, CartLine& line) {
+    float prevPrice = line.totalPrice;
+    line.unitPrice = item.getPrice();
+    line.markdown = item.getMarkdown();
+    line.special = special;
+    line.totalPrice = getItemTotalPrice(item, special, line.amount);
+
+    // Move the line to the current tax category of the item
+    mTaxableSubtotals[line.taxCategory] -= prevPrice;
+    line.taxCategory = item.getTaxCategory();
+    mTaxableSubtotals[line.taxCategory] += line.totalPrice;
+    return line.totalPrice - prevPrice;
+}
+
+bool Order::reserveScan() noexcept {
+    if (mScans.size() < mScans.capacity()) {
+        return true;
+    }
+    try {
+        mScans.reserve(std::max<std::size_t>(16, 2 * mScans.capacity()));
+    } catch (const std::bad_alloc&) {
+        std::cerr << "Out of memory" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Order::insertLine(std::string_view name, const CartLine& line, Cart::iterator& cart_it) noexcept {
+    try {
+        cart_it = mCart.emplace(name, line).first;
+    } catch (const std::bad_alloc&) {
+        std::cerr << "Out of memory" << std::endl;
+        return false;
+    }
+    ++mNextSequence;
+    return true;
+}
+
+void Order::pushScan(Cart::iterator cart_it, bool added) noexcept {
+    mScans.push_back({cart_it->first, added, cart_it->second});
+}
+
 float Order::getItemTotalPrice(const Item& item, const std::variant<unsigned int, float>& amt) const {
     auto spec = item.getSpecial();
     float amount = (Item::Sale_t::Unit == item.getSaleType()) ? std::get<unsigned int>(amt) : std::get<float>(amt);
@@ -174,3 +609,118 @@ float Order::getItemTotalPrice(const Item& item, const std::variant<unsigned int
     }
 }
 
+float Order::getItemTotalPrice(const Item& item, const SpecialParams& special, const std::variant<unsigned int, float>& amt) const {
+    float amount = (Item::Sale_t::Unit == item.getSaleType()) ? std::get<unsigned int>(amt) : std::get<float>(amt);
+    // SpecialParams prices like the Special it was copied from, without the virtual call
+    if (SpecialParams::Type_t::None != special.type) {
+        return special.calcPrice(amount, item.getPrice() - item.getMarkdown());
+    } else {
+        return (item.getPrice() - item.getMarkdown()) * amount;
+    }
+}
+
+bool Order::scanUnit(const ItemCache::Entry& entry, unsigned int qty) noexcept {
+    const Item* item = entry.item;
+    // Quantity must be at least one
+    if (qty == 0) {
+        std::cerr << "Scan quantity cannot be zero" << std::endl;
+        return false;
+    }
+
+    // Item must be in database
+    if (!item) {
+        std::cerr << "Item not in database" << std::endl;
+        return false;
+    }
+
+    // Item must be sold by unit
+    if (Item::Sale_t::Unit != item->getSaleType()) {
+        std::cerr << "Item not sold by unit" << std::endl;
+        return false;
+    }
+
+    if (!reserveScan()) {
+        return false;
+    }
+
+    // Increment quantity
+    auto cart_it = mCart.find(item->getName());
+    const bool added = (cart_it == mCart.end());
+    float prevDiscount = 0, prevRegular = 0;
+    if (!added) {
+        pushScan(cart_it, added);
+        prevDiscount = getSpecialDiscount(cart_it->second);
+        prevRegular = getLineRegularPrice(cart_it->second);
+        std::get<unsigned int>(cart_it->second.amount) += qty;
+    } else { // If item isnt already in cart then insert and set the amount to qty
+        if (!insertLine(item->getName(), CartLine{qty, 0, 0, {}, 0, mNextSequence, 0}, cart_it)) {
+            return false;
+        }
+        pushScan(cart_it, added);
+    }
+
+    // Update overall cart total with updated total price of item.
+    const float priceDelta = updateLine(*item, entry.special, cart_it->second);
+    const float regularDelta = getLineRegularPrice(cart_it->second) - prevRegular;
+    mTotalPrice += priceDelta;
+    mRegularPrice += regularDelta;
+    recordSale(*item, static_cast<float>(qty), priceDelta, regularDelta);
+    updateCoupons(item->getName());
+    publishLine(added ? CartEvent::Type_t::LineAdded : CartEvent::Type_t::LineChanged, item->getName(), cart_it->second, prevDiscount);
+    publishTotal();
+
+    return true;
+}
+
+bool Order::scanWeight(const ItemCache::Entry& entry, float weight) noexcept {
+    const Item* item = entry.item;
+    // Weight must be positive and non zero
+    if (weight <= 0) {
+        std::cerr << "Weight must be positive and non-zero" << std::endl;
+        return false;
+    }
+
+    // Item must be in database
+    if (!item) {
+        std::cerr << "Item not in database" << std::endl;
+        return false;
+    }
+
+    // Item must be sold by weight
+    if (Item::Sale_t::Weight != item->getSaleType()) {
+        std::cerr << "Item not sold by weight" << std::endl;
+        return false;
+    }
+
+    if (!reserveScan()) {
+        return false;
+    }
+
+    // Update weight
+    auto cart_it = mCart.find(item->getName());
+    const bool added = (cart_it == mCart.end());
+    float prevDiscount = 0, prevRegular = 0;
+    if (!added) {
+        pushScan(cart_it, added);
+        prevDiscount = getSpecialDiscount(cart_it->second);
+        prevRegular = getLineRegularPrice(cart_it->second);
+        cart_it->second.amount = std::get<float>(cart_it->second.amount) + weight;
+    } else { // If item isnt already in cart then insert and set the weight
+        if (!insertLine(item->getName(), CartLine{weight, 0, 0, {}, 0, mNextSequence, 0}, cart_it)) {
+            return false;
+        }
+        pushScan(cart_it, added);
+    }
+
+    // Update overall cart total with updated total price of item.
+    const float priceDelta = updateLine(*item, entry.special, cart_it->second);
+    const float regularDelta = getLineRegularPrice(cart_it->second) - prevRegular;
+    mTotalPrice += priceDelta;
+    mRegularPrice += regularDelta;
+    recordSale(*item, weight, priceDelta, regularDelta);
+    updateCoupons(item->getName());
+    publishLine(added ? CartEvent::Type_t::LineAdded : CartEvent::Type_t::LineChanged, item->getName(), cart_it->second, prevDiscount);
+    publishTotal();
+
+    return true;
+}
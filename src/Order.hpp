@@ -1,50 +1,295 @@
 #ifndef __ORDER_HPP__
 #define __ORDER_HPP__
 
-#include "ItemDatabase.hpp"
+#include "CartEventQueue.hpp"
+#include "CouponBook.hpp"
+#include "ItemCache.hpp"
+#include "ItemCatalog.hpp"
+#include "SalesAggregator.hpp"
+#include "StringHash.hpp"
+#include "TaxTable.hpp"
+#include "WeightSession.hpp"
 
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <variant>
+#include <vector>
 
+// Order of a single customer. Once an order has held a basket, scanning and removing items
+// of a basket that size again does not allocate: cart nodes come from a pool owned by the order
+// and Reset keeps them for the next customer. Scans and removals are noexcept and report
+// running out of memory as a failed operation. An order owns the pool its cart lives in, so
+// it can be neither copied nor moved.
 class Order
 {
 public:
-    // Constructor. All items that can be added to the order must be in the ItemDatabase
-    explicit Order(const ItemDatabase& db);
+    // Itemized line of the order as printed on a receipt. Prices are the ones used when the
+    // line was last scanned or removed
+    struct ReceiptLine {
+        std::string_view name;  // Item name. Valid until the line is removed from the order
+        Item::Sale_t saleType;  // Sale type
+        float amount;           // Quantity or weight in the cart
+        float unitPrice;        // Regular price per unit or per pound
+        float markdown;         // Markdown per unit or per pound
+        SpecialParams special;  // Applied special. Type is None if there is none
+        float regularPrice;     // Price of the line at the regular price
+        float totalPrice;       // Price charged for the line
+        float savings;          // Amount saved on the line through markdown and special
+        uint64_t sequence;      // Lines with a lower sequence were scanned first
+        uint8_t taxCategory;    // Tax category of the item
+    };
+
+    // Constructor. All items that can be added to the order must be in the catalog
+    explicit Order(const ItemCatalog& catalog);
+
+    Order(const Order&) = delete;
+    Order& operator=(const Order&) = delete;
+
+    // Send changes of the order to queue, or stop sending them if queue is nullptr. Every
+    // change costs a few events independent of the size of the order. The queue must outlive
+    // the order or be detached first
+    void setEventQueue(CartEventQueue* queue);
+
+    // Record sales of the order into lane, or stop recording if lane is nullptr. Scans,
+    // removals and repricing all update the store-wide sales of the lane
+    void setSalesLane(SalesAggregator::Lane* lane);
+
+    // Empty the order for the next customer. Event queue, sales lane and the memory of the cart
+    // are kept, so a lane can serve customer after customer with one order without allocating
+    void Reset();
+
+    // Pre-size the order for numLines distinct items so the cart does not rehash and as many
+    // scans can be voided without reallocating
+    void reserve(std::size_t numLines);
+
+    // Return bytes used by the order, including cart nodes, their keys and scans that can be voided
+    std::size_t memoryBytes() const;
+
+    // Return cache of the items the order looked up
+    const ItemCache& getItemCache() const;
 
     // Return total price of the order
     float getTotalPrice() const;
 
+    // Return amount saved on the order through markdowns, specials and coupons compared to the
+    // regular price. getCouponDiscount is the part saved through coupons
+    float getSavings() const;
+
+    // Return discount given by redeemed coupons, at most the price of the order. Included in the
+    // total price
+    float getCouponDiscount() const;
+
+    // Set whether the customer is a loyalty member. Loyalty coupons are dropped when
+    // membership is removed
+    void setLoyaltyMember(bool member);
+
+    // Redeem the coupon with the given id from the book. Coupon must exist and not already be
+    // redeemed, all coupons of an order must come from the same book, loyalty coupons need a
+    // loyalty member and the cart must hold the minimum amount. Only the lines the coupon
+    // applies to are looked at. Redeemed coupons are checked again as their lines change and
+    // dropped once no longer met. Returns status of operation and updates total price when successful.
+    bool RedeemCoupon(const CouponBook& book, uint32_t id);
+
+    // Redeem count coupons by id. Returns the number of coupons redeemed
+    std::size_t RedeemCoupons(const CouponBook& book, const uint32_t* ids, std::size_t count);
+
+    // Reprice all lines at the current catalog pricing. If onlyIfLower is true only lines that
+    // get cheaper are repriced. Lines of items no longer in the catalog keep their price
+    void Reprice(bool onlyIfLower = false);
+
+    // Return price of the order items in a tax category or 0 for an invalid category
+    float getTaxableSubtotal(unsigned int category) const;
+
+    // Return tax on the order. Only the per category subtotals are used, so this does not
+    // depend on the number of items in the order
+    float getTax(const TaxTable& taxes) const;
+
+    // Return number of distinct items in the order
+    std::size_t getNumLines() const;
+
+    // Write up to capacity lines of the order into out, in the order items were first scanned.
+    // Nothing is allocated and nothing is repriced. Returns the number of lines in the order,
+    // which is more than written if capacity is too small
+    std::size_t getReceipt(ReceiptLine* out, std::size_t capacity) const;
+
     // Scans item by unit into cart. Item must exist in database and
     // be sold by unit.  Returns status of operation and updates total price when successful.
-    bool ScanItem(const std::string& name);
+    bool ScanItem(std::string_view name) noexcept;
 
     // Scans item by weight into cart. Item must exist in database and
     // be sold by weight. Weight must be > 0. Returns status of operation and updates total price when successful.
-    bool ScanItem(const std::string& name, float weight);
+    bool ScanItem(std::string_view name, float weight) noexcept;
+
+    // Scans qty units of an item in one step, priced the same as scanning them one by one.
+    // Qty must be at least one. Voiding the scan removes all qty units. Returns status of operation
+    bool ScanUnits(std::string_view name, unsigned int qty) noexcept;
+
+    // Scans item by unit using its GTIN barcode number. Same rules as scanning by name
+    bool ScanBarcode(uint64_t gtin) noexcept;
+
+    // Scans item by weight using its GTIN barcode number. Same rules as scanning by name
+    bool ScanBarcode(uint64_t gtin, float weight) noexcept;
+
+    // Open a weighing session for an item sold by weight. Only one session can be open at a
+    // time. The scale samples then go to AddWeightSample and the stable weight is scanned with
+    // CommitWeighing. Returns status of operation
+    bool OpenWeighing(std::string_view name, const WeightSession::Params& params = {});
+
+    // Add a scale sample to the open weighing session and return the state of the scale. Does
+    // not look up the item or change the order
+    WeightSession::State_t AddWeightSample(float weight);
+
+    // Return the open weighing session, with the weight and interim price to display, or
+    // nullptr if none is open
+    const WeightSession* getWeighing() const;
+
+    // Scan the stable weight of the open weighing session into cart and close the session. Fails
+    // if the weight is not stable yet. Returns status of operation and updates total price when successful.
+    bool CommitWeighing();
+
+    // Close the open weighing session without changing the order
+    void CancelWeighing();
+
+    // Undo the most recent scan still in the order, restoring its line exactly as it was before
+    // the scan, including the pricing it had then. Removals and repricing clear the scans that
+    // can be voided. Returns status of operation and updates total price when successful.
+    bool VoidLastScan() noexcept;
+
+    // Return number of scans that can be voided
+    std::size_t getNumVoidableScans() const;
 
     // Removes item from cart by quantity and updates order total. Item must exist in order and
     // be sold by unit, and quantity must be greater than 0. If quantity is greater than current total in cart the excess will be ignored and item removed.
     // Returns status of operation and updates total price when successful.
-    bool RemoveItem(const std::string& name, unsigned int qty);
+    bool RemoveItem(std::string_view name, unsigned int qty) noexcept;
 
     // Removes item from cart by weight and updates order total. Item must exist in order and
     // be sold by weight, and weight must greater than 0. If weight is greater than current total in cart the excess will be ignored and item removed.
     // Returns status of operation and updates total price when successful.
-    bool RemoveItem(const std::string& name, float weight);
+    bool RemoveItem(std::string_view name, float weight) noexcept;
 
 private:
+    // Item in the cart with the pricing computed when it was last changed
+    struct CartLine {
+        std::variant<unsigned int, float> amount;   // Total quantity or weight
+        float unitPrice;        // Regular price per unit or per pound
+        float markdown;         // Markdown per unit or per pound
+        SpecialParams special;  // Special applied to the line
+        float totalPrice;       // Price charged for the line
+        uint64_t sequence;      // Scan order of the first unit
+        uint8_t taxCategory;    // Tax category the line price is counted in
+    };
+
+    // Lines of the cart by item name
+    using Cart = std::pmr::unordered_map<std::pmr::string, CartLine, StringHash, StringEqual>;
+
+    // Coupon applied to the order
+    struct Redemption {
+        uint32_t coupon;    // Position of coupon in the coupon book
+        float discount;     // Current discount of the coupon
+    };
+
+    // Scan that can be voided, with the line as it was before the scan
+    struct ScanRecord {
+        std::string_view name;  // Key of the line in the cart
+        bool added;             // Scan added the line to the cart
+        CartLine prevLine;      // Line before the scan. Unused if added
+    };
+
+    // Returns quantity or weight of a line
+    static float getLineAmount(const CartLine& line);
+
+    // Returns price of a line at its regular unit price, as shown on the receipt
+    static float getLineRegularPrice(const CartLine& line);
+
+    // Returns discount of the coupon at position pos of the coupon book for the current cart, or
+    // a negative value if the cart does not meet the coupon
+    float calcCouponDiscount(std::size_t pos) const;
+
+    // Check redeemed coupons affected by a change of the line of an item again, or all
+    // redeemed coupons if all is true
+    void updateCoupons(std::string_view name, bool all = false);
+
+    // Returns discount of the special on a line
+    static float getSpecialDiscount(const CartLine& line);
+
+    // Send a line event and a SpecialApplied event if the special discount of the line
+    // changed from prevDiscount. Does nothing without an event queue
+    void publishLine(CartEvent::Type_t type, std::string_view name, const CartLine& line, float prevDiscount);
+
+    // Record a change of the sales of item into the sales lane. Does nothing without a sales lane
+    void recordSale(const Item& item, float amount, float price, float regularPrice);
+
+    // Send the order total. Does nothing without an event queue
+    void publishTotal();
+
+    // Reprice a line at the current item pricing and return the change of the line price.
+    // Keeps the taxable subtotals up to date
+    float updateLine(const Item& item, CartLine& line);
+
+    // Reprice a line with special, the current special of item, e.g. as cached by mItemCache
+    float updateLine(const Item& item, const SpecialParams& special, CartLine& line);
+
+    // Add qty units of the item of entry to the cart. Fails if the item is null or not sold by unit
+    bool scanUnit(const ItemCache::Entry& entry, unsigned int qty = 1) noexcept;
+
+    // Add weight of the item of entry to the cart. Fails if the item is null or not sold by weight
+    bool scanWeight(const ItemCache::Entry& entry, float weight) noexcept;
+
+    // Make room for one more scan that can be voided. Returns false if out of memory
+    bool reserveScan() noexcept;
+
+    // Add line for an item not in the cart yet and point cart_it at it. Returns false if out of memory
+    bool insertLine(std::string_view name, const CartLine& line, Cart::iterator& cart_it) noexcept;
+
+    // Remember a scan of the line at cart_it so it can be voided. Must be called before the
+    // line is changed and after reserveScan
+    void pushScan(Cart::iterator cart_it, bool added) noexcept;
+
     // Get the total price of the item based on amount and account for specials
     float getItemTotalPrice(const Item& item, const std::variant<unsigned int, float>& amt) const;
 
+    // Get the total price of the item with special, the current special of item
+    float getItemTotalPrice(const Item& item, const SpecialParams& special, const std::variant<unsigned int, float>& amt) const;
+
 private:
-    // Database of available items
-    const ItemDatabase& mDatabase;
+    // Catalog of available items
+    const ItemCatalog& mCatalog;
+    // Recently scanned items of the catalog. Lookups of scans and removals go through it
+    ItemCache mItemCache;
     // Price of order
     float mTotalPrice;
-    // Items that have been scanned into the cart and the corresponding total quantity or weight per item
-    std::unordered_map<std::string, std::variant<unsigned int, float>> mCart;
+    // Price of order at regular item prices without markdowns or specials
+    float mRegularPrice;
+    // Discount of all redeemed coupons
+    float mCouponDiscount;
+    // Coupon book of redeemed coupons or nullptr if none are redeemed
+    const CouponBook* mCouponBook;
+    // Coupons redeemed against the order
+    std::vector<Redemption> mRedemptions;
+    // Customer is a loyalty member
+    bool mLoyaltyMember;
+    // Price of order per tax category
+    float mTaxableSubtotals[Item::kNumTaxCategories];
+    // Sequence number of the next new cart line
+    uint64_t mNextSequence;
+    // Queue receiving changes of the order or nullptr
+    CartEventQueue* mEvents;
+    // Lane recording the sales of the order or nullptr
+    SalesAggregator::Lane* mSales;
+    // Open weighing session
+    std::optional<WeightSession> mWeighing;
+    // Scans that can be voided, most recent last
+    std::vector<ScanRecord> mScans;
+    // Pool the cart nodes and keys are allocated from. Kept by Reset
+    std::pmr::unsynchronized_pool_resource mCartMemory;
+    // Items that have been scanned into the cart and the corresponding line per item
+    Cart mCart;
 };
 
 #endif
\ No newline at end of file
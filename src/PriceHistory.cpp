@@ -0,0 +1,205 @@
+#include "PriceHistory.hpp"
+#include "MemoryUsage.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <iostream>
+#include <memory>
+
+PriceHistory::PriceHistory() :
+    mTimelines{}, mGtinClaims{}, mLatest(INT64_MIN)
+{}
+
+bool PriceHistory::record(const ItemDatabase& db, int64_t time) {
+    if (time < mLatest) {
+        std::cerr << "Price history cannot be recorded back in time" << std::endl;
+        return false;
+    }
+
+    for (const auto& item : db.getItems()) {
+        append(item, time);
+    }
+    mLatest = time;
+    return true;
+}
+
+bool PriceHistory::record(const Item& item, int64_t time) {
+    if (!append(item, time)) {
+        return false;
+    }
+    mLatest = std::max(mLatest, time);
+    return true;
+}
+
+bool PriceHistory::findAsOf(std::string_view name, int64_t time, State& out) const {
+    auto it = mTimelines.find(name);
+    if (it == mTimelines.end()) {
+        return false;
+    }
+    const long version = versionAt(it->second, time);
+    if (version < 0) {
+        return false;
+    }
+    out = it->second.states[version];
+    return true;
+}
+
+std::optional<Item> PriceHistory::getItemAsOf(std::string_view name, int64_t time) const {
+    auto it = mTimelines.find(name);
+    if (it == mTimelines.end()) {
+        return std::nullopt;
+    }
+    const long version = versionAt(it->second, time);
+    if (version < 0) {
+        return std::nullopt;
+    }
+    return makeItem(it->first, it->second, it->second.states[version]);
+}
+
+std::optional<Item> PriceHistory::getItemAsOfGtin(uint64_t gtin, int64_t time) const {
+    auto it = mGtinClaims.find(gtin);
+    if (it == mGtinClaims.end()) {
+        return std::nullopt;
+    }
+
+    // The latest claim by time normally holds the GTIN. An item that gave it up since has a
+    // version without it, and earlier claimants are checked in case claims tie on time
+    const auto& claims = it->second;
+    auto claim_it = std::upper_bound(claims.begin(), claims.end(), time,
+                                     [](int64_t t, const GtinClaim& claim) { return t < claim.start; });
+    while (claim_it != claims.begin()) {
+        --claim_it;
+        const Timeline& timeline = mTimelines.find(claim_it->name)->second;
+        const long version = versionAt(timeline, time);
+        if (version >= 0 && timeline.states[version].gtin == gtin) {
+            return makeItem(claim_it->name, timeline, timeline.states[version]);
+        }
+    }
+    return std::nullopt;
+}
+
+std::size_t PriceHistory::getNumVersions(std::string_view name) const {
+    auto it = mTimelines.find(name);
+    return (it == mTimelines.end()) ? 0 : it->second.states.size();
+}
+
+std::size_t PriceHistory::getNumItems() const {
+    return mTimelines.size();
+}
+
+int64_t PriceHistory::getLatestTime() const {
+    return mLatest;
+}
+
+std::size_t PriceHistory::memoryBytes() const {
+    std::size_t bytes = sizeof(*this) + hashTableBytes(mTimelines) + hashTableBytes(mGtinClaims);
+    for (const auto& [name, timeline] : mTimelines) {
+        bytes += stringHeapBytes(name) + timeline.starts.capacity() * sizeof(int64_t) +
+                 timeline.states.capacity() * sizeof(State);
+    }
+    for (const auto& entry : mGtinClaims) {
+        bytes += entry.second.capacity() * sizeof(GtinClaim);
+        for (const auto& claim : entry.second) {
+            bytes += stringHeapBytes(claim.name);
+        }
+    }
+    return bytes;
+}
+
+PriceHistory::State PriceHistory::stateOf(const Item& item) {
+    State state{item.getPrice(), item.getMarkdown(), {}, item.getTaxCategory(), item.getGtin()};
+    if (item.getSpecial()) {
+        state.special = item.getSpecial()->getParams();
+    }
+    return state;
+}
+
+bool PriceHistory::sameState(const State& a, const State& b) {
+    return a.price == b.price && a.markdown == b.markdown && a.taxCategory == b.taxCategory &&
+           a.special.type == b.special.type && a.special.needed == b.special.needed &&
+           a.special.receive == b.special.receive && a.special.value == b.special.value &&
+           a.special.limit == b.special.limit && a.gtin == b.gtin;
+}
+
+bool PriceHistory::append(const Item& item, int64_t time) {
+    auto it = mTimelines.find(item.getName());
+    if (it == mTimelines.end()) {
+        it = mTimelines.emplace(item.getName(), Timeline{item.getSaleType(), {}, {}}).first;
+    }
+    Timeline& timeline = it->second;
+    if (!timeline.starts.empty() && time < timeline.starts.back()) {
+        std::cerr << "Price history cannot be recorded back in time" << std::endl;
+        return false;
+    }
+
+    // Only changes take space. A change at the same time as the last version replaces it
+    const State state = stateOf(item);
+    if (!timeline.states.empty() && sameState(timeline.states.back(), state)) {
+        return true;
+    }
+    if (!timeline.starts.empty() && timeline.starts.back() == time) {
+        // A GTIN taken by the replaced version is claimed by the new one instead
+        const uint64_t before = (timeline.states.size() > 1) ? timeline.states.end()[-2].gtin : 0;
+        if (timeline.states.back().gtin != state.gtin) {
+            if (timeline.states.back().gtin != 0 && timeline.states.back().gtin != before) {
+                unclaimGtin(timeline.states.back().gtin, it->first, time);
+            }
+            if (state.gtin != 0 && state.gtin != before) {
+                claimGtin(state.gtin, it->first, time);
+            }
+        }
+        timeline.states.back() = state;
+        if (timeline.states.size() > 1 && sameState(timeline.states.end()[-2], state)) {
+            timeline.starts.pop_back();
+            timeline.states.pop_back();
+        }
+    } else {
+        if (state.gtin != 0 && (timeline.states.empty() || timeline.states.back().gtin != state.gtin)) {
+            claimGtin(state.gtin, it->first, time);
+        }
+        timeline.starts.push_back(time);
+        timeline.states.push_back(state);
+    }
+    return true;
+}
+
+void PriceHistory::claimGtin(uint64_t gtin, const std::string& name, int64_t time) {
+    // Items are recorded in any order at the same time, so claims are kept sorted on insert
+    auto& claims = mGtinClaims[gtin];
+    auto pos = std::upper_bound(claims.begin(), claims.end(), time,
+                                [](int64_t t, const GtinClaim& claim) { return t < claim.start; });
+    claims.insert(pos, GtinClaim{time, name});
+}
+
+void PriceHistory::unclaimGtin(uint64_t gtin, const std::string& name, int64_t time) {
+    auto it = mGtinClaims.find(gtin);
+    if (it == mGtinClaims.end()) {
+        return;
+    }
+    auto& claims = it->second;
+    auto claim_it = std::find_if(claims.begin(), claims.end(), [&](const GtinClaim& claim) {
+        return claim.start == time && claim.name == name;
+    });
+    if (claim_it != claims.end()) {
+        claims.erase(claim_it);
+    }
+    if (claims.empty()) {
+        mGtinClaims.erase(it);
+    }
+}
+
+long PriceHistory::versionAt(const Timeline& timeline, int64_t time) {
+    auto it = std::upper_bound(timeline.starts.begin(), timeline.starts.end(), time);
+    return static_cast<long>(it - timeline.starts.begin()) - 1;
+}
+
+Item PriceHistory::makeItem(const std::string& name, const Timeline& timeline, const State& state) {
+    Item item(name, timeline.saleType, state.price);
+    item.setMarkdown(state.markdown);
+    item.setGtin(state.gtin);
+    item.setTaxCategory(state.taxCategory);
+    if (SpecialParams::Type_t::None != state.special.type) {
+        item.setSpecial(std::make_shared<ParamsSpecial>(state.special));
+    }
+    return item;
+}
@@ -0,0 +1,108 @@
+#ifndef __PRICEHISTORY_HPP__
+#define __PRICEHISTORY_HPP__
+
+#include "ItemDatabase.hpp"
+#include "Special.hpp"
+#include "StringHash.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Timeline of the pricing of every item, for answering what an item cost at a point in the
+// past. Each item keeps a run-length timeline: a new version is only stored when the price,
+// markdown, special, tax category or GTIN differ from the version before, so recording a catalog
+// that did not change costs no storage. Version start times are kept in their own sorted
+// array, so an as-of query is a binary search over the versions of one item.
+//
+// Times are seconds since the epoch in the store's local time, like SpecialScheduler.
+class PriceHistory {
+public:
+    // Pricing of an item from a point in time until the next version
+    struct State {
+        float price;            // Price in dollars per unit or per pound
+        float markdown;         // Amount in dollars to lower price
+        SpecialParams special;  // Special if type is not None
+        uint8_t taxCategory;    // Tax category
+        uint64_t gtin;          // GTIN. 0 = none
+    };
+
+    // Default constructor. Creates an empty history
+    PriceHistory();
+
+    // Record the pricing of all items of the database at time. Times must not go back.
+    // Returns status of operation
+    bool record(const ItemDatabase& db, int64_t time);
+
+    // Record the pricing of one item at time, e.g. right after changing it. Times of an item
+    // must not go back. Returns status of operation
+    bool record(const Item& item, int64_t time);
+
+    // Copy pricing of an item in effect at time into out. Returns false if the item was not
+    // recorded by then
+    bool findAsOf(std::string_view name, int64_t time, State& out) const;
+
+    // Returns item as it was priced at time or nothing if it was not recorded by then
+    std::optional<Item> getItemAsOf(std::string_view name, int64_t time) const;
+
+    // Returns item that had a GTIN at time, as it was priced then, or nothing if no item had it
+    std::optional<Item> getItemAsOfGtin(uint64_t gtin, int64_t time) const;
+
+    // Return number of versions stored for an item
+    std::size_t getNumVersions(std::string_view name) const;
+
+    // Return number of items with a timeline
+    std::size_t getNumItems() const;
+
+    // Return time of the latest record or INT64_MIN if nothing was recorded
+    int64_t getLatestTime() const;
+
+    // Return bytes used by the history
+    std::size_t memoryBytes() const;
+
+private:
+    // Versions of one item. starts[i] is when states[i] took effect, starts is ascending
+    struct Timeline {
+        Item::Sale_t saleType;          // Sale type, fixed for an item
+        std::vector<int64_t> starts;    // Start time of each version
+        std::vector<State> states;      // Pricing of each version
+    };
+
+    // An item taking a GTIN from start on
+    struct GtinClaim {
+        int64_t start;      // Time the item took the GTIN
+        std::string name;   // Item name
+    };
+
+    // Returns pricing of an item
+    static State stateOf(const Item& item);
+
+    // Returns true if two states price identically
+    static bool sameState(const State& a, const State& b);
+
+    // Append state to the timeline of item if it changed. Returns status of operation
+    bool append(const Item& item, int64_t time);
+
+    // Record that item name took gtin at time
+    void claimGtin(uint64_t gtin, const std::string& name, int64_t time);
+
+    // Drop a claim of gtin by item name at time, when the version that made it is replaced
+    void unclaimGtin(uint64_t gtin, const std::string& name, int64_t time);
+
+    // Returns index of the version of timeline in effect at time or -1 if none
+    static long versionAt(const Timeline& timeline, int64_t time);
+
+    // Returns item built from a timeline and one of its states
+    static Item makeItem(const std::string& name, const Timeline& timeline, const State& state);
+
+private:
+    std::unordered_map<std::string, Timeline, StringHash, std::equal_to<>> mTimelines; // Timelines by item name
+    std::unordered_map<uint64_t, std::vector<GtinClaim>> mGtinClaims;   // Items that took each GTIN, by start
+    int64_t mLatest;                                                     // Time of the latest record
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef __PRICINGPROTOCOL_HPP__
+#define __PRICINGPROTOCOL_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Binary protocol spoken between lane clients and the pricing service over a UNIX domain
+// socket. All fields are in host byte order since both ends run on the same machine.
+// A client may send any number of requests without waiting for responses (pipelining).
+// Responses are always sent in request order.
+namespace PricingProtocol {
+
+// Request operation codes
+enum class Op_t : uint8_t {
+    Open = 1,         // Open a new order session
+    ScanUnit = 2,     // Scan one unit of an item
+    ScanWeight = 3,   // Scan an item by weight
+    RemoveUnit = 4,   // Remove a quantity of an item
+    RemoveWeight = 5, // Remove a weight of an item
+    Total = 6,        // Query order total
+    Close = 7,        // Close the order session
+};
+
+// Response status codes
+enum class Status_t : uint8_t {
+    Ok = 0,
+    Failed = 1,         // Operation rejected by the order (unknown item, wrong sale type, etc)
+    UnknownSession = 2, // Session was never opened or has been closed
+    BadRequest = 3,     // Unknown op code
+};
+
+// Fixed size request header, followed by nameLen bytes of item name
+struct RequestHeader {
+    Op_t op;
+    uint8_t reserved;
+    uint16_t nameLen;
+    uint32_t session;
+    uint32_t qty;   // Quantity for unit operations
+    float weight;   // Weight for weight operations
+};
+static_assert(sizeof(RequestHeader) == 16, "Unexpected request header padding");
+
+// Fixed size response
+struct Response {
+    Status_t status;
+    Op_t op;
+    uint16_t reserved;
+    uint32_t session;
+    float total;    // Order total after the operation
+    float savings;  // Order savings after the operation
+};
+static_assert(sizeof(Response) == 16, "Unexpected response padding");
+
+// Append an encoded request to buf
+inline void encodeRequest(std::string& buf, Op_t op, uint32_t session, const std::string& name = "",
+                          uint32_t qty = 0, float weight = 0) {
+    RequestHeader hdr{op, 0, static_cast<uint16_t>(name.size()), session, qty, weight};
+    buf.append(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+    buf.append(name, 0, hdr.nameLen);
+}
+
+// Decode the response at index idx of buf. Buffer must hold at least idx + 1 responses
+inline Response decodeResponse(const std::string& buf, std::size_t idx) {
+    Response rsp;
+    std::memcpy(&rsp, buf.data() + idx * sizeof(Response), sizeof(Response));
+    return rsp;
+}
+
+}
+
+#endif
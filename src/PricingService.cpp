@@ -0,0 +1,245 @@
+#include "PricingService.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace PricingProtocol;
+
+namespace {
+// Buffered state of a single client connection
+struct Connection {
+    std::string in;          // Received bytes not yet forming a complete request
+    std::string out;         // Encoded responses not yet written
+    bool readClosed = false; // Client shut down writing. Closed once out is written
+};
+
+// Put a file descriptor in non-blocking mode. Returns status of operation
+bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// Write as much pending output as the socket accepts. Returns false if the connection failed
+bool flushOutput(int fd, Connection& conn) {
+    std::size_t sent = 0;
+    while (sent < conn.out.size()) {
+        ssize_t n = send(fd, conn.out.data() + sent, conn.out.size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            return false;
+        }
+        sent += static_cast<std::size_t>(n);
+    }
+    conn.out.erase(0, sent);
+    return true;
+}
+}
+
+PricingService::PricingService(const ItemDatabase& db) :
+    mDatabase(db), mSessions{}, mRunning(false)
+{}
+
+void PricingService::closeClient(int client) {
+    mSessions.erase(client);
+}
+
+std::size_t PricingService::getNumSessions() const {
+    std::size_t numSessions = 0;
+    for (const auto& client : mSessions) {
+        numSessions += client.second.size();
+    }
+    return numSessions;
+}
+
+void PricingService::stop() {
+    mRunning = false;
+}
+
+std::size_t PricingService::handleRequests(int client, const char* data, std::size_t len, std::string& out) {
+    std::size_t pos = 0;
+    while (len - pos >= sizeof(RequestHeader)) {
+        RequestHeader hdr;
+        std::memcpy(&hdr, data + pos, sizeof(hdr));
+        if (len - pos - sizeof(hdr) < hdr.nameLen) {
+            break; // Wait for the rest of the request
+        }
+
+        Response rsp = handleRequest(client, hdr, std::string_view(data + pos + sizeof(hdr), hdr.nameLen));
+        out.append(reinterpret_cast<const char*>(&rsp), sizeof(rsp));
+        pos += sizeof(hdr) + hdr.nameLen;
+    }
+    return pos;
+}
+
+Response PricingService::handleRequest(int client, const RequestHeader& hdr, std::string_view name) {
+    Response rsp{Status_t::Ok, hdr.op, 0, hdr.session, 0, 0};
+
+    Sessions& sessions = mSessions[client];
+    if (Op_t::Open == hdr.op) {
+        if (!sessions.try_emplace(hdr.session, mDatabase).second) {
+            rsp.status = Status_t::Failed; // Session already open
+        }
+        return rsp;
+    }
+
+    auto session = sessions.find(hdr.session);
+    if (session == sessions.end()) {
+        rsp.status = Status_t::UnknownSession;
+        return rsp;
+    }
+
+    Order& order = session->second;
+    bool ok = true;
+    switch (hdr.op) {
+        case Op_t::ScanUnit:     ok = order.ScanItem(name); break;
+        case Op_t::ScanWeight:   ok = order.ScanItem(name, hdr.weight); break;
+        case Op_t::RemoveUnit:   ok = order.RemoveItem(name, hdr.qty); break;
+        case Op_t::RemoveWeight: ok = order.RemoveItem(name, hdr.weight); break;
+        case Op_t::Total:        break;
+        case Op_t::Close:
+            rsp.total = order.getTotalPrice();
+            rsp.savings = order.getSavings();
+            sessions.erase(session);
+            return rsp;
+        default:
+            rsp.status = Status_t::BadRequest;
+            return rsp;
+    }
+
+    rsp.status = ok ? Status_t::Ok : Status_t::Failed;
+    rsp.total = order.getTotalPrice();
+    rsp.savings = order.getSavings();
+    return rsp;
+}
+
+bool PricingService::run(const std::string& socketPath) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Socket path too long" << std::endl;
+        return false;
+    }
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+    int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        std::cerr << "Unable to create socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    unlink(socketPath.c_str());
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(listenFd, SOMAXCONN) < 0 || !setNonBlocking(listenFd)) {
+        std::cerr << "Unable to listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+        close(listenFd);
+        return false;
+    }
+
+    int epollFd = epoll_create1(0);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = listenFd;
+    if (epollFd < 0 || epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev) < 0) {
+        std::cerr << "Unable to set up epoll: " << std::strerror(errno) << std::endl;
+        if (epollFd >= 0) {
+            close(epollFd);
+        }
+        close(listenFd);
+        return false;
+    }
+
+    std::unordered_map<int, Connection> conns;
+    auto closeConn = [&](int fd) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        conns.erase(fd);
+        closeClient(fd);
+    };
+
+    constexpr int kMaxEvents = 64;
+    epoll_event events[kMaxEvents];
+    char buf[64 * 1024];
+
+    mRunning = true;
+    while (mRunning) {
+        int numEvents = epoll_wait(epollFd, events, kMaxEvents, 100);
+        for (int i = 0; i < numEvents; ++i) {
+            int fd = events[i].data.fd;
+
+            if (fd == listenFd) {
+                // Accept all pending clients
+                int clientFd;
+                while ((clientFd = accept(listenFd, nullptr, nullptr)) >= 0) {
+                    setNonBlocking(clientFd);
+                    epoll_event cev{};
+                    cev.events = EPOLLIN;
+                    cev.data.fd = clientFd;
+                    epoll_ctl(epollFd, EPOLL_CTL_ADD, clientFd, &cev);
+                    conns[clientFd];
+                }
+                continue;
+            }
+
+            auto conn_it = conns.find(fd);
+            if (conn_it == conns.end()) {
+                continue;
+            }
+            Connection& conn = conn_it->second;
+
+            if (!conn.readClosed && (events[i].events & EPOLLIN)) {
+                // Process every complete request of each read in one batch. Reading stops while
+                // the client has too many responses pending, so it cannot grow them without limit
+                bool failed = false;
+                while (conn.out.size() < kMaxPendingOutput) {
+                    ssize_t n = recv(fd, buf, sizeof(buf), 0);
+                    if (n > 0) {
+                        conn.in.append(buf, static_cast<std::size_t>(n));
+                        conn.in.erase(0, handleRequests(fd, conn.in.data(), conn.in.size(), conn.out));
+                    } else {
+                        // A client that shut down writing still gets all its responses
+                        conn.readClosed = (n == 0);
+                        failed = (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK);
+                        break;
+                    }
+                }
+                if (failed) {
+                    closeConn(fd);
+                    continue;
+                }
+            } else if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                closeConn(fd);
+                continue;
+            }
+
+            // Write responses, waiting for the socket to drain if the client is slow to read
+            if (!flushOutput(fd, conn) || (conn.readClosed && conn.out.empty())) {
+                closeConn(fd);
+                continue;
+            }
+            epoll_event cev{};
+            if (conn.readClosed || conn.out.size() >= kMaxPendingOutput) {
+                cev.events = EPOLLOUT;
+            } else {
+                cev.events = conn.out.empty() ? EPOLLIN : (EPOLLIN | EPOLLOUT);
+            }
+            cev.data.fd = fd;
+            epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &cev);
+        }
+    }
+
+    for (auto& conn : conns) {
+        close(conn.first);
+    }
+    close(epollFd);
+    close(listenFd);
+    unlink(socketPath.c_str());
+    return true;
+}
@@ -0,0 +1,57 @@
+#ifndef __PRICINGSERVICE_HPP__
+#define __PRICINGSERVICE_HPP__
+
+#include "ItemDatabase.hpp"
+#include "Order.hpp"
+#include "PricingProtocol.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Pricing service hosting one item database and many order sessions. Lane clients connect
+// over a UNIX domain socket and send batched requests using PricingProtocol.
+class PricingService {
+public:
+    // Constructor. Database must outlive the service
+    explicit PricingService(const ItemDatabase& db);
+
+    // Most bytes of responses buffered for a client before the service stops reading its
+    // requests until the client catches up
+    static constexpr std::size_t kMaxPendingOutput = 1 << 20;
+
+    // Process all complete requests of a client in data and append their responses to out.
+    // Incomplete trailing requests are left unprocessed. Returns number of bytes consumed
+    std::size_t handleRequests(int client, const char* data, std::size_t len, std::string& out);
+
+    // Drop all sessions opened by a client, e.g. when it disconnects
+    void closeClient(int client);
+
+    // Return number of open order sessions of all clients
+    std::size_t getNumSessions() const;
+
+    // Listen on socketPath and serve clients with an epoll event loop until stop() is called.
+    // Returns false if the socket could not be set up
+    bool run(const std::string& socketPath);
+
+    // Request the event loop to exit. Safe to call from another thread or a signal handler
+    void stop();
+
+private:
+    // Process a single request and return its response
+    PricingProtocol::Response handleRequest(int client, const PricingProtocol::RequestHeader& hdr, std::string_view name);
+
+private:
+    // Open orders of one client by session id. Session ids are chosen by the client, so each
+    // client has its own and cannot reach orders of other clients
+    using Sessions = std::unordered_map<uint32_t, Order>;
+
+    const ItemDatabase& mDatabase;                  // Database of available items
+    std::unordered_map<int, Sessions> mSessions;    // Open orders by client
+    std::atomic<bool> mRunning;                   // Event loop keeps running while set
+};
+
+#endif
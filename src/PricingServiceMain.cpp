@@ -0,0 +1,35 @@
+#include "CatalogFile.hpp"
+#include "ItemDatabase.hpp"
+#include "PricingService.hpp"
+
+#include <csignal>
+#include <iostream>
+
+namespace {
+PricingService* gService = nullptr; // Service to stop on SIGINT/SIGTERM
+
+void handleSignal(int) {
+    if (gService) {
+        gService->stop();
+    }
+}
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <catalog-file> <socket-path>" << std::endl;
+        return 1;
+    }
+
+    ItemDatabase db;
+    if (!loadCatalogFile(argv[1], db)) {
+        return 1;
+    }
+
+    PricingService service(db);
+    gService = &service;
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+
+    return service.run(argv[2]) ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+#include "PromotionSimulator.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <iostream>
+
+PromotionSimulator::PromotionSimulator(const ItemDatabase& db) :
+    mDatabase(db), mNumBaskets(0), mCounts{}, mItemStart{}, mAmounts{}, mBasketCounts{}, mScratch{}
+{}
+
+std::size_t PromotionSimulator::addBaskets(const Basket* baskets, std::size_t count) {
+    std::size_t skipped = 0;
+    for (std::size_t b = 0; b < count; ++b) {
+        // Combine lines of the same item, baskets are small enough for a linear search
+        mScratch.clear();
+        for (const auto& line : baskets[b]) {
+            const Item* item = mDatabase.findItem(line.name);
+            const bool byUnit = std::holds_alternative<unsigned int>(line.amount);
+            if (!item || byUnit != (Item::Sale_t::Unit == item->getSaleType())) {
+                ++skipped;
+                continue;
+            }
+            const float amount = byUnit ? static_cast<float>(std::get<unsigned int>(line.amount)) : std::get<float>(line.amount);
+            if (amount <= 0) {
+                ++skipped;
+                continue;
+            }
+
+            const uint32_t index = static_cast<uint32_t>(item->getCatalogIndex());
+            auto it = std::find_if(mScratch.begin(), mScratch.end(), [index](const Entry& e) { return e.item == index; });
+            if (it == mScratch.end()) {
+                mScratch.push_back({index, amount});
+            } else {
+                it->amount += amount;
+            }
+        }
+
+        for (const auto& entry : mScratch) {
+            ++mCounts[(static_cast<uint64_t>(entry.item) << 32) | std::bit_cast<uint32_t>(entry.amount)];
+        }
+        ++mNumBaskets;
+    }
+    return skipped;
+}
+
+std::size_t PromotionSimulator::addBaskets(const std::vector<Basket>& baskets) {
+    return addBaskets(baskets.data(), baskets.size());
+}
+
+void PromotionSimulator::build() {
+    // Amounts are positive, so their bits sort like the amounts themselves
+    std::vector<std::pair<uint64_t, uint64_t>> entries(mCounts.begin(), mCounts.end());
+    std::sort(entries.begin(), entries.end());
+
+    const std::size_t numItems = mDatabase.getItems().size();
+    mItemStart.assign(numItems + 1, 0);
+    mAmounts.resize(entries.size());
+    mBasketCounts.resize(entries.size());
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        ++mItemStart[(entries[i].first >> 32) + 1];
+        mAmounts[i] = std::bit_cast<float>(static_cast<uint32_t>(entries[i].first));
+        mBasketCounts[i] = static_cast<double>(entries[i].second);
+    }
+    for (std::size_t item = 0; item < numItems; ++item) {
+        mItemStart[item + 1] += mItemStart[item];
+    }
+}
+
+std::size_t PromotionSimulator::getNumBaskets() const {
+    return mNumBaskets;
+}
+
+std::size_t PromotionSimulator::getNumAmounts(std::string_view name) const {
+    const Item* item = mDatabase.findItem(name);
+    if (!item || item->getCatalogIndex() + 1 >= mItemStart.size()) {
+        return 0;
+    }
+    return mItemStart[item->getCatalogIndex() + 1] - mItemStart[item->getCatalogIndex()];
+}
+
+bool PromotionSimulator::evaluate(std::string_view name, const std::vector<SpecialParams>& candidates, std::vector<PromotionOutcome>& out) const {
+    const Item* item = mDatabase.findItem(name);
+    if (!item) {
+        std::cerr << "Item not in database" << std::endl;
+        return false;
+    }
+    if (item->getCatalogIndex() + 1 >= mItemStart.size()) {
+        std::cerr << "History not built for item" << std::endl;
+        return false;
+    }
+    for (const auto& candidate : candidates) {
+        if (!isValidCandidate(candidate, *item)) {
+            std::cerr << "Invalid special for item" << std::endl;
+            return false;
+        }
+    }
+
+    const std::size_t begin = mItemStart[item->getCatalogIndex()];
+    const std::size_t end = mItemStart[item->getCatalogIndex() + 1];
+    double amount = 0;
+    for (std::size_t i = begin; i < end; ++i) {
+        amount += mAmounts[i] * mBasketCounts[i];
+    }
+
+    // Current pricing is the baseline of the deltas
+    const float price = item->getPrice() - item->getMarkdown();
+    const double regular = sumPrices<SpecialParams::Type_t::None>({}, item->getPrice(), mAmounts.data() + begin, mBasketCounts.data() + begin, end - begin);
+    const SpecialParams current = item->getSpecial() ? item->getSpecial()->getParams() : SpecialParams{};
+    const double baseRevenue = priceHistory(current, price, begin, end);
+
+    out.clear();
+    out.reserve(candidates.size());
+    for (const auto& candidate : candidates) {
+        PromotionOutcome outcome;
+        outcome.amount = amount;
+        outcome.revenue = priceHistory(candidate, price, begin, end);
+        outcome.discount = regular - outcome.revenue;
+        outcome.revenueDelta = outcome.revenue - baseRevenue;
+        outcome.discountDelta = baseRevenue - outcome.revenue;
+        out.push_back(outcome);
+    }
+    return true;
+}
+
+bool PromotionSimulator::evaluate(std::string_view name, const SpecialParams& candidate, PromotionOutcome& out) const {
+    std::vector<PromotionOutcome> outcomes;
+    if (!evaluate(name, std::vector<SpecialParams>{candidate}, outcomes)) {
+        return false;
+    }
+    out = outcomes[0];
+    return true;
+}
+
+template <SpecialParams::Type_t Type>
+double PromotionSimulator::sumPrices(const SpecialParams& special, float price, const float* amounts, const double* counts, std::size_t size) {
+    double total = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        // Line price is rounded to float like an order does before it is counted
+        const float linePrice = calcSpecialPrice<Type>(special, amounts[i], price);
+        total += linePrice * counts[i];
+    }
+    return total;
+}
+
+double PromotionSimulator::priceHistory(const SpecialParams& special, float price, std::size_t begin, std::size_t end) const {
+    // Dispatch once per item instead of once per amount
+    const float* amounts = mAmounts.data() + begin;
+    const double* counts = mBasketCounts.data() + begin;
+    const std::size_t size = end - begin;
+    switch (special.type) {
+        case SpecialParams::Type_t::BuyOneGetOneUnit:   return sumPrices<SpecialParams::Type_t::BuyOneGetOneUnit>(special, price, amounts, counts, size);
+        case SpecialParams::Type_t::BuyOneGetOneWeight: return sumPrices<SpecialParams::Type_t::BuyOneGetOneWeight>(special, price, amounts, counts, size);
+        case SpecialParams::Type_t::NforX:              return sumPrices<SpecialParams::Type_t::NforX>(special, price, amounts, counts, size);
+        default:                                        return sumPrices<SpecialParams::Type_t::None>(special, price, amounts, counts, size);
+    }
+}
+
+bool PromotionSimulator::isValidCandidate(const SpecialParams& candidate, const Item& item) {
+    if (SpecialParams::Type_t::None == candidate.type) {
+        return true;
+    }
+    if (candidate.byUnit() != (Item::Sale_t::Unit == item.getSaleType())) {
+        return false;
+    }
+    if (!candidate.isValid()) {
+        return false;
+    }
+    return SpecialParams::Type_t::NforX == candidate.type || (candidate.value >= 0 && candidate.value <= 1);
+}
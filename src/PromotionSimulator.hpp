@@ -0,0 +1,86 @@
+#ifndef __PROMOTIONSIMULATOR_HPP__
+#define __PROMOTIONSIMULATOR_HPP__
+
+#include "ItemDatabase.hpp"
+#include "Repricer.hpp"
+#include "Special.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Result of pricing the history of an item with a special
+struct PromotionOutcome {
+    double amount = 0;          // Quantity or weight sold over all baskets
+    double revenue = 0;         // Price charged over all baskets
+    double discount = 0;        // Savings over all baskets compared to the regular price
+    double revenueDelta = 0;    // Change of revenue compared to current catalog pricing
+    double discountDelta = 0;   // Change of discount compared to current catalog pricing
+};
+
+// What-if analysis of specials over archived baskets. A special only depends on how much of
+// its item one order holds, so baskets are boiled down to a histogram of the amount bought per
+// basket for every item. Candidate specials are then priced once per distinct amount instead
+// of once per basket, which makes trying hundreds of variants over a year of baskets cheap.
+// Coupons and taxes are not considered.
+class PromotionSimulator {
+public:
+    // Constructor. Items are priced at their current price and markdown in db, which must
+    // outlive the simulator. Items must not be removed from db
+    explicit PromotionSimulator(const ItemDatabase& db);
+
+    // Add count baskets starting at baskets to the history. Lines of the same item are combined
+    // like an order does. Returns number of lines skipped for unknown items or wrong sale type
+    std::size_t addBaskets(const Basket* baskets, std::size_t count);
+
+    // Add all baskets in the vector to the history
+    std::size_t addBaskets(const std::vector<Basket>& baskets);
+
+    // Build the histogram of the baskets added so far. Must be called before evaluating
+    void build();
+
+    // Return number of baskets in the history
+    std::size_t getNumBaskets() const;
+
+    // Return number of distinct amounts of an item in the built history
+    std::size_t getNumAmounts(std::string_view name) const;
+
+    // Price the history of an item with each candidate special, in the same order as
+    // candidates. A candidate of type None prices without special. Candidates must match the
+    // sale type of the item. Returns status of operation
+    bool evaluate(std::string_view name, const std::vector<SpecialParams>& candidates, std::vector<PromotionOutcome>& out) const;
+
+    // Price the history of an item with a single candidate special. Returns status of operation
+    bool evaluate(std::string_view name, const SpecialParams& candidate, PromotionOutcome& out) const;
+
+private:
+    // Amount of an item in a basket
+    struct Entry {
+        uint32_t item;  // Position of item in the catalog
+        float amount;   // Quantity or weight
+    };
+
+    // Returns price of count baskets each holding amounts[i] of an item with a special of a type
+    // known at compile time, so the loop has no dispatch in it
+    template <SpecialParams::Type_t Type>
+    static double sumPrices(const SpecialParams& special, float price, const float* amounts, const double* counts, std::size_t size);
+
+    // Returns price of the history of an item with a special
+    double priceHistory(const SpecialParams& special, float price, std::size_t begin, std::size_t end) const;
+
+    // Returns true if a candidate can be used for an item
+    static bool isValidCandidate(const SpecialParams& candidate, const Item& item);
+
+private:
+    const ItemDatabase& mDatabase;  // Catalog of the items
+    std::size_t mNumBaskets;        // Baskets in the history
+    std::unordered_map<uint64_t, uint64_t> mCounts; // Baskets by item position and amount bits
+    std::vector<std::size_t> mItemStart;    // Start of the amounts of each item. One more than items
+    std::vector<float> mAmounts;            // Distinct amounts, grouped by item and sorted
+    std::vector<double> mBasketCounts;      // Baskets holding each amount
+    std::vector<Entry> mScratch;            // Combined lines of the basket being added
+};
+
+#endif
@@ -0,0 +1,80 @@
+#include "ReplicatedCatalog.hpp"
+
+#include <thread>
+#include <vector>
+
+template <typename Build>
+void ReplicatedCatalog::onEveryNode(Build build) const {
+    // A fresh thread per node keeps the caller's own affinity untouched
+    std::vector<std::thread> threads;
+    for (unsigned int node = 0; node < mTopology.getNumNodes(); ++node) {
+        threads.emplace_back([this, node, &build]() {
+            mTopology.pinThread(node);
+            build(node);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+ReplicatedCatalog::ReplicatedCatalog(const ItemDatabase& source, const NumaTopology& topology) :
+    mTopology(topology), mGeneration{}, mUpdateMutex{}
+{
+    auto generation = std::make_shared<Generation>();
+    generation->version = 0;
+    generation->replicas.resize(mTopology.getNumNodes());
+    onEveryNode([&](unsigned int node) {
+        generation->replicas[node] = std::make_shared<const ItemDatabase>(source);
+    });
+    mGeneration.store(std::move(generation), std::memory_order_release);
+}
+
+const NumaTopology& ReplicatedCatalog::getTopology() const {
+    return mTopology;
+}
+
+unsigned int ReplicatedCatalog::getLaneNode(unsigned int lane) const {
+    return lane % mTopology.getNumNodes();
+}
+
+bool ReplicatedCatalog::pinLane(unsigned int lane) const {
+    return mTopology.pinThread(getLaneNode(lane));
+}
+
+std::shared_ptr<const ItemDatabase> ReplicatedCatalog::getReplica(unsigned int node) const {
+    return mGeneration.load(std::memory_order_acquire)->replicas[node];
+}
+
+std::shared_ptr<const ItemDatabase> ReplicatedCatalog::getLocalReplica() const {
+    return getReplica(mTopology.getCurrentNode());
+}
+
+bool ReplicatedCatalog::applyDelta(const CatalogDelta& delta) {
+    std::lock_guard<std::mutex> lock(mUpdateMutex);
+
+    // Build and validate the new version on every node before publishing any of them
+    const unsigned int numNodes = mTopology.getNumNodes();
+    std::shared_ptr<const Generation> current = mGeneration.load(std::memory_order_acquire);
+    auto next = std::make_shared<Generation>();
+    next->version = current->version + 1;
+    next->replicas.resize(numNodes);
+    std::vector<char> ok(numNodes, 0);
+    onEveryNode([&](unsigned int node) {
+        auto replica = std::make_shared<ItemDatabase>(*current->replicas[node]);
+        ok[node] = replica->applyDelta(delta);
+        next->replicas[node] = std::move(replica);
+    });
+    for (unsigned int node = 0; node < numNodes; ++node) {
+        if (!ok[node]) {
+            return false;
+        }
+    }
+
+    mGeneration.store(std::move(next), std::memory_order_release);
+    return true;
+}
+
+uint64_t ReplicatedCatalog::getVersion() const {
+    return mGeneration.load(std::memory_order_acquire)->version;
+}
@@ -0,0 +1,68 @@
+#ifndef __REPLICATEDCATALOG_HPP__
+#define __REPLICATEDCATALOG_HPP__
+
+#include "CatalogDelta.hpp"
+#include "ItemDatabase.hpp"
+#include "NumaTopology.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Read-only catalog replicated once per NUMA node for multi-socket servers. Every replica is
+// copied by a thread pinned to its node, so the kernel first-touch policy places its memory
+// there, and lane threads pinned to a node read only the replica of that node. Specials are
+// small and stay shared between replicas.
+//
+// Lanes take a replica per order, keeping it alive for as long as the order uses it. Updates
+// build a new replica on every node and publish all of them as one generation with a single
+// pointer swap, so lanes on every node switch to the update at the same moment, and an invalid
+// update reaches no node.
+class ReplicatedCatalog {
+public:
+    // Constructor. Replicates source on every node of topology
+    explicit ReplicatedCatalog(const ItemDatabase& source, const NumaTopology& topology = NumaTopology::detect());
+
+    // Return topology the catalog is replicated over
+    const NumaTopology& getTopology() const;
+
+    // Returns node of a lane. Lanes are spread over the nodes round robin
+    unsigned int getLaneNode(unsigned int lane) const;
+
+    // Pin the calling lane thread to the node of the lane so it runs and allocates there.
+    // Returns status of operation
+    bool pinLane(unsigned int lane) const;
+
+    // Returns replica of a node
+    std::shared_ptr<const ItemDatabase> getReplica(unsigned int node) const;
+
+    // Returns replica of the node the calling thread runs on
+    std::shared_ptr<const ItemDatabase> getLocalReplica() const;
+
+    // Apply the delta to every replica. Returns status of operation, nothing is published if
+    // the delta is invalid
+    bool applyDelta(const CatalogDelta& delta);
+
+    // Return number of updates published
+    uint64_t getVersion() const;
+
+private:
+    // Replicas of every node for one version of the catalog
+    struct Generation {
+        uint64_t version;                                           // Number of updates before it
+        std::vector<std::shared_ptr<const ItemDatabase>> replicas;  // Replica of each node
+    };
+
+    // Run build for every node on a thread pinned to that node
+    template <typename Build>
+    void onEveryNode(Build build) const;
+
+private:
+    NumaTopology mTopology;                                     // Nodes and their CPUs
+    std::atomic<std::shared_ptr<const Generation>> mGeneration; // Published replicas
+    std::mutex mUpdateMutex;                                    // Serializes updates
+};
+
+#endif
@@ -0,0 +1,125 @@
+#include "Repricer.hpp"
+#include "Order.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace {
+// Range of chunks owned by a worker. The owner and thieves both claim chunks through next,
+// aligned to a cache line so workers dont contend on each others counters
+struct alignas(64) ChunkRange {
+    std::atomic<std::size_t> next{0};
+    std::size_t end = 0;
+};
+
+// Partial sums of a single chunk, combined in chunk order once all workers are done
+struct ChunkSum {
+    double total = 0;
+    double savings = 0;
+    std::size_t failedLines = 0;
+};
+}
+
+Repricer::Repricer(const ItemDatabase& db, unsigned int numThreads) :
+    mDatabase(db), mNumThreads(numThreads)
+{
+    if (mNumThreads == 0) {
+        mNumThreads = std::max(1U, std::thread::hardware_concurrency());
+    }
+}
+
+unsigned int Repricer::getNumThreads() const {
+    return mNumThreads;
+}
+
+RepriceResult Repricer::reprice(const std::vector<Basket>& baskets) const {
+    return reprice(baskets.data(), baskets.size());
+}
+
+RepriceResult Repricer::reprice(const Basket* baskets, std::size_t count) const {
+    RepriceResult result;
+    result.totals.resize(count);
+    result.savings.resize(count);
+
+    const std::size_t numChunks = (count + kChunkSize - 1) / kChunkSize;
+    if (numChunks == 0) {
+        return result;
+    }
+    std::vector<ChunkSum> sums(numChunks);
+
+    // Split chunks evenly between workers. Each worker starts on its own range
+    const unsigned int numWorkers = static_cast<unsigned int>(std::min<std::size_t>(mNumThreads, numChunks));
+    std::unique_ptr<ChunkRange[]> ranges(new ChunkRange[numWorkers]);
+    for (unsigned int w = 0; w < numWorkers; ++w) {
+        ranges[w].next.store(numChunks * w / numWorkers, std::memory_order_relaxed);
+        ranges[w].end = numChunks * (w + 1) / numWorkers;
+    }
+
+    auto processChunk = [&](Order& order, std::size_t chunk) {
+        ChunkSum& sum = sums[chunk];
+        const std::size_t last = std::min(count, (chunk + 1) * kChunkSize);
+        for (std::size_t i = chunk * kChunkSize; i < last; ++i) {
+            sum.failedLines += priceBasket(order, baskets[i], result.totals[i], result.savings[i]);
+            sum.total += result.totals[i];
+            sum.savings += result.savings[i];
+        }
+    };
+
+    auto worker = [&](unsigned int self) {
+        // One order per worker keeps its cart memory and item cache across baskets, so
+        // workers do not contend on the allocator
+        Order order(mDatabase);
+
+        // Drain own range first then steal from the other workers
+        for (unsigned int offset = 0; offset < numWorkers; ++offset) {
+            ChunkRange& range = ranges[(self + offset) % numWorkers];
+            for (;;) {
+                std::size_t chunk = range.next.fetch_add(1, std::memory_order_relaxed);
+                if (chunk >= range.end) {
+                    break;
+                }
+                processChunk(order, chunk);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(numWorkers - 1);
+    for (unsigned int w = 1; w < numWorkers; ++w) {
+        threads.emplace_back(worker, w);
+    }
+    worker(0); // Calling thread takes part in the work
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    // Reduce chunk sums in order so results dont depend on thread scheduling
+    for (const auto& sum : sums) {
+        result.total += sum.total;
+        result.totalSavings += sum.savings;
+        result.failedLines += sum.failedLines;
+    }
+
+    return result;
+}
+
+std::size_t Repricer::priceBasket(Order& order, const Basket& basket, float& total, float& savings) const {
+    order.Reset();
+    std::size_t failed = 0;
+    for (const auto& line : basket) {
+        bool ok = true;
+        if (std::holds_alternative<unsigned int>(line.amount)) {
+            // Price all units of the line in one step. An empty line has nothing to scan
+            const unsigned int qty = std::get<unsigned int>(line.amount);
+            ok = (qty == 0) || order.ScanUnits(line.name, qty);
+        } else {
+            ok = order.ScanItem(line.name, std::get<float>(line.amount));
+        }
+        failed += ok ? 0 : 1;
+    }
+    total = order.getTotalPrice();
+    savings = order.getSavings();
+    return failed;
+}
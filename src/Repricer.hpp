@@ -0,0 +1,63 @@
+#ifndef __REPRICER_HPP__
+#define __REPRICER_HPP__
+
+#include "ItemDatabase.hpp"
+
+class Order;
+
+#include <cstddef>
+#include <string>
+#include <variant>
+#include <vector>
+
+// Single line of an archived basket. Amount is a quantity for items sold by unit
+// or a weight for items sold by weight
+struct BasketLine {
+    std::string name;
+    std::variant<unsigned int, float> amount;
+};
+
+// Archived basket of lines to be priced as one order
+using Basket = std::vector<BasketLine>;
+
+// Results of repricing a set of baskets. Per basket values are in the same order as the input
+struct RepriceResult {
+    std::vector<float> totals;  // Total price of each basket
+    std::vector<float> savings; // Savings of each basket through markdowns and specials
+    double total = 0;           // Total price of all baskets
+    double totalSavings = 0;    // Savings of all baskets
+    std::size_t failedLines = 0; // Lines that could not be scanned (unknown item, wrong sale type, etc)
+};
+
+// Reprices large sets of archived baskets against a read-only item database using a pool
+// of worker threads. Results are deterministic regardless of the number of threads used.
+class Repricer {
+public:
+    // Constructor. Database must not be modified while repricing. A thread count of 0 uses
+    // the number of hardware threads available
+    explicit Repricer(const ItemDatabase& db, unsigned int numThreads = 0);
+
+    // Reprice count baskets starting at baskets
+    RepriceResult reprice(const Basket* baskets, std::size_t count) const;
+
+    // Reprice all baskets in the vector
+    RepriceResult reprice(const std::vector<Basket>& baskets) const;
+
+    // Return number of worker threads used
+    unsigned int getNumThreads() const;
+
+private:
+    // Price a single basket through order, which is reset first so a worker reuses one order
+    // for all its baskets. Returns number of lines that failed to scan
+    std::size_t priceBasket(Order& order, const Basket& basket, float& total, float& savings) const;
+
+private:
+    // Baskets are handed out to workers in chunks of this size. The chunk size is fixed so the
+    // order of the reduction doesnt depend on the number of threads
+    static constexpr std::size_t kChunkSize = 256;
+
+    const ItemDatabase& mDatabase; // Database of available items
+    unsigned int mNumThreads;      // Number of worker threads
+};
+
+#endif
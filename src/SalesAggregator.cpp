@@ -0,0 +1,148 @@
+#include "SalesAggregator.hpp"
+
+#include <algorithm>
+#include <new>
+#include <queue>
+
+void SalesAggregator::Lane::record(uint32_t item, float amount, float revenue, float savings) noexcept {
+    Page* page = (item < mNumItems) ? getPage(item / kPageSize) : nullptr;
+    if (page) {
+        Counters& counters = page->counters[item % kPageSize];
+        add(counters.amount, amount);
+        add(counters.revenue, revenue);
+        add(counters.savings, savings);
+    }
+    add(mTotals.amount, amount);
+    add(mTotals.revenue, revenue);
+    add(mTotals.savings, savings);
+}
+
+void SalesAggregator::Lane::add(std::atomic<double>& counter, double value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+SalesAggregator::Lane::Page* SalesAggregator::Lane::getPage(std::size_t p) noexcept {
+    Page* page = mPages[p].load(std::memory_order_relaxed);
+    if (!page) {
+        // mOwned has room for every page, so only the page itself can fail to allocate
+        page = new (std::nothrow) Page;
+        if (!page) {
+            return nullptr;
+        }
+        mOwned.emplace_back(page);
+        mPages[p].store(page, std::memory_order_release);
+    }
+    return page;
+}
+
+SalesAggregator::Sales SalesAggregator::Lane::load(const Counters& counters) {
+    return { counters.amount.load(std::memory_order_relaxed), counters.revenue.load(std::memory_order_relaxed),
+             counters.savings.load(std::memory_order_relaxed) };
+}
+
+SalesAggregator::SalesAggregator(std::size_t numItems, unsigned int numLanes) :
+    mNumItems(numItems), mLanes(std::make_unique<PaddedLane[]>(numLanes)), mNumLanes(numLanes),
+    mSnapshot(numItems), mSold{}, mTotals{}
+{
+    const std::size_t numPages = (numItems + Lane::kPageSize - 1) / Lane::kPageSize;
+    for (unsigned int i = 0; i < numLanes; ++i) {
+        mLanes[i].lane.mNumItems = numItems;
+        mLanes[i].lane.mPages = std::make_unique<std::atomic<Lane::Page*>[]>(numPages);
+        mLanes[i].lane.mOwned.reserve(numPages);
+    }
+}
+
+SalesAggregator::Lane& SalesAggregator::getLane(unsigned int lane) {
+    return mLanes[lane].lane;
+}
+
+unsigned int SalesAggregator::getNumLanes() const {
+    return mNumLanes;
+}
+
+void SalesAggregator::merge() {
+    // Only items of pages some lane has used can have sales
+    for (uint32_t item : mSold) {
+        mSnapshot[item] = {};
+    }
+    mSold.clear();
+    mTotals = {};
+
+    const std::size_t numPages = (mNumItems + Lane::kPageSize - 1) / Lane::kPageSize;
+    std::vector<bool> pageUsed(numPages);
+    for (unsigned int i = 0; i < mNumLanes; ++i) {
+        const Lane& lane = mLanes[i].lane;
+        for (std::size_t p = 0; p < numPages; ++p) {
+            const Lane::Page* page = lane.mPages[p].load(std::memory_order_acquire);
+            if (!page) {
+                continue;
+            }
+            const std::size_t first = p * Lane::kPageSize;
+            const std::size_t last = std::min(first + Lane::kPageSize, mNumItems);
+            for (std::size_t item = first; item < last; ++item) {
+                const Sales sales = Lane::load(page->counters[item - first]);
+                mSnapshot[item].amount += sales.amount;
+                mSnapshot[item].revenue += sales.revenue;
+                mSnapshot[item].savings += sales.savings;
+            }
+            if (!pageUsed[p]) {
+                pageUsed[p] = true;
+                for (std::size_t item = first; item < last; ++item) {
+                    mSold.push_back(static_cast<uint32_t>(item));
+                }
+            }
+        }
+
+        const Sales totals = Lane::load(lane.mTotals);
+        mTotals.amount += totals.amount;
+        mTotals.revenue += totals.revenue;
+        mTotals.savings += totals.savings;
+    }
+
+    // Keep only items that sold something
+    mSold.erase(std::remove_if(mSold.begin(), mSold.end(), [this](uint32_t item) {
+        const Sales& sales = mSnapshot[item];
+        return sales.amount == 0 && sales.revenue == 0 && sales.savings == 0;
+    }), mSold.end());
+}
+
+const SalesAggregator::Sales& SalesAggregator::getTotals() const {
+    return mTotals;
+}
+
+SalesAggregator::Sales SalesAggregator::getItemSales(uint32_t item) const {
+    return (item < mNumItems) ? mSnapshot[item] : Sales{};
+}
+
+std::vector<std::pair<uint32_t, SalesAggregator::Sales>> SalesAggregator::getTopItems(std::size_t k, Rank_t rank) const {
+    auto value = [rank](const Sales& sales) {
+        switch (rank) {
+            case Rank_t::Amount: return sales.amount;
+            case Rank_t::Savings: return sales.savings;
+            default: return sales.revenue;
+        }
+    };
+    // Ties go to the lower catalog index so results dont depend on the merge order
+    auto better = [&](uint32_t a, uint32_t b) {
+        const double va = value(mSnapshot[a]), vb = value(mSnapshot[b]);
+        return va > vb || (va == vb && a < b);
+    };
+
+    // Min-heap of the best k items seen so far
+    std::priority_queue<uint32_t, std::vector<uint32_t>, decltype(better)> best(better);
+    for (uint32_t item : mSold) {
+        if (best.size() < k) {
+            best.push(item);
+        } else if (k > 0 && better(item, best.top())) {
+            best.pop();
+            best.push(item);
+        }
+    }
+
+    std::vector<std::pair<uint32_t, Sales>> top(best.size());
+    for (std::size_t i = top.size(); i > 0; --i) {
+        top[i - 1] = { best.top(), mSnapshot[best.top()] };
+        best.pop();
+    }
+    return top;
+}
@@ -0,0 +1,106 @@
+#ifndef __SALESAGGREGATOR_HPP__
+#define __SALESAGGREGATOR_HPP__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Store-wide sales of all lanes. Every lane records into its own shard of counters indexed by
+// Item::getCatalogIndex, so lanes never write the same cache line and recording takes no lock
+// and no atomic read-modify-write. An operations thread periodically merges the shards into a
+// snapshot and reads top sellers and totals from it.
+//
+// Shard counters are allocated in pages on first use, so a lane only pays memory for the
+// items it actually sold.
+class SalesAggregator {
+public:
+    // Sales of an item or of the whole store
+    struct Sales {
+        double amount = 0;  // Quantity or weight sold
+        double revenue = 0; // Price charged, before coupons
+        double savings = 0; // Amount saved through markdowns and specials
+    };
+
+    // What top sellers are ranked by
+    enum class Rank_t { Amount, Revenue, Savings };
+
+    // Counters of a single lane. Only one thread may record into a lane at a time
+    class Lane {
+    public:
+        // Record a change of the sales of the item with the given catalog index. Negative values
+        // undo earlier sales. Items outside the catalog, or whose page of counters cannot be
+        // allocated, only count towards the totals
+        void record(uint32_t item, float amount, float revenue, float savings) noexcept;
+
+    private:
+        friend class SalesAggregator;
+
+        static constexpr std::size_t kPageSize = 1024; // Items per page of counters
+
+        // Counters of an item. Written by the lane, read by the merge
+        struct Counters {
+            std::atomic<double> amount{0};
+            std::atomic<double> revenue{0};
+            std::atomic<double> savings{0};
+        };
+
+        struct Page {
+            Counters counters[kPageSize];
+        };
+
+        // Add value to a counter. Only the owning lane writes, so no read-modify-write is needed
+        static void add(std::atomic<double>& counter, double value);
+
+        // Returns page of counters at position p, allocating it on first use. Returns nullptr
+        // if out of memory
+        Page* getPage(std::size_t p) noexcept;
+
+        // Returns sales read from counters
+        static Sales load(const Counters& counters);
+
+        std::unique_ptr<std::atomic<Page*>[]> mPages;   // Pages of counters, nullptr until used
+        std::vector<std::unique_ptr<Page>> mOwned;      // Allocated pages. Reserved for all pages
+        std::size_t mNumItems = 0;                      // Number of items with counters
+        Counters mTotals;                               // Sales of all items of the lane
+    };
+
+    // Constructor. Counters are kept for items with a catalog index below numItems
+    SalesAggregator(std::size_t numItems, unsigned int numLanes);
+
+    // Return the lane with the given number for a checkout to record into
+    Lane& getLane(unsigned int lane);
+
+    // Return number of lanes
+    unsigned int getNumLanes() const;
+
+    // Add up the counters of all lanes into a new snapshot. Lanes keep recording meanwhile,
+    // sales recorded during the merge show up in this or the next snapshot
+    void merge();
+
+    // Return store totals of the last snapshot
+    const Sales& getTotals() const;
+
+    // Return sales of an item in the last snapshot
+    Sales getItemSales(uint32_t item) const;
+
+    // Return up to k items with the highest sales in the last snapshot as catalog index and
+    // sales, best first. Items without sales are left out
+    std::vector<std::pair<uint32_t, Sales>> getTopItems(std::size_t k, Rank_t rank = Rank_t::Revenue) const;
+
+private:
+    // Lane padded to its own cache lines
+    struct alignas(64) PaddedLane {
+        Lane lane;
+    };
+
+    std::size_t mNumItems;                      // Number of items with counters
+    std::unique_ptr<PaddedLane[]> mLanes;       // Counters of each lane
+    unsigned int mNumLanes;                     // Number of lanes
+    std::vector<Sales> mSnapshot;               // Merged sales per item
+    std::vector<uint32_t> mSold;                // Items with sales in the snapshot
+    Sales mTotals;                              // Merged totals
+};
+
+#endif
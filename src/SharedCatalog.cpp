@@ -0,0 +1,314 @@
+#include "SharedCatalog.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared counters must be lock free to work across processes");
+
+namespace {
+constexpr char kMagic[4] = {'S', 'C', 'A', 'T'};
+constexpr uint32_t kLayout = 1;
+
+// Round bytes up to a whole cache line
+constexpr std::size_t alignLine(std::size_t bytes) {
+    return (bytes + 63) / 64 * 64;
+}
+}
+
+// Start of the segment. Sizes are fixed at creation
+struct alignas(64) SharedCatalog::Header {
+    char magic[4];                  // Written last when the segment is created
+    uint32_t layout;                // Layout of the segment
+    uint64_t maxItems;              // Records per slot
+    uint64_t nameBytes;             // Name arena bytes per slot
+    uint64_t slotBytes;             // Bytes per slot including its header
+    std::atomic<uint64_t> version;  // Published version. Slot version % 2 holds it
+};
+
+// Start of a slot, followed by its records, GTIN index and name arena
+struct alignas(64) SharedCatalog::SlotHeader {
+    std::atomic<uint64_t> sequence; // Odd while the slot is written
+    uint64_t version;               // Version held by the slot
+    uint64_t numItems;              // Records in the slot
+    uint64_t numGtins;              // GTIN index entries in the slot
+};
+
+SharedCatalog::SharedCatalog() :
+    mBase(nullptr), mBytes(0), mPublisher(false)
+{}
+
+SharedCatalog::~SharedCatalog() {
+    detach();
+}
+
+bool SharedCatalog::create(const std::string& name, std::size_t maxItems, std::size_t nameBytes) {
+    detach();
+    if (maxItems == 0 || nameBytes > UINT32_MAX) {
+        std::cerr << "Invalid shared catalog size" << std::endl;
+        return false;
+    }
+
+    const std::size_t slotBytes = alignLine(sizeof(SlotHeader) + maxItems * sizeof(Record) + maxItems * sizeof(GtinEntry) + nameBytes);
+    const std::size_t bytes = sizeof(Header) + 2 * slotBytes;
+    // Replace an existing segment by a new object rather than resizing it, so lanes still
+    // mapping the old one keep reading it until they reopen
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        std::cerr << "Unable to create shared catalog " << name << std::endl;
+        return false;
+    }
+    const bool mapped = (ftruncate(fd, static_cast<off_t>(bytes)) == 0) && map(fd, bytes, true);
+    ::close(fd);
+    if (!mapped) {
+        std::cerr << "Unable to map shared catalog " << name << std::endl;
+        return false;
+    }
+
+    // The new segment is zero filled, which leaves both slots empty at version 0
+    Header* header = new (mBase) Header{{}, kLayout, maxItems, nameBytes, slotBytes, {0}};
+    for (uint64_t slot = 0; slot < 2; ++slot) {
+        new (getSlot(slot)) SlotHeader{{0}, 0, 0, 0};
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header->magic, kMagic, sizeof(kMagic));
+    mPublisher = true;
+    return true;
+}
+
+bool SharedCatalog::open(const std::string& name) {
+    detach();
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        std::cerr << "Unable to open shared catalog " << name << std::endl;
+        return false;
+    }
+    struct stat info;
+    const bool mapped = (fstat(fd, &info) == 0) && static_cast<std::size_t>(info.st_size) >= sizeof(Header) &&
+                        map(fd, static_cast<std::size_t>(info.st_size), false);
+    ::close(fd);
+    if (!mapped) {
+        std::cerr << "Unable to map shared catalog " << name << std::endl;
+        return false;
+    }
+
+    const Header* header = getHeader();
+    if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->layout != kLayout ||
+        header->maxItems == 0 || header->maxItems > mBytes || header->nameBytes > mBytes ||
+        header->slotBytes < sizeof(SlotHeader) + header->maxItems * (sizeof(Record) + sizeof(GtinEntry)) + header->nameBytes ||
+        sizeof(Header) + 2 * header->slotBytes != mBytes) {
+        std::cerr << "Invalid shared catalog " << name << std::endl;
+        detach();
+        return false;
+    }
+    return true;
+}
+
+bool SharedCatalog::unlink(const std::string& name) {
+    if (shm_unlink(name.c_str()) != 0) {
+        std::cerr << "Unable to remove shared catalog " << name << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool SharedCatalog::publish(const ItemDatabase& db) {
+    if (!mPublisher) {
+        std::cerr << "Only the creator of a shared catalog can publish" << std::endl;
+        return false;
+    }
+
+    // Check the catalog fits before touching the slot
+    Header* header = getHeader();
+    const auto& items = db.getItems();
+    std::size_t namesSize = 0;
+    for (const auto& item : items) {
+        namesSize += item.getName().size();
+    }
+    if (items.size() > header->maxItems || namesSize > header->nameBytes) {
+        std::cerr << "Catalog does not fit shared catalog" << std::endl;
+        return false;
+    }
+
+    // Lay out records in name order so readers can binary search them
+    std::vector<const Item*> sorted;
+    sorted.reserve(items.size());
+    for (const auto& item : items) {
+        sorted.push_back(&item);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const Item* a, const Item* b) { return a->getName() < b->getName(); });
+
+    // Fill the slot readers are not directed to. Only readers still on the version before the
+    // current one can be in it, and they retry
+    const uint64_t next = header->version.load(std::memory_order_relaxed) + 1;
+    SlotHeader* slot = getSlot(next);
+    const uint64_t sequence = slot->sequence.load(std::memory_order_relaxed);
+    slot->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    Record* records = getRecords(slot);
+    GtinEntry* gtins = getGtins(slot);
+    char* names = getNames(slot);
+    std::size_t nameOffset = 0, numGtins = 0;
+    for (std::size_t i = 0; i < sorted.size(); ++i) {
+        const Item& item = *sorted[i];
+        Record record{};
+        record.gtin = item.getGtin();
+        record.nameOffset = static_cast<uint32_t>(nameOffset);
+        record.nameLength = static_cast<uint32_t>(item.getName().size());
+        record.price = item.getPrice();
+        record.markdown = item.getMarkdown();
+        record.saleType = item.getSaleType();
+        record.taxCategory = item.getTaxCategory();
+        if (item.getSpecial()) {
+            record.special = item.getSpecial()->getParams();
+        }
+        std::memcpy(names + nameOffset, item.getName().data(), record.nameLength);
+        nameOffset += record.nameLength;
+        records[i] = record;
+        if (record.gtin != 0) {
+            gtins[numGtins++] = {record.gtin, static_cast<uint32_t>(i)};
+        }
+    }
+    std::sort(gtins, gtins + numGtins, [](const GtinEntry& a, const GtinEntry& b) { return a.gtin < b.gtin; });
+    slot->version = next;
+    slot->numItems = sorted.size();
+    slot->numGtins = numGtins;
+
+    slot->sequence.store(sequence + 2, std::memory_order_release);
+    header->version.store(next, std::memory_order_release);
+    return true;
+}
+
+uint64_t SharedCatalog::getVersion() const {
+    return mBase ? getHeader()->version.load(std::memory_order_acquire) : 0;
+}
+
+bool SharedCatalog::findItem(std::string_view name, Record& out, uint64_t* version) const {
+    return readConsistent([&](SlotHeader* slot) {
+        const long pos = findRecord(slot, name);
+        if (pos < 0) {
+            return false;
+        }
+        std::memcpy(&out, getRecords(slot) + pos, sizeof(Record));
+        return true;
+    }, version);
+}
+
+bool SharedCatalog::findItemByGtin(uint64_t gtin, Record& out, std::string& name, uint64_t* version) const {
+    return readConsistent([&](SlotHeader* slot) {
+        const GtinEntry* gtins = getGtins(slot);
+        const std::size_t numGtins = std::min<uint64_t>(slot->numGtins, getHeader()->maxItems);
+        const GtinEntry* it = std::lower_bound(gtins, gtins + numGtins, gtin,
+            [](const GtinEntry& entry, uint64_t key) { return entry.gtin < key; });
+        if (it == gtins + numGtins || it->gtin != gtin || it->record >= getHeader()->maxItems) {
+            return false;
+        }
+        std::memcpy(&out, getRecords(slot) + it->record, sizeof(Record));
+        name.assign(getName(slot, out));
+        return true;
+    }, version);
+}
+
+std::size_t SharedCatalog::size() const {
+    std::size_t numItems = 0;
+    readConsistent([&](SlotHeader* slot) {
+        numItems = slot->numItems;
+        return true;
+    }, nullptr);
+    return numItems;
+}
+
+SharedCatalog::Header* SharedCatalog::getHeader() const {
+    return static_cast<Header*>(mBase);
+}
+
+SharedCatalog::SlotHeader* SharedCatalog::getSlot(uint64_t version) const {
+    char* base = static_cast<char*>(mBase) + sizeof(Header);
+    return reinterpret_cast<SlotHeader*>(base + (version % 2) * getHeader()->slotBytes);
+}
+
+SharedCatalog::Record* SharedCatalog::getRecords(SlotHeader* slot) const {
+    return reinterpret_cast<Record*>(reinterpret_cast<char*>(slot) + sizeof(SlotHeader));
+}
+
+SharedCatalog::GtinEntry* SharedCatalog::getGtins(SlotHeader* slot) const {
+    return reinterpret_cast<GtinEntry*>(getRecords(slot) + getHeader()->maxItems);
+}
+
+char* SharedCatalog::getNames(SlotHeader* slot) const {
+    return reinterpret_cast<char*>(getGtins(slot) + getHeader()->maxItems);
+}
+
+std::string_view SharedCatalog::getName(SlotHeader* slot, const Record& record) const {
+    if (static_cast<uint64_t>(record.nameOffset) + record.nameLength > getHeader()->nameBytes) {
+        return {};
+    }
+    return std::string_view(getNames(slot) + record.nameOffset, record.nameLength);
+}
+
+long SharedCatalog::findRecord(SlotHeader* slot, std::string_view name) const {
+    // Counts may be torn while the slot is rewritten, so they are clamped to the slot
+    const Record* records = getRecords(slot);
+    const std::size_t numItems = std::min<uint64_t>(slot->numItems, getHeader()->maxItems);
+    const Record* it = std::lower_bound(records, records + numItems, name,
+        [&](const Record& record, std::string_view key) { return getName(slot, record) < key; });
+    if (it == records + numItems || getName(slot, *it) != name) {
+        return -1;
+    }
+    return it - records;
+}
+
+template <typename Read>
+bool SharedCatalog::readConsistent(Read read, uint64_t* version) const {
+    if (!mBase) {
+        return false;
+    }
+    for (;;) {
+        const uint64_t current = getHeader()->version.load(std::memory_order_acquire);
+        SlotHeader* slot = getSlot(current);
+        const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        if (sequence % 2 != 0) {
+            continue; // Publisher moved on twice since the version was read
+        }
+        // The slot may already hold a later version if the publisher moved on twice since the
+        // version was read, so the version is checked along with the data
+        const uint64_t held = slot->version;
+        const bool result = read(slot);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->sequence.load(std::memory_order_relaxed) == sequence && held == current) {
+            if (version) {
+                *version = current;
+            }
+            return result;
+        }
+    }
+}
+
+bool SharedCatalog::map(int fd, std::size_t bytes, bool writable) {
+    void* base = mmap(nullptr, bytes, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+    mBase = base;
+    mBytes = bytes;
+    return true;
+}
+
+void SharedCatalog::detach() {
+    if (mBase) {
+        munmap(mBase, mBytes);
+    }
+    mBase = nullptr;
+    mBytes = 0;
+    mPublisher = false;
+}
@@ -0,0 +1,119 @@
+#ifndef __SHAREDCATALOG_HPP__
+#define __SHAREDCATALOG_HPP__
+
+#include "ItemDatabase.hpp"
+#include "Special.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Catalog in a POSIX shared memory segment, written by one publisher process and mapped
+// read-only by any number of lane processes. The segment holds two slots with a packed copy of
+// the catalog each. The publisher fills the slot readers are not directed to and then bumps the
+// version, which points readers at it, so an update reaches every lane with a single store.
+//
+// Each slot carries a sequence number that is odd while the slot is written. Readers copy what
+// they need and retry if the sequence moved in the meantime, so readers never block the
+// publisher and the publisher never waits for readers. A reader only retries if it was still
+// reading a version two updates old.
+class SharedCatalog {
+public:
+    // Packed item record
+    struct Record {
+        uint64_t gtin;          // Barcode number. 0 = none
+        uint32_t nameOffset;    // Offset of name in the name arena of the slot
+        uint32_t nameLength;    // Length of name
+        float price;            // Price in dollars per unit or per pound
+        float markdown;         // Amount in dollars to lower price
+        SpecialParams special;  // Special if type is not None
+        Item::Sale_t saleType;  // Sale type
+        uint8_t taxCategory;    // Tax category
+    };
+
+    // Default constructor. Not attached to a segment
+    SharedCatalog();
+
+    // Destructor. Unmaps the segment, the segment itself stays until unlinked
+    ~SharedCatalog();
+
+    SharedCatalog(const SharedCatalog&) = delete;
+    SharedCatalog& operator=(const SharedCatalog&) = delete;
+
+    // Create the segment name, e.g. "/checkout-catalog", with room for maxItems items whose names
+    // take up to nameBytes bytes in total, and attach as its publisher. An existing segment of
+    // that name is unlinked and replaced by a new one; readers still mapping the old segment
+    // keep its last version until they open the name again. Returns status of operation
+    bool create(const std::string& name, std::size_t maxItems, std::size_t nameBytes);
+
+    // Attach read-only to an existing segment. Returns status of operation
+    bool open(const std::string& name);
+
+    // Remove the segment name. Attached catalogs keep working. Returns status of operation
+    static bool unlink(const std::string& name);
+
+    // Publish the contents of db as the next version. Only the catalog that created the
+    // segment can publish, and the catalog must fit the segment. Returns status of operation
+    bool publish(const ItemDatabase& db);
+
+    // Return current version. 0 until the first publish
+    uint64_t getVersion() const;
+
+    // Copy the record of an item into out and the version it was read from into version.
+    // Returns false if not found
+    bool findItem(std::string_view name, Record& out, uint64_t* version = nullptr) const;
+
+    // Copy the record and name of the item with a GTIN into out and name and the version they
+    // were read from into version. Returns false if not found
+    bool findItemByGtin(uint64_t gtin, Record& out, std::string& name, uint64_t* version = nullptr) const;
+
+    // Return number of items of the current version
+    std::size_t size() const;
+
+private:
+    struct Header;
+    struct SlotHeader;
+
+    // Entry of the GTIN index of a slot, sorted by GTIN
+    struct GtinEntry {
+        uint64_t gtin;      // Barcode number
+        uint32_t record;    // Position of the record in the slot
+    };
+
+    // Returns header of the segment
+    Header* getHeader() const;
+
+    // Returns slot holding a version
+    SlotHeader* getSlot(uint64_t version) const;
+
+    // Returns records, GTIN index and name arena of a slot
+    Record* getRecords(SlotHeader* slot) const;
+    GtinEntry* getGtins(SlotHeader* slot) const;
+    char* getNames(SlotHeader* slot) const;
+
+    // Returns name of a record, or an empty name if the record is out of bounds because the slot
+    // is being rewritten
+    std::string_view getName(SlotHeader* slot, const Record& record) const;
+
+    // Returns position of the record of name in a slot or -1 if not found
+    long findRecord(SlotHeader* slot, std::string_view name) const;
+
+    // Run read on the slot of the current version until it ran without the slot being rewritten.
+    // Returns the result of read
+    template <typename Read>
+    bool readConsistent(Read read, uint64_t* version) const;
+
+    // Map the segment open in fd. Returns status of operation
+    bool map(int fd, std::size_t bytes, bool writable);
+
+    // Unmap the segment if attached
+    void detach();
+
+private:
+    void* mBase;            // Start of the mapping or nullptr if not attached
+    std::size_t mBytes;     // Size of the mapping
+    bool mPublisher;        // Attached as publisher
+};
+
+#endif
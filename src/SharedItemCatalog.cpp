@@ -0,0 +1,59 @@
+#include "SharedItemCatalog.hpp"
+
+#include <memory>
+
+SharedItemCatalog::SharedItemCatalog(const SharedCatalog& shared) :
+    mShared(shared), mVersion(0), mItems{}
+{}
+
+const Item* SharedItemCatalog::findItem(std::string_view name) const {
+    if (mVersion == mShared.getVersion()) {
+        auto it = mItems.find(name);
+        if (it != mItems.end()) {
+            return &it->second;
+        }
+    }
+
+    SharedCatalog::Record record;
+    uint64_t version;
+    if (!mShared.findItem(name, record, &version)) {
+        return nullptr;
+    }
+    return materialize(record, name, version);
+}
+
+const Item* SharedItemCatalog::findItemByGtin(uint64_t gtin) const {
+    SharedCatalog::Record record;
+    std::string name;
+    uint64_t version;
+    if (!mShared.findItemByGtin(gtin, record, name, &version)) {
+        return nullptr;
+    }
+    if (version == mVersion) {
+        auto it = mItems.find(name);
+        if (it != mItems.end()) {
+            return &it->second;
+        }
+    }
+    return materialize(record, name, version);
+}
+
+uint64_t SharedItemCatalog::getEpoch() const {
+    return mShared.getVersion();
+}
+
+const Item* SharedItemCatalog::materialize(const SharedCatalog::Record& record, std::string_view name, uint64_t version) const {
+    if (version != mVersion) {
+        mItems.clear();
+        mVersion = version;
+    }
+
+    Item item(std::string(name), record.saleType, record.price);
+    item.setMarkdown(record.markdown);
+    item.setGtin(record.gtin);
+    item.setTaxCategory(record.taxCategory);
+    if (SpecialParams::Type_t::None != record.special.type) {
+        item.setSpecial(std::make_shared<ParamsSpecial>(record.special));
+    }
+    return &mItems.insert_or_assign(std::string(name), std::move(item)).first->second;
+}
@@ -0,0 +1,42 @@
+#ifndef __SHAREDITEMCATALOG_HPP__
+#define __SHAREDITEMCATALOG_HPP__
+
+#include "ItemCatalog.hpp"
+#include "SharedCatalog.hpp"
+#include "StringHash.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// ItemCatalog view of a SharedCatalog so Orders in a lane process price against the published
+// catalog. Items are built from the shared records the first time they are looked up and kept
+// until a new version is published, which changes the epoch so Orders drop cached pointers.
+// Not thread safe, each lane thread needs its own view.
+class SharedItemCatalog : public ItemCatalog {
+public:
+    // Constructor. Shared catalog must outlive the view
+    explicit SharedItemCatalog(const SharedCatalog& shared);
+
+    // Returns pointer to item of the current version or nullptr if not found. Pointer is
+    // invalidated when a new version is published
+    const Item* findItem(std::string_view name) const override;
+
+    // Returns pointer to item with the given GTIN or nullptr if not found
+    const Item* findItemByGtin(uint64_t gtin) const override;
+
+    // Return current epoch, which is the published version
+    uint64_t getEpoch() const override;
+
+private:
+    // Returns item built from a record read from version, dropping items of older versions first
+    const Item* materialize(const SharedCatalog::Record& record, std::string_view name, uint64_t version) const;
+
+private:
+    const SharedCatalog& mShared;   // Published catalog
+    mutable uint64_t mVersion;      // Version the items were built from
+    mutable std::unordered_map<std::string, Item, StringHash, std::equal_to<>> mItems; // Items built so far by name
+};
+
+#endif
@@ -3,7 +3,9 @@
 #include <iostream>
 #include <cmath>
 
-void Special::checkArgs(float& amount, float& price) const {
+namespace {
+// Correct arguments of calcPrice to ensure they are positive
+void correctArgs(float& amount, float& price) {
     if (amount < 0) {
         std::cerr << "Negative amount entered. Using absolute value" << std::endl;
         amount = fabs(amount);
@@ -14,6 +16,50 @@ void Special::checkArgs(float& amount, float& price) const {
     }
 }
 
+// BOGO X% off for items sold in whole units
+float calcBuyOneGetOneUnit(const SpecialParams& sp, float numItems, float price) {
+    return calcSpecialPrice<SpecialParams::Type_t::BuyOneGetOneUnit>(sp, numItems, price);
+}
+
+// BOGO X% off for items sold in weight units
+float calcBuyOneGetOneWeight(const SpecialParams& sp, float weight, float price) {
+    return calcSpecialPrice<SpecialParams::Type_t::BuyOneGetOneWeight>(sp, weight, price);
+}
+
+// N items for $X
+float calcNforX(const SpecialParams& sp, float numItems, float price) {
+    return calcSpecialPrice<SpecialParams::Type_t::NforX>(sp, numItems, price);
+}
+}
+
+bool SpecialParams::byUnit() const {
+    return Type_t::BuyOneGetOneUnit == type || Type_t::NforX == type;
+}
+
+bool SpecialParams::isValid() const {
+    switch (type) {
+        case Type_t::BuyOneGetOneUnit:   return static_cast<unsigned int>(needed) + static_cast<unsigned int>(receive) >= 1;
+        case Type_t::BuyOneGetOneWeight: return needed >= 0 && receive >= 0 && needed + receive >= kMinSpecialWeight;
+        case Type_t::NforX:              return static_cast<unsigned int>(needed) >= 1;
+        default:                         return true;
+    }
+}
+
+float SpecialParams::calcPrice(float numItems, float price) const {
+    correctArgs(numItems, price);
+
+    switch (type) {
+        case Type_t::BuyOneGetOneUnit:   return calcBuyOneGetOneUnit(*this, numItems, price);
+        case Type_t::BuyOneGetOneWeight: return calcBuyOneGetOneWeight(*this, numItems, price);
+        case Type_t::NforX:              return calcNforX(*this, numItems, price);
+        default:                         return price * numItems;
+    }
+}
+
+void Special::checkArgs(float& amount, float& price) const {
+    correctArgs(amount, price);
+}
+
 BuyOneGetOneUnit::BuyOneGetOneUnit(unsigned int needed, unsigned int receive, float percent, unsigned int limit) :
      mNeeded(needed), mReceive(receive), mLimit(limit)
 {
@@ -27,30 +73,16 @@ BuyOneGetOneUnit::BuyOneGetOneUnit(unsigned int needed, unsigned int receive, fl
 
 float BuyOneGetOneUnit::calcPrice(float numItems, float price) const {
     checkArgs(numItems, price);
+    return calcBuyOneGetOneUnit(getParams(), numItems, price);
+}
 
-    // Convert numItems to int
-    unsigned int numItemsInt = static_cast<unsigned int>(numItems);
-
-    // Determine how many are overlimit and remove those from special calculation
-    unsigned int overLimit = 0;
-    if (mLimit > 0 && numItemsInt > mLimit) {
-        overLimit = numItemsInt - mLimit;
-        numItemsInt -= overLimit;
-    }
-
-    // Find how many specials are applicable
-    unsigned int specials = numItemsInt / (mNeeded + mReceive);
-
-    // Retrieve leftover items
-    numItemsInt %= (mNeeded + mReceive);
-
-    // Apply deal to number of applicable specials
-    float total = specials * ((mNeeded * price) + mReceive * (price * (1 - mPercentOff)));
-
-    // Add leftover and overlimit items to total
-    total += (numItemsInt + overLimit) * price;
+SpecialParams BuyOneGetOneUnit::getParams() const {
+    return {SpecialParams::Type_t::BuyOneGetOneUnit, static_cast<float>(mNeeded), static_cast<float>(mReceive),
+            mPercentOff, static_cast<float>(mLimit)};
+}
 
-    return total;
+std::size_t BuyOneGetOneUnit::memoryBytes() const {
+    return sizeof(*this);
 }
 
 BuyOneGetOneWeight::BuyOneGetOneWeight(float needed, float receive, float percent, float limit) :
@@ -66,27 +98,15 @@ BuyOneGetOneWeight::BuyOneGetOneWeight(float needed, float receive, float percen
 
 float BuyOneGetOneWeight::calcPrice(float weight, float price) const {
     checkArgs(weight, price);
+    return calcBuyOneGetOneWeight(getParams(), weight, price);
+}
 
-    // Determine how much weight it overlimit and remove from special calculation
-    unsigned int overLimit = 0;
-    if (mLimit > 0 && weight > mLimit) {
-        overLimit = weight - mLimit;
-        weight -= overLimit;
-    }
-
-    float total = 0;
-    // Loop until no more applicable specials
-    while (weight > mNeeded) {
-        weight -= mNeeded;                                                      // Remove needed weight for special
-        float d_weight = (weight < mReceive) ? weight : mReceive;               // How much weight is available for discount?
-        total += (mNeeded * price) + (d_weight * price * (1 - mPercentOff));    // Calculate price total of current special
-        weight -= d_weight;                                                     // Remove discounted weight from total
-    }
-
-    // Add leftover weight to total
-    total += (weight + overLimit) * price;
+SpecialParams BuyOneGetOneWeight::getParams() const {
+    return {SpecialParams::Type_t::BuyOneGetOneWeight, mNeeded, mReceive, mPercentOff, mLimit};
+}
 
-    return total;
+std::size_t BuyOneGetOneWeight::memoryBytes() const {
+    return sizeof(*this);
 }
 
 NforX::NforX(unsigned int needed, float disc_price, unsigned int limit) :
@@ -95,21 +115,29 @@ NforX::NforX(unsigned int needed, float disc_price, unsigned int limit) :
 
 float NforX::calcPrice(float numItems, float price) const {
     checkArgs(numItems, price);
+    return calcNforX(getParams(), numItems, price);
+}
 
-    // Convert numItems to int
-    unsigned int numItemsInt = static_cast<unsigned int>(numItems);
+SpecialParams NforX::getParams() const {
+    return {SpecialParams::Type_t::NforX, static_cast<float>(mNeeded), 0, mDiscPrice, static_cast<float>(mLimit)};
+}
 
-    // Determine how many are overlimit and remove those from special calculation
-    unsigned int overLimit = 0;
-    if (mLimit > 0 && numItemsInt > mLimit) {
-        overLimit = numItemsInt - mLimit;
-        numItemsInt -= overLimit;
-    }
-    // Find how many specials are applicable
-    unsigned int specials = numItemsInt / mNeeded;
+std::size_t NforX::memoryBytes() const {
+    return sizeof(*this);
+}
 
-    // Retrieve leftover items
-    numItemsInt %= mNeeded;
+ParamsSpecial::ParamsSpecial(const SpecialParams& params) :
+    mParams(params)
+{}
 
-    return  specials * mDiscPrice + (numItemsInt + overLimit) * price;
-}
\ No newline at end of file
+float ParamsSpecial::calcPrice(float numItems, float price) const {
+    return mParams.calcPrice(numItems, price);
+}
+
+SpecialParams ParamsSpecial::getParams() const {
+    return mParams;
+}
+
+std::size_t ParamsSpecial::memoryBytes() const {
+    return sizeof(*this);
+}
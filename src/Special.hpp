@@ -1,6 +1,125 @@
 #ifndef __SPECIAL_HPP__
 #define __SPECIAL_HPP__
 
+#include <cstddef>
+#include <cstdint>
+
+// Plain description of a special. Lets a special be stored inline in a record instead of as a
+// heap allocated Special object
+struct SpecialParams {
+    enum class Type_t : uint8_t { None, BuyOneGetOneUnit, BuyOneGetOneWeight, NforX };
+
+    Type_t type = Type_t::None;
+    float needed = 0;   // Amount needed to receive the special
+    float receive = 0;  // Amount receiving the discount (BOGO only)
+    float value = 0;    // Percent off as decimal [0,1] for BOGO, overall price for NforX
+    float limit = 0;    // Limit on amount available per special. 0 = no limit
+
+    // Smallest weight one special of a BOGO by weight can cover, in pounds
+    static constexpr float kMinSpecialWeight = 0.01f;
+
+    // Returns total price of the items after the special, identical to Special::calcPrice of
+    // the described special. With no special the plain price is used
+    float calcPrice(float numItems, float price) const;
+
+    // Returns true if the special is for items sold by unit
+    bool byUnit() const;
+
+    // Returns false if pricing with the special would divide by zero or make no sense, i.e. an
+    // N for X without N, a BOGO by unit that needs and receives nothing or a BOGO by weight
+    // with a negative weight or covering less than kMinSpecialWeight
+    bool isValid() const;
+};
+
+// Price of amount items after a special of a type known at compile time. Shared by the Special
+// classes and catalogs generated at build time, so both price identically. Amount and price
+// must not be negative
+template <SpecialParams::Type_t Type>
+constexpr float calcSpecialPrice(const SpecialParams& sp, float amount, float price) {
+    if constexpr (SpecialParams::Type_t::BuyOneGetOneUnit == Type) {
+        const unsigned int needed = static_cast<unsigned int>(sp.needed);
+        const unsigned int receive = static_cast<unsigned int>(sp.receive);
+        const unsigned int limit = static_cast<unsigned int>(sp.limit);
+
+        // Convert numItems to int
+        unsigned int numItemsInt = static_cast<unsigned int>(amount);
+
+        // Determine how many are overlimit and remove those from special calculation
+        unsigned int overLimit = 0;
+        if (limit > 0 && numItemsInt > limit) {
+            overLimit = numItemsInt - limit;
+            numItemsInt -= overLimit;
+        }
+
+        // Find how many specials are applicable
+        unsigned int specials = numItemsInt / (needed + receive);
+
+        // Retrieve leftover items
+        numItemsInt %= (needed + receive);
+
+        // Apply deal to number of applicable specials
+        float total = specials * ((needed * price) + receive * (price * (1 - sp.value)));
+
+        // Add leftover and overlimit items to total
+        total += (numItemsInt + overLimit) * price;
+
+        return total;
+    } else if constexpr (SpecialParams::Type_t::BuyOneGetOneWeight == Type) {
+        float weight = amount;
+
+        // Determine how much weight it overlimit and remove from special calculation
+        unsigned int overLimit = 0;
+        if (sp.limit > 0 && weight > sp.limit) {
+            overLimit = weight - sp.limit;
+            weight -= overLimit;
+        }
+
+        // Count whole specials directly rather than subtracting one special at a time, which
+        // takes long for small specials and never ends once needed is below the float step
+        // of the weight
+        const double cycle = static_cast<double>(sp.needed) + sp.receive;
+        if (!(cycle > 0) || sp.needed < 0 || sp.receive < 0) {
+            return (weight + overLimit) * price;
+        }
+        const double specials = static_cast<double>(static_cast<uint64_t>(weight / cycle));
+        double rest = weight - specials * cycle;
+        double total = specials * ((sp.needed * price) + (sp.receive * price * (1 - sp.value)));
+
+        // A partial special discounts whatever is left past the needed weight
+        if (rest > sp.needed) {
+            total += (sp.needed * price) + ((rest - sp.needed) * price * (1 - sp.value));
+            rest = 0;
+        }
+
+        // Add leftover weight to total
+        total += (rest + overLimit) * price;
+
+        return static_cast<float>(total);
+    } else if constexpr (SpecialParams::Type_t::NforX == Type) {
+        const unsigned int needed = static_cast<unsigned int>(sp.needed);
+        const unsigned int limit = static_cast<unsigned int>(sp.limit);
+
+        // Convert numItems to int
+        unsigned int numItemsInt = static_cast<unsigned int>(amount);
+
+        // Determine how many are overlimit and remove those from special calculation
+        unsigned int overLimit = 0;
+        if (limit > 0 && numItemsInt > limit) {
+            overLimit = numItemsInt - limit;
+            numItemsInt -= overLimit;
+        }
+        // Find how many specials are applicable
+        unsigned int specials = numItemsInt / needed;
+
+        // Retrieve leftover items
+        numItemsInt %= needed;
+
+        return  specials * sp.value + (numItemsInt + overLimit) * price;
+    } else {
+        return price * amount;
+    }
+}
+
 // Special abstract base class
 class Special {
 public:
@@ -10,6 +129,12 @@ public:
     // absolute value will be used
     virtual float calcPrice(float numItems, float price) const = 0;
 
+    // Returns plain description of the special
+    virtual SpecialParams getParams() const = 0;
+
+    // Returns bytes used by the special object
+    virtual std::size_t memoryBytes() const = 0;
+
 protected:
     // Correct arguments of calcPrice to ensure they are positive
     void checkArgs(float& numItems, float& price) const;
@@ -21,6 +146,8 @@ public:
     // Constructor. PercentOff must be between [0, 100] else a default of 0% off is used. Optional limit
     BuyOneGetOneUnit(unsigned int needed, unsigned int receive, float percent, unsigned int limit = 0);
     float calcPrice(float numItems, float price) const override;
+    SpecialParams getParams() const override;
+    std::size_t memoryBytes() const override;
 
 private:
     unsigned int mNeeded;   // Number of items needed to receive the special
@@ -36,6 +163,8 @@ public:
     // If needed or receive are negative the absolute value will be used.
     BuyOneGetOneWeight(float needed, float receive, float percent, float limit = 0);
     float calcPrice(float numItems, float price) const override;
+    SpecialParams getParams() const override;
+    std::size_t memoryBytes() const override;
 
 private:
     float mNeeded;   // Weight of items needed to receive the special
@@ -49,6 +178,8 @@ public:
     // Constructor. If price is negative absolute value will be used.
     NforX(unsigned int needed, float price, unsigned int limit = 0);
     float calcPrice(float numItems, float price) const override;
+    SpecialParams getParams() const override;
+    std::size_t memoryBytes() const override;
 
 private:
     unsigned int mNeeded; // Number of items needed to receive the special
@@ -56,4 +187,18 @@ private:
     unsigned int mLimit; // Limit on number of items available per special. 0 = no limit
 };
 
+// Special of any type rebuilt from its plain description. Prices exactly like the special the
+// description was taken from, for catalogs that store specials as SpecialParams
+class ParamsSpecial : public Special {
+public:
+    // Constructor
+    explicit ParamsSpecial(const SpecialParams& params);
+    float calcPrice(float numItems, float price) const override;
+    SpecialParams getParams() const override;
+    std::size_t memoryBytes() const override;
+
+private:
+    SpecialParams mParams; // Description of the special
+};
+
 #endif
\ No newline at end of file
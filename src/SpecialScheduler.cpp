@@ -0,0 +1,142 @@
+#include "SpecialScheduler.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <set>
+
+namespace {
+constexpr int64_t kSecondsPerDay = 24 * 60 * 60;
+
+// Returns start of the day containing time
+int64_t dayStart(int64_t time) {
+    int64_t day = time / kSecondsPerDay;
+    if (time % kSecondsPerDay < 0) {
+        --day;
+    }
+    return day * kSecondsPerDay;
+}
+}
+
+SpecialScheduler::SpecialScheduler(Reprice_t policy) :
+    mPolicy(policy), mWindows{}, mTimeline{}, mNext(0)
+{}
+
+bool SpecialScheduler::addWindow(const std::string& name, const std::shared_ptr<Special>& special, int64_t start, int64_t end) {
+    if (!special) {
+        std::cerr << "Window needs a special" << std::endl;
+        return false;
+    }
+    if (start >= end) {
+        std::cerr << "Window must start before it ends" << std::endl;
+        return false;
+    }
+
+    mWindows.push_back({name, special, start, end});
+    return true;
+}
+
+bool SpecialScheduler::addWeeklyWindow(const std::string& name, const std::shared_ptr<Special>& special, uint8_t days,
+                                       int32_t startOfDay, int32_t endOfDay, int64_t from, int64_t until) {
+    if (startOfDay < 0 || endOfDay > kSecondsPerDay || startOfDay >= endOfDay) {
+        std::cerr << "Invalid time of day for window" << std::endl;
+        return false;
+    }
+
+    // 1970-01-01 was a Thursday
+    for (int64_t day = dayStart(from); day < until; day += kSecondsPerDay) {
+        const int64_t weekday = ((day / kSecondsPerDay) % 7 + 11) % 7;
+        const int64_t start = day + startOfDay;
+        if ((days & (1U << weekday)) && start >= from && start < until &&
+            !addWindow(name, special, start, day + endOfDay)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SpecialScheduler::build(const ItemDatabase& db) {
+    // Windows by item in the order added, so later windows win ties
+    std::map<std::string, std::vector<const Window*>> byItem;
+    for (const auto& window : mWindows) {
+        const Item* item = db.findItem(window.name);
+        if (!item) {
+            std::cerr << "Item not found" << std::endl;
+            return false;
+        }
+        if (window.special->getParams().byUnit() != (Item::Sale_t::Unit == item->getSaleType())) {
+            std::cerr << "Special does not match sale type of item" << std::endl;
+            return false;
+        }
+        byItem[window.name].push_back(&window);
+    }
+
+    // Sweep the window starts and ends of each item in time order, keeping the windows active
+    // at the current time in a set ordered by start and then by order added, so the window
+    // that wins is always the last in the set
+    std::map<int64_t, CatalogDelta> timeline;
+    for (const auto& [name, windows] : byItem) {
+        struct Boundary {
+            int64_t time;
+            bool start;
+            std::size_t window;
+        };
+        std::vector<Boundary> boundaries;
+        boundaries.reserve(2 * windows.size());
+        for (std::size_t i = 0; i < windows.size(); ++i) {
+            boundaries.push_back({windows[i]->start, true, i});
+            boundaries.push_back({windows[i]->end, false, i});
+        }
+        std::sort(boundaries.begin(), boundaries.end(), [](const Boundary& a, const Boundary& b) { return a.time < b.time; });
+
+        const std::shared_ptr<Special>& base = db.findItem(name)->shareSpecial();
+        const Special* current = base.get();
+        std::set<std::pair<int64_t, std::size_t>> active;
+        for (std::size_t b = 0; b < boundaries.size();) {
+            const int64_t time = boundaries[b].time;
+            for (; b < boundaries.size() && boundaries[b].time == time; ++b) {
+                const std::pair<int64_t, std::size_t> key{windows[boundaries[b].window]->start, boundaries[b].window};
+                if (boundaries[b].start) {
+                    active.insert(key);
+                } else {
+                    active.erase(key);
+                }
+            }
+            const std::shared_ptr<Special>& special = active.empty() ? base : windows[active.rbegin()->second]->special;
+            if (special.get() != current) {
+                timeline[time].setItemSpecial(name, special);
+                current = special.get();
+            }
+        }
+    }
+
+    mTimeline.assign(std::make_move_iterator(timeline.begin()), std::make_move_iterator(timeline.end()));
+    mNext = 0;
+    return true;
+}
+
+std::size_t SpecialScheduler::advanceTo(ItemDatabase& db, int64_t now, const std::vector<Order*>& openOrders) {
+    std::size_t applied = 0;
+    while (mNext < mTimeline.size() && mTimeline[mNext].first <= now) {
+        if (db.applyDelta(mTimeline[mNext].second)) {
+            ++applied;
+        }
+        ++mNext;
+    }
+
+    if (applied > 0 && Reprice_t::KeepScanned != mPolicy) {
+        for (Order* order : openOrders) {
+            order->Reprice(Reprice_t::RepriceIfLower == mPolicy);
+        }
+    }
+    return applied;
+}
+
+int64_t SpecialScheduler::getNextTransition() const {
+    return (mNext < mTimeline.size()) ? mTimeline[mNext].first : std::numeric_limits<int64_t>::max();
+}
+
+std::size_t SpecialScheduler::getNumTransitions() const {
+    return mTimeline.size();
+}
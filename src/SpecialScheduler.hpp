@@ -0,0 +1,77 @@
+#ifndef __SPECIALSCHEDULER_HPP__
+#define __SPECIALSCHEDULER_HPP__
+
+#include "CatalogDelta.hpp"
+#include "ItemDatabase.hpp"
+#include "Order.hpp"
+#include "Special.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Specials that are only valid during time windows, such as happy hours or weekend deals.
+// build() turns all windows into a timeline of transitions ahead of time, with one
+// CatalogDelta per point in time at which any active special changes. advanceTo() applies
+// the transitions that are due to the database, each as a single epoch, so scanning never
+// looks at the clock or at the windows.
+//
+// Times are seconds since the epoch in the store's local time.
+class SpecialScheduler {
+public:
+    // What happens to items already in open orders when specials change
+    enum class Reprice_t {
+        KeepScanned,    // Lines keep their price until the item is scanned or removed again
+        RepriceAll,     // All lines get the new pricing
+        RepriceIfLower  // Only lines that get cheaper are repriced
+    };
+
+    // Constructor
+    explicit SpecialScheduler(Reprice_t policy = Reprice_t::KeepScanned);
+
+    // Add a window [start, end) during which the item has the special. When windows of an item
+    // overlap the one starting last is used. Special must not be null and start must be before
+    // end. Returns status of operation
+    bool addWindow(const std::string& name, const std::shared_ptr<Special>& special, int64_t start, int64_t end);
+
+    // Add a window from startOfDay to endOfDay (seconds after midnight) on every day in days
+    // (bit 0 = Sunday) that starts in [from, until). Returns status of operation
+    bool addWeeklyWindow(const std::string& name, const std::shared_ptr<Special>& special, uint8_t days,
+                         int32_t startOfDay, int32_t endOfDay, int64_t from, int64_t until);
+
+    // Precompute the timeline of transitions. Outside of their windows items keep the special
+    // they have in the database now. That special is captured here, so if it is changed later,
+    // e.g. by a catalog delta, build again or windows that end restore the old one. Items must
+    // exist and specials must match their sale type. Returns status of operation
+    bool build(const ItemDatabase& db);
+
+    // Apply all transitions due at time now to the database and reprice the open orders by the
+    // policy. Returns number of transitions applied
+    std::size_t advanceTo(ItemDatabase& db, int64_t now, const std::vector<Order*>& openOrders = {});
+
+    // Return time of the next transition or INT64_MAX if there is none
+    int64_t getNextTransition() const;
+
+    // Return number of transitions in the timeline
+    std::size_t getNumTransitions() const;
+
+private:
+    // Special valid during [start, end)
+    struct Window {
+        std::string name;
+        std::shared_ptr<Special> special;
+        int64_t start;
+        int64_t end;
+    };
+
+private:
+    Reprice_t mPolicy;                                      // Repricing of open orders
+    std::vector<Window> mWindows;                           // All windows in the order added
+    std::vector<std::pair<int64_t, CatalogDelta>> mTimeline; // Changes by time of transition
+    std::size_t mNext;                                      // Next transition to apply
+};
+
+#endif
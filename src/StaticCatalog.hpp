@@ -0,0 +1,245 @@
+#ifndef __STATICCATALOG_HPP__
+#define __STATICCATALOG_HPP__
+
+#include "Item.hpp"
+#include "Special.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string_view>
+
+// Item of a catalog generated at build time by catalog_codegen
+struct StaticItem {
+    std::string_view name;  // Item name
+    Item::Sale_t saleType;  // Sale type
+    float price;            // Price in dollars per unit or per pound
+    float markdown;         // Amount in dollars to lower price
+    uint64_t gtin;          // Barcode number. 0 = none
+    uint8_t taxCategory;    // Tax category
+    SpecialParams special;  // Special if type is not None
+};
+
+// GTIN of a generated catalog and the position of its item
+struct StaticGtin {
+    uint64_t gtin;
+    uint32_t item;
+};
+
+// Order priced against a catalog generated at build time for kiosks with a fixed catalog.
+// Catalog is a type written by catalog_codegen holding
+//   static constexpr std::array<StaticItem, N> kItems;  items sorted by name
+//   static constexpr std::array<StaticGtin, M> kGtins;  GTINs sorted by number
+// Nothing is built at startup, the order lives in fixed arrays and specials are priced by
+// calcSpecialPrice of their type instead of through virtual calls. Items named at compile
+// time with ScanItem<indexOf("name")>() are priced fully inline.
+template <typename Catalog>
+class StaticOrder {
+public:
+    static constexpr std::size_t kNumItems = Catalog::kItems.size();
+    static constexpr std::size_t kNotFound = SIZE_MAX; // Position of items not in the catalog
+
+    // Returns position of item in the catalog or kNotFound
+    static constexpr std::size_t indexOf(std::string_view name) {
+        std::size_t lo = 0, hi = kNumItems;
+        while (lo < hi) {
+            const std::size_t mid = lo + (hi - lo) / 2;
+            if (Catalog::kItems[mid].name < name) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return (lo < kNumItems && Catalog::kItems[lo].name == name) ? lo : kNotFound;
+    }
+
+    // Returns position of the item with the given GTIN in the catalog or kNotFound
+    static constexpr std::size_t indexOfGtin(uint64_t gtin) {
+        std::size_t lo = 0, hi = Catalog::kGtins.size();
+        while (lo < hi) {
+            const std::size_t mid = lo + (hi - lo) / 2;
+            if (Catalog::kGtins[mid].gtin < gtin) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return (lo < Catalog::kGtins.size() && Catalog::kGtins[lo].gtin == gtin) ? Catalog::kGtins[lo].item : kNotFound;
+    }
+
+    // Return total price of the order
+    float getTotalPrice() const {
+        return mTotalPrice;
+    }
+
+    // Return amount saved on the order through markdowns and specials compared to the regular price
+    float getSavings() const {
+        return mRegularPrice - mTotalPrice;
+    }
+
+    // Return number of distinct items in the order
+    std::size_t getNumLines() const {
+        return mNumLines;
+    }
+
+    // Return quantity or weight of an item in the order
+    float getAmount(std::string_view name) const {
+        const std::size_t index = indexOf(name);
+        return (index != kNotFound) ? mAmounts[index] : 0;
+    }
+
+    // Scans item by unit into cart. Same rules as Order::ScanItem
+    bool ScanItem(std::string_view name) {
+        return scan(indexOf(name), Item::Sale_t::Unit, 1);
+    }
+
+    // Scans item by weight into cart. Same rules as Order::ScanItem
+    bool ScanItem(std::string_view name, float weight) {
+        return scan(indexOf(name), Item::Sale_t::Weight, weight);
+    }
+
+    // Scans item by unit using its GTIN barcode number
+    bool ScanBarcode(uint64_t gtin) {
+        return scan(indexOfGtin(gtin), Item::Sale_t::Unit, 1);
+    }
+
+    // Scans item by weight using its GTIN barcode number
+    bool ScanBarcode(uint64_t gtin, float weight) {
+        return scan(indexOfGtin(gtin), Item::Sale_t::Weight, weight);
+    }
+
+    // Scans the item at position Index by unit. The item and its special are known at compile
+    // time, so the price is computed without any lookup or dispatch
+    template <std::size_t Index>
+    bool ScanItem() {
+        static_assert(Index < kNumItems, "Item not in catalog");
+        static_assert(Item::Sale_t::Unit == Catalog::kItems[Index].saleType, "Item not sold by unit");
+        updateLine(Index, mAmounts[Index] + 1, calcLinePrice<Index>(mAmounts[Index] + 1));
+        return true;
+    }
+
+    // Scans weight of the item at position Index. Weight must be > 0
+    template <std::size_t Index>
+    bool ScanItem(float weight) {
+        static_assert(Index < kNumItems, "Item not in catalog");
+        static_assert(Item::Sale_t::Weight == Catalog::kItems[Index].saleType, "Item not sold by weight");
+        if (weight <= 0) {
+            std::cerr << "Weight must be positive and non-zero" << std::endl;
+            return false;
+        }
+        updateLine(Index, mAmounts[Index] + weight, calcLinePrice<Index>(mAmounts[Index] + weight));
+        return true;
+    }
+
+    // Removes item from cart by quantity. Same rules as Order::RemoveItem
+    bool RemoveItem(std::string_view name, unsigned int qty) {
+        return remove(indexOf(name), Item::Sale_t::Unit, static_cast<float>(qty));
+    }
+
+    // Removes item from cart by weight. Same rules as Order::RemoveItem
+    bool RemoveItem(std::string_view name, float weight) {
+        return remove(indexOf(name), Item::Sale_t::Weight, weight);
+    }
+
+private:
+    // Returns price of amount of the item at position Index
+    template <std::size_t Index>
+    static constexpr float calcLinePrice(float amount) {
+        constexpr StaticItem item = Catalog::kItems[Index];
+        return calcSpecialPrice<item.special.type>(item.special, amount, item.price - item.markdown);
+    }
+
+    // Returns price of amount of the item at position index
+    static float calcLinePrice(std::size_t index, float amount) {
+        const StaticItem& item = Catalog::kItems[index];
+        const float price = item.price - item.markdown;
+        switch (item.special.type) {
+            case SpecialParams::Type_t::BuyOneGetOneUnit:
+                return calcSpecialPrice<SpecialParams::Type_t::BuyOneGetOneUnit>(item.special, amount, price);
+            case SpecialParams::Type_t::BuyOneGetOneWeight:
+                return calcSpecialPrice<SpecialParams::Type_t::BuyOneGetOneWeight>(item.special, amount, price);
+            case SpecialParams::Type_t::NforX:
+                return calcSpecialPrice<SpecialParams::Type_t::NforX>(item.special, amount, price);
+            default:
+                return calcSpecialPrice<SpecialParams::Type_t::None>(item.special, amount, price);
+        }
+    }
+
+    // Set amount and price of the line of the item at position index and update the order
+    // totals. The regular price follows the whole line, as in Order
+    void updateLine(std::size_t index, float amount, float price) {
+        if (mAmounts[index] == 0 && amount > 0) {
+            ++mNumLines;
+        } else if (mAmounts[index] > 0 && amount == 0) {
+            --mNumLines;
+        }
+        const float regularPrice = Catalog::kItems[index].price;
+        mTotalPrice += price - mLinePrices[index];
+        mRegularPrice += regularPrice * amount - regularPrice * mAmounts[index];
+        mAmounts[index] = amount;
+        mLinePrices[index] = price;
+    }
+
+    // Add amount of the item at position index to the cart. Item must be sold by saleType
+    bool scan(std::size_t index, Item::Sale_t saleType, float amount) {
+        // Weight must be positive and non zero
+        if (amount <= 0) {
+            std::cerr << "Weight must be positive and non-zero" << std::endl;
+            return false;
+        }
+
+        // Item must be in catalog
+        if (index == kNotFound) {
+            std::cerr << "Item not in database" << std::endl;
+            return false;
+        }
+
+        // Item must be sold by the requested sale type
+        if (saleType != Catalog::kItems[index].saleType) {
+            std::cerr << ((Item::Sale_t::Unit == saleType) ? "Item not sold by unit" : "Item not sold by weight") << std::endl;
+            return false;
+        }
+
+        updateLine(index, mAmounts[index] + amount, calcLinePrice(index, mAmounts[index] + amount));
+        return true;
+    }
+
+    // Remove amount of the item at position index from the cart. Excess is ignored
+    bool remove(std::size_t index, Item::Sale_t saleType, float amount) {
+        // Item must be in order
+        if (index == kNotFound || mAmounts[index] == 0) {
+            std::cerr << "Item not found in order" << std::endl;
+            return false;
+        }
+
+        // Item must be sold by the requested sale type
+        if (saleType != Catalog::kItems[index].saleType) {
+            std::cerr << ((Item::Sale_t::Unit == saleType) ? "Item not sold by unit" : "Item not sold by weight") << std::endl;
+            return false;
+        }
+
+        // Amount must be positive
+        if (amount <= 0) {
+            std::cerr << "Removal quantity must be greater than zero" << std::endl;
+            return false;
+        }
+
+        if (amount >= mAmounts[index]) {
+            // Remove item fully from cart
+            updateLine(index, 0, 0);
+        } else {
+            updateLine(index, mAmounts[index] - amount, calcLinePrice(index, mAmounts[index] - amount));
+        }
+        return true;
+    }
+
+private:
+    std::array<float, kNumItems> mAmounts = {};     // Quantity or weight of each item in the cart
+    std::array<float, kNumItems> mLinePrices = {};  // Price of each line
+    float mTotalPrice = 0;              // Price of order
+    float mRegularPrice = 0;            // Price of order at regular item prices
+    std::size_t mNumLines = 0;          // Number of items in the cart
+};
+
+#endif
@@ -0,0 +1,216 @@
+#include "StoreCatalog.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+StoreCatalog::StoreCatalog(std::shared_ptr<const ItemDatabase> base) :
+    mBase(std::move(base)), mOverrides{}, mFilter(1, 0), mEpoch(0)
+{}
+
+const Item* StoreCatalog::findItem(std::string_view name) const {
+    if (mayBeOverridden(name)) {
+        auto it = mOverrides.find(name);
+        if (it != mOverrides.end()) {
+            return &it->second.item;
+        }
+    }
+    return mBase->findItem(name);
+}
+
+const Item* StoreCatalog::findItemByGtin(uint64_t gtin) const {
+    const Item* item = mBase->findItemByGtin(gtin);
+    if (item && mayBeOverridden(item->getName())) {
+        auto it = mOverrides.find(item->getName());
+        if (it != mOverrides.end()) {
+            return &it->second.item;
+        }
+    }
+    return item;
+}
+
+uint64_t StoreCatalog::getEpoch() const {
+    return mEpoch;
+}
+
+bool StoreCatalog::setItemPrice(std::string_view name, float price) {
+    ++mEpoch;
+    Override* entry = getOverride(name);
+    if (!entry) {
+        return false;
+    }
+
+    if (!entry->item.setPrice(price)) {
+        dropIfUnused(name);
+        return false;
+    }
+    entry->fields |= Override::PriceField;
+    entry->price = price;
+    return true;
+}
+
+bool StoreCatalog::setItemMarkdown(std::string_view name, float markdown) {
+    ++mEpoch;
+    Override* entry = getOverride(name);
+    if (!entry) {
+        return false;
+    }
+
+    if (!entry->item.setMarkdown(markdown)) {
+        dropIfUnused(name);
+        return false;
+    }
+    entry->fields |= Override::MarkdownField;
+    entry->markdown = markdown;
+    return true;
+}
+
+bool StoreCatalog::setItemSpecial(std::string_view name, const std::shared_ptr<Special>& special) {
+    ++mEpoch;
+    Override* entry = getOverride(name);
+    if (!entry) {
+        return false;
+    }
+
+    if (special && special->getParams().byUnit() != (Item::Sale_t::Unit == entry->item.getSaleType())) {
+        std::cerr << "Special does not match sale type of item" << std::endl;
+        dropIfUnused(name);
+        return false;
+    }
+    if (special && !special->getParams().isValid()) {
+        std::cerr << "Special needs a positive amount" << std::endl;
+        dropIfUnused(name);
+        return false;
+    }
+    entry->item.setSpecial(special);
+    entry->fields |= Override::SpecialField;
+    entry->special = special;
+    return true;
+}
+
+bool StoreCatalog::resetItem(std::string_view name) {
+    ++mEpoch;
+    auto it = mOverrides.find(name);
+    if (it == mOverrides.end()) {
+        return false;
+    }
+
+    // Stale filter bits only cost an extra lookup, so the filter is left alone
+    mOverrides.erase(it);
+    return true;
+}
+
+void StoreCatalog::setBase(std::shared_ptr<const ItemDatabase> base) {
+    ++mEpoch;
+    mBase = std::move(base);
+    for (auto it = mOverrides.begin(); it != mOverrides.end();) {
+        const Item* item = mBase->findItem(it->first);
+        if (!item) {
+            it = mOverrides.erase(it);
+            continue;
+        }
+
+        Item updated = *item;
+        if (!applyFields(it->second, updated)) {
+            std::cerr << "Store override of " << it->first << " no longer valid" << std::endl;
+        }
+        it->second.item = std::move(updated);
+        ++it;
+    }
+    rebuildFilter();
+}
+
+const ItemDatabase& StoreCatalog::getBase() const {
+    return *mBase;
+}
+
+std::size_t StoreCatalog::getNumOverrides() const {
+    return mOverrides.size();
+}
+
+std::size_t StoreCatalog::memoryBytes() const {
+    // Each override is a hash node holding the key, the item copy and its name
+    std::size_t bytes = sizeof(*this) + mFilter.capacity() * sizeof(uint64_t) + mOverrides.bucket_count() * sizeof(void*);
+    for (const auto& entry : mOverrides) {
+        bytes += sizeof(void*) + sizeof(std::size_t) + sizeof(entry) + entry.first.capacity() + entry.second.item.getName().capacity();
+    }
+    return bytes;
+}
+
+uint64_t StoreCatalog::filterHash(std::string_view name) {
+    uint64_t head = 0, tail = 0;
+    const std::size_t n = std::min<std::size_t>(name.size(), 8);
+    std::memcpy(&head, name.data(), n);
+    std::memcpy(&tail, name.data() + name.size() - n, n);
+    uint64_t hash = (head ^ (tail * 0x9e3779b97f4a7c15ULL)) + name.size();
+    hash ^= hash >> 31;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 29;
+    return hash;
+}
+
+uint64_t StoreCatalog::filterBits(uint64_t hash) {
+    return (uint64_t(1) << (hash >> 58)) | (uint64_t(1) << ((hash >> 52) & 63));
+}
+
+bool StoreCatalog::mayBeOverridden(std::string_view name) const {
+    const uint64_t hash = filterHash(name);
+    const uint64_t bits = filterBits(hash);
+    return (mFilter[hash & (mFilter.size() - 1)] & bits) == bits;
+}
+
+StoreCatalog::Override* StoreCatalog::getOverride(std::string_view name) {
+    auto it = mOverrides.find(name);
+    if (it != mOverrides.end()) {
+        return &it->second;
+    }
+
+    const Item* item = mBase->findItem(name);
+    if (!item) {
+        std::cerr << "Item not found" << std::endl;
+        return nullptr;
+    }
+    it = mOverrides.emplace(std::string(name), Override{*item, 0, 0, 0, nullptr}).first;
+
+    // Keep about 16 filter bits per override so few lookups of other items reach the map
+    if (mOverrides.size() * 16 > mFilter.size() * 64) {
+        rebuildFilter();
+    } else {
+        const uint64_t hash = filterHash(name);
+        mFilter[hash & (mFilter.size() - 1)] |= filterBits(hash);
+    }
+    return &it->second;
+}
+
+void StoreCatalog::dropIfUnused(std::string_view name) {
+    auto it = mOverrides.find(name);
+    if (it != mOverrides.end() && it->second.fields == 0) {
+        mOverrides.erase(it);
+    }
+}
+
+bool StoreCatalog::applyFields(const Override& entry, Item& item) {
+    bool ok = true;
+    if (entry.fields & Override::PriceField) {
+        ok = item.setPrice(entry.price) && ok;
+    }
+    if (entry.fields & Override::MarkdownField) {
+        ok = item.setMarkdown(entry.markdown) && ok;
+    }
+    if (entry.fields & Override::SpecialField) {
+        item.setSpecial(entry.special);
+    }
+    return ok;
+}
+
+void StoreCatalog::rebuildFilter() {
+    std::size_t words = 1;
+    while (words * 64 < mOverrides.size() * 16) {
+        words *= 2;
+    }
+    mFilter.assign(words * 2, 0);
+    for (const auto& entry : mOverrides) {
+        const uint64_t hash = filterHash(entry.first);
+        mFilter[hash & (mFilter.size() - 1)] |= filterBits(hash);
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef __STORECATALOG_HPP__
+#define __STORECATALOG_HPP__
+
+#include "ItemCatalog.hpp"
+#include "ItemDatabase.hpp"
+#include "StringHash.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Catalog of a single store layered on a chain catalog. The chain ItemDatabase is shared
+// between all stores and never copied; a store only holds the items it overrides the price,
+// markdown or special of. Lookups first test a small bit filter over the overridden names,
+// so items the store does not override cost one extra cheap check on top of the chain lookup.
+class StoreCatalog : public ItemCatalog {
+public:
+    // Constructor. Base must not be modified while shared, swap in a new base with setBase
+    explicit StoreCatalog(std::shared_ptr<const ItemDatabase> base);
+
+    // Returns pointer to item as seen by the store or nullptr if not found. Pointer is
+    // invalidated when the item is overridden or reset, or the base is replaced
+    const Item* findItem(std::string_view name) const override;
+
+    // Returns pointer to item with the given GTIN as seen by the store or nullptr if not found
+    const Item* findItemByGtin(uint64_t gtin) const override;
+
+    // Return current epoch. Incremented by every change of the store overrides or base
+    uint64_t getEpoch() const override;
+
+    // Override the price of an item in this store. Same rules as ItemDatabase::setItemPrice
+    bool setItemPrice(std::string_view name, float price);
+
+    // Override the markdown of an item in this store. Same rules as ItemDatabase::setItemMarkdown
+    bool setItemMarkdown(std::string_view name, float markdown);
+
+    // Override the special of an item in this store, or nullptr to have no special in this
+    // store. Special must match the sale type of the item. Returns status of operation
+    bool setItemSpecial(std::string_view name, const std::shared_ptr<Special>& special);
+
+    // Remove all overrides of an item. Returns false if the item was not overridden
+    bool resetItem(std::string_view name);
+
+    // Replace the chain catalog. Overrides are applied on top of the new base, overrides of
+    // items no longer in it are dropped
+    void setBase(std::shared_ptr<const ItemDatabase> base);
+
+    // Return the chain catalog
+    const ItemDatabase& getBase() const;
+
+    // Return number of overridden items
+    std::size_t getNumOverrides() const;
+
+    // Return bytes used by the store on top of the shared base
+    std::size_t memoryBytes() const;
+
+private:
+    // Fields of an item set by the store, and the item with them applied to the base item
+    struct Override {
+        enum Field_t : uint8_t { PriceField = 1, MarkdownField = 2, SpecialField = 4 };
+
+        Item item;                          // Base item with the overrides applied
+        uint8_t fields;                     // Overridden fields
+        float price;                        // Store price
+        float markdown;                     // Store markdown
+        std::shared_ptr<Special> special;   // Store special
+    };
+
+    // Returns hash of name used by the filter. Reads only the length and the first and last
+    // eight characters so checking the filter stays cheap
+    static uint64_t filterHash(std::string_view name);
+
+    // Returns filter bits of a hash within its filter word
+    static uint64_t filterBits(uint64_t hash);
+
+    // Returns false if name is surely not overridden
+    bool mayBeOverridden(std::string_view name) const;
+
+    // Returns override of an item, creating it from the base item if needed. Returns nullptr
+    // if the item is not in the base
+    Override* getOverride(std::string_view name);
+
+    // Remove the override of an item if it has no overridden fields
+    void dropIfUnused(std::string_view name);
+
+    // Apply the overridden fields of an override to item. Returns status of operation
+    static bool applyFields(const Override& entry, Item& item);
+
+    // Rebuild the filter from the overridden names
+    void rebuildFilter();
+
+private:
+    std::shared_ptr<const ItemDatabase> mBase;  // Shared chain catalog
+    std::unordered_map<std::string, Override, StringHash, std::equal_to<>> mOverrides; // Overrides by item name
+    std::vector<uint64_t> mFilter;              // Blocked bit filter over overridden names. Size is a power of two
+    uint64_t mEpoch;                            // Number of changes of the store catalog
+};
+
+#endif
@@ -0,0 +1,125 @@
+#include "StoreWorkload.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <numeric>
+
+namespace {
+// Words used to give item names realistic and varying lengths
+const char* const kAdjectives[] = { "Fresh", "Organic", "Classic", "Family Size", "Low Fat", "Extra Large", "Smoked", "Whole Grain" };
+const char* const kNouns[] = { "Apples", "Chicken Breast", "Tomato Soup", "Cheddar", "Potato Chips", "Ground Coffee", "Salmon", "Bagels" };
+
+// Returns value rounded to cents
+float toCents(double value) {
+    return static_cast<float>(std::round(value * 100) / 100);
+}
+}
+
+StoreWorkload::StoreWorkload(const Params& params) :
+    mParams(params), mNames{}, mTypes{}, mPopularity{}, mByRank{}
+{
+    std::mt19937_64 rng(mParams.seed);
+    std::bernoulli_distribution byWeight(mParams.weightShare);
+
+    mNames.reserve(mParams.numItems);
+    mTypes.reserve(mParams.numItems);
+    for (std::size_t i = 0; i < mParams.numItems; ++i) {
+        // Draws are sequenced explicitly so the workload does not depend on evaluation order
+        const char* adjective = kAdjectives[rng() % std::size(kAdjectives)];
+        const char* noun = kNouns[rng() % std::size(kNouns)];
+        mNames.push_back(std::string(adjective) + " " + noun + " " + std::to_string(i));
+        mTypes.push_back(byWeight(rng) ? Item::Sale_t::Weight : Item::Sale_t::Unit);
+    }
+
+    // Popularity of rank r is proportional to 1 / r^s. Ranks are shuffled over the items so hot
+    // items are not simply the ones inserted first
+    mPopularity.resize(mParams.numItems);
+    double total = 0;
+    for (std::size_t r = 0; r < mParams.numItems; ++r) {
+        total += 1 / std::pow(static_cast<double>(r + 1), mParams.zipfExponent);
+        mPopularity[r] = total;
+    }
+    for (auto& p : mPopularity) {
+        p /= total;
+    }
+    mByRank.resize(mParams.numItems);
+    std::iota(mByRank.begin(), mByRank.end(), 0);
+    std::shuffle(mByRank.begin(), mByRank.end(), rng);
+}
+
+bool StoreWorkload::fillCatalog(ItemDatabase& db) const {
+    std::mt19937_64 rng(mParams.seed ^ 0x5deece66dULL);
+    std::lognormal_distribution<double> unitPrice(1.0, 0.7);
+    std::uniform_real_distribution<double> uniform(0, 1);
+
+    db.reserve(db.getItems().size() + mParams.numItems);
+    for (std::size_t i = 0; i < mParams.numItems; ++i) {
+        const float price = std::max(toCents(unitPrice(rng)), 0.25f);
+        Item item(mNames[i], mTypes[i], price);
+        if (uniform(rng) < mParams.markdownShare) {
+            item.setMarkdown(toCents(price * (0.1 + 0.2 * uniform(rng))));
+        }
+
+        // Specials take consecutive slices of [0, 1) so their shares dont overlap
+        const double pick = uniform(rng);
+        if (Item::Sale_t::Unit == mTypes[i]) {
+            if (pick < mParams.bogoUnitShare) {
+                const unsigned int needed = 1 + rng() % 2;
+                const float percent = (rng() % 2) ? 100 : 50;
+                const unsigned int limit = (rng() % 2) ? 0 : 4;
+                item.setSpecial(std::make_shared<BuyOneGetOneUnit>(needed, 1, percent, limit));
+            } else if (pick < mParams.bogoUnitShare + mParams.nforxShare) {
+                const unsigned int needed = 2 + rng() % 4;
+                item.setSpecial(std::make_shared<NforX>(needed, toCents(needed * price * 0.8)));
+            }
+        } else if (pick < mParams.bogoWeightShare) {
+            item.setSpecial(std::make_shared<BuyOneGetOneWeight>(static_cast<float>(1 + rng() % 2), 1, 50));
+        }
+
+        if (!db.insertItem(item)) {
+            return false;
+        }
+    }
+    return db.finalize();
+}
+
+void StoreWorkload::generateBasket(std::mt19937_64& rng, std::vector<Action>& out) const {
+    out.clear();
+    if (mParams.numItems == 0) {
+        return;
+    }
+
+    // Log-normal basket size with the requested mean
+    const double sigma = 0.7;
+    std::lognormal_distribution<double> basketSize(std::log(std::max(mParams.meanBasketSize, 1.0)) - sigma * sigma / 2, sigma);
+    std::uniform_real_distribution<double> uniform(0, 1);
+
+    const std::size_t scans = std::max<std::size_t>(1, static_cast<std::size_t>(std::lround(basketSize(rng))));
+    for (std::size_t i = 0; i < scans; ++i) {
+        const uint32_t item = drawItem(rng);
+        const float weight = (Item::Sale_t::Weight == mTypes[item]) ? toCents(0.2 + 2.8 * uniform(rng)) : 0;
+        out.push_back({Action::Type_t::Scan, item, weight});
+        if (uniform(rng) < mParams.voidRate) {
+            out.push_back({Action::Type_t::Remove, item, weight});
+        }
+    }
+}
+
+const std::string& StoreWorkload::getName(uint32_t item) const {
+    return mNames[item];
+}
+
+Item::Sale_t StoreWorkload::getSaleType(uint32_t item) const {
+    return mTypes[item];
+}
+
+const StoreWorkload::Params& StoreWorkload::getParams() const {
+    return mParams;
+}
+
+uint32_t StoreWorkload::drawItem(std::mt19937_64& rng) const {
+    const double u = std::uniform_real_distribution<double>(0, 1)(rng);
+    const std::size_t rank = std::lower_bound(mPopularity.begin(), mPopularity.end(), u) - mPopularity.begin();
+    return mByRank[std::min(rank, mByRank.size() - 1)];
+}
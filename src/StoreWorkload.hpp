@@ -0,0 +1,72 @@
+#ifndef __STOREWORKLOAD_HPP__
+#define __STOREWORKLOAD_HPP__
+
+#include "ItemDatabase.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Synthetic store traffic for load testing. Generates a catalog with a mix of unit and weight
+// items, markdowns and specials, and baskets whose items follow a Zipf popularity curve, with
+// log-normal basket sizes and occasional voided scans. Everything is derived from a seed so
+// runs can be repeated with the same standard library. The standard distributions and shuffle
+// are implementation defined, so other libraries generate a different workload from a seed.
+class StoreWorkload {
+public:
+    // Shape of the catalog and the traffic
+    struct Params {
+        std::size_t numItems = 50000;   // Number of items in the catalog. Must not be 0
+        double zipfExponent = 1.0;      // Skew of item popularity. 0 = all items equally popular
+        double meanBasketSize = 25;     // Average number of scans per basket
+        double weightShare = 0.15;      // Share of items sold by weight
+        double voidRate = 0.02;         // Share of scans voided right after
+        double markdownShare = 0.10;    // Share of items with a markdown
+        double bogoUnitShare = 0.05;    // Share of unit items with a BOGO special
+        double nforxShare = 0.05;       // Share of unit items with an NforX special
+        double bogoWeightShare = 0.05;  // Share of weight items with a BOGO special
+        uint64_t seed = 1;              // Seed of the catalog and of all baskets
+    };
+
+    // Step of a basket
+    struct Action {
+        enum class Type_t { Scan, Remove };
+
+        Type_t type;
+        uint32_t item;  // Position of item in the catalog
+        float weight;   // Weight scanned or removed. 0 for items sold by unit
+    };
+
+    // Constructor. Builds the item names and popularity curve
+    explicit StoreWorkload(const Params& params);
+
+    // Insert the catalog items into db. Returns status of operation
+    bool fillCatalog(ItemDatabase& db) const;
+
+    // Replace out with the actions of the next basket drawn from rng
+    void generateBasket(std::mt19937_64& rng, std::vector<Action>& out) const;
+
+    // Returns name of the item at position item
+    const std::string& getName(uint32_t item) const;
+
+    // Returns sale type of the item at position item
+    Item::Sale_t getSaleType(uint32_t item) const;
+
+    // Return workload settings
+    const Params& getParams() const;
+
+private:
+    // Returns position of an item drawn by popularity
+    uint32_t drawItem(std::mt19937_64& rng) const;
+
+private:
+    Params mParams;                     // Workload settings
+    std::vector<std::string> mNames;    // Item names
+    std::vector<Item::Sale_t> mTypes;   // Item sale types
+    std::vector<double> mPopularity;    // Cumulative popularity by rank
+    std::vector<uint32_t> mByRank;      // Item position by popularity rank
+};
+
+#endif
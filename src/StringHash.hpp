@@ -0,0 +1,28 @@
+#ifndef __STRINGHASH_HPP__
+#define __STRINGHASH_HPP__
+
+#include <cstddef>
+#include <functional>
+#include <string_view>
+
+// Transparent hash for std::string keyed unordered containers. Used with std::equal_to<> so
+// lookups can be made by std::string_view or const char* without building a std::string
+struct StringHash {
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view str) const {
+        return std::hash<std::string_view>{}(str);
+    }
+};
+
+// Transparent equality to go with StringHash when keys and lookups are strings with different
+// allocators, which std::equal_to<> cannot compare
+struct StringEqual {
+    using is_transparent = void;
+
+    bool operator()(std::string_view a, std::string_view b) const {
+        return a == b;
+    }
+};
+
+#endif
@@ -0,0 +1,95 @@
+#include "TaxTable.hpp"
+
+#include <cmath>
+#include <iostream>
+
+namespace {
+// Subtotals smaller than this are float residue of lines added and removed again
+constexpr double kSubtotalResidue = 0.005;
+}
+
+TaxTable::TaxTable() :
+    mRates{}, mRounding(Rounding_t::HalfUp), mIncrement(0.01), mPerCategory(true)
+{}
+
+bool TaxTable::setRate(unsigned int category, float percent) {
+    if (category >= Item::kNumTaxCategories) {
+        std::cerr << "Invalid tax category" << std::endl;
+        return false;
+    }
+    if (percent < 0 || percent > 100) {
+        std::cerr << "Tax rate must be between 0 and 100 percent" << std::endl;
+        return false;
+    }
+
+    mRates[category] = percent / 100.0;
+    return true;
+}
+
+float TaxTable::getRate(unsigned int category) const {
+    return (category < Item::kNumTaxCategories) ? static_cast<float>(mRates[category] * 100.0) : 0;
+}
+
+bool TaxTable::setRounding(Rounding_t mode, double increment, bool perCategory) {
+    if (increment <= 0) {
+        std::cerr << "Rounding increment must be positive" << std::endl;
+        return false;
+    }
+
+    mRounding = mode;
+    mIncrement = increment;
+    mPerCategory = perCategory;
+    return true;
+}
+
+float TaxTable::calcTax(const float* subtotals) const {
+    // Scale every category to rounding increments in one pass, dropping residue first so it
+    // cannot round up to a whole increment
+    double scaled[Item::kNumTaxCategories];
+    for (unsigned int c = 0; c < Item::kNumTaxCategories; ++c) {
+        const double subtotal = (std::fabs(subtotals[c]) < kSubtotalResidue) ? 0.0 : subtotals[c];
+        scaled[c] = subtotal * mRates[c] / mIncrement;
+    }
+    if (mPerCategory) {
+        roundScaled(scaled, Item::kNumTaxCategories);
+    }
+
+    double total = 0;
+    for (unsigned int c = 0; c < Item::kNumTaxCategories; ++c) {
+        total += scaled[c];
+    }
+    if (!mPerCategory) {
+        roundScaled(&total, 1);
+    }
+    return static_cast<float>(total * mIncrement);
+}
+
+void TaxTable::roundScaled(double* scaled, unsigned int count) const {
+    // Snap to a millionth of an increment first so binary representation error cannot move an
+    // amount across a rounding boundary. One loop per mode keeps the loops branch free
+    for (unsigned int c = 0; c < count; ++c) {
+        scaled[c] = std::nearbyint(scaled[c] * 1e6) / 1e6;
+    }
+    switch (mRounding) {
+        case Rounding_t::HalfUp:
+            for (unsigned int c = 0; c < count; ++c) {
+                scaled[c] = std::floor(scaled[c] + 0.5);
+            }
+            break;
+        case Rounding_t::HalfEven:
+            for (unsigned int c = 0; c < count; ++c) {
+                scaled[c] = std::nearbyint(scaled[c]);
+            }
+            break;
+        case Rounding_t::Up:
+            for (unsigned int c = 0; c < count; ++c) {
+                scaled[c] = std::ceil(scaled[c]);
+            }
+            break;
+        case Rounding_t::Down:
+            for (unsigned int c = 0; c < count; ++c) {
+                scaled[c] = std::floor(scaled[c]);
+            }
+            break;
+    }
+}
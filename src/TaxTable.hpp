@@ -0,0 +1,45 @@
+#ifndef __TAXTABLE_HPP__
+#define __TAXTABLE_HPP__
+
+#include "Item.hpp"
+
+// Tax rates per tax category and the rounding rules applied to the tax. Order keeps a taxable
+// subtotal per category, so computing the tax of an order only runs over the categories. The
+// computation is laid out over fixed size arrays so it vectorizes.
+class TaxTable {
+public:
+    // How tax amounts are rounded to the rounding increment
+    enum class Rounding_t { HalfUp, HalfEven, Up, Down };
+
+    // Default constructor. All rates are 0 and tax is rounded half up to the cent per category
+    TaxTable();
+
+    // Set tax rate of a category as a percent [0,100]. Returns success of operation
+    bool setRate(unsigned int category, float percent);
+
+    // Return tax rate of a category as a percent or 0 for an invalid category
+    float getRate(unsigned int category) const;
+
+    // Set rounding mode and increment (0.01 for cents, 0.05 for nickels). Tax is rounded per
+    // category before summing if perCategory is true, otherwise only the total is rounded.
+    // Increment must be positive and is taken as a double, since a float increment such as
+    // 0.01f is not a whole cent. Returns success of operation
+    bool setRounding(Rounding_t mode, double increment, bool perCategory);
+
+    // Returns tax on the taxable subtotals of all categories. subtotals must hold
+    // Item::kNumTaxCategories values. Subtotals within half a cent of 0 are residue of float
+    // removals and are not taxed
+    float calcTax(const float* subtotals) const;
+
+private:
+    // Apply the rounding mode to amounts already scaled to increments
+    void roundScaled(double* scaled, unsigned int count) const;
+
+private:
+    double mRates[Item::kNumTaxCategories]; // Rate per category as a decimal
+    Rounding_t mRounding;   // Rounding mode
+    double mIncrement;      // Rounding increment in dollars
+    bool mPerCategory;      // Round each category instead of the total
+};
+
+#endif
@@ -0,0 +1,79 @@
+#include "WeightSession.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+WeightSession::WeightSession(const std::string& name, float unitPrice, const SpecialParams& special, float lineWeight,
+                             float linePrice, const Params& params) :
+    mName(name), mUnitPrice(unitPrice), mSpecial(special), mLineWeight(lineWeight), mLinePrice(linePrice), mParams(params),
+    mState(State_t::Empty), mAnchor(0), mSum(0), mCount(0), mWeight(0), mPrice(0)
+{}
+
+WeightSession::State_t WeightSession::addSample(float weight) {
+    if (weight <= 0) {
+        mState = State_t::Empty;
+        mCount = 0;
+        mWeight = mPrice = 0;
+        return mState;
+    }
+
+    // A sample away from the run means the product moved, start a new run
+    if (mCount == 0 || std::fabs(weight - mAnchor) > mParams.tolerance) {
+        mAnchor = weight;
+        mSum = 0;
+        mCount = 0;
+    }
+    mSum += weight;
+    ++mCount;
+
+    const bool stable = (mCount >= std::max(mParams.stableSamples, 1U));
+    const float newWeight = stable ? mSum / mCount : weight;
+    mState = stable ? State_t::Stable : State_t::Settling;
+
+    // Only the price of the whole line is looked at, so this is constant time per sample
+    if (newWeight != mWeight) {
+        mWeight = newWeight;
+        mPrice = estimatePrice(mSpecial, mLineWeight + mWeight, mUnitPrice) - mLinePrice;
+    }
+    return mState;
+}
+
+WeightSession::State_t WeightSession::getState() const {
+    return mState;
+}
+
+float WeightSession::getWeight() const {
+    return mWeight;
+}
+
+float WeightSession::getPrice() const {
+    return mPrice;
+}
+
+const std::string& WeightSession::getName() const {
+    return mName;
+}
+
+float WeightSession::estimatePrice(const SpecialParams& special, float weight, float price) {
+    const float block = special.needed + special.receive;
+    if (SpecialParams::Type_t::BuyOneGetOneWeight != special.type || block <= 0 || weight < 0 || price < 0) {
+        return special.calcPrice(weight, price);
+    }
+
+    // Weight over the limit is removed in whole pounds, like the special does
+    float overLimit = 0;
+    if (special.limit > 0 && weight > special.limit) {
+        overLimit = static_cast<float>(static_cast<unsigned int>(weight - special.limit));
+        weight -= overLimit;
+    }
+    if (weight <= special.needed) {
+        return (weight + overLimit) * price;
+    }
+
+    // Every started block after the needed weight is one special, only the last can be partial
+    const float blocks = std::ceil((weight - special.needed) / block);
+    const float rest = weight - (blocks - 1) * block - special.needed;
+    const float discounted = std::min(rest, special.receive);
+    return blocks * special.needed * price + ((blocks - 1) * special.receive + discounted) * price * (1 - special.value) +
+           (rest - discounted + overLimit) * price;
+}
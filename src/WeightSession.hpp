@@ -0,0 +1,63 @@
+#ifndef __WEIGHTSESSION_HPP__
+#define __WEIGHTSESSION_HPP__
+
+#include "Special.hpp"
+
+#include <string>
+
+// Pending weighed line fed by a scale that streams samples while the product settles. Samples
+// within a tolerance of each other are debounced into one stable weight, and the price the
+// weight would add to the order is kept up to date in constant time per sample.
+class WeightSession {
+public:
+    // Stability detection settings
+    struct Params {
+        float tolerance = 0.005f;       // Samples within this many pounds of each other are the same weight
+        unsigned int stableSamples = 5; // Number of consecutive matching samples for a stable weight
+    };
+
+    // State of the scale
+    enum class State_t { Empty, Settling, Stable };
+
+    // Constructor. unitPrice is the price per pound after markdown, lineWeight and linePrice
+    // describe what the order already holds of the item
+    WeightSession(const std::string& name, float unitPrice, const SpecialParams& special, float lineWeight, float linePrice,
+                  const Params& params);
+
+    // Add a scale sample and return the resulting state. Samples of zero or less mean the
+    // scale is empty
+    State_t addSample(float weight);
+
+    // Return state of the scale
+    State_t getState() const;
+
+    // Return weight on the scale. The average of the stable samples once stable, otherwise the
+    // latest sample
+    float getWeight() const;
+
+    // Return price the weight on the scale would add to the order
+    float getPrice() const;
+
+    // Return name of the weighed item
+    const std::string& getName() const;
+
+    // Returns total price of weight like SpecialParams::calcPrice, but counts whole BOGO by
+    // weight blocks at once instead of looping over them. May differ by float rounding
+    static float estimatePrice(const SpecialParams& special, float weight, float price);
+
+private:
+    std::string mName;          // Name of the weighed item
+    float mUnitPrice;           // Price per pound after markdown
+    SpecialParams mSpecial;     // Special of the item
+    float mLineWeight;          // Weight of the item already in the order
+    float mLinePrice;           // Price of the item already in the order
+    Params mParams;             // Stability detection settings
+    State_t mState;             // State of the scale
+    float mAnchor;              // First sample of the current run of matching samples
+    float mSum;                 // Sum of the samples of the run
+    unsigned int mCount;        // Number of samples in the run
+    float mWeight;              // Weight on the scale
+    float mPrice;               // Price added by the weight
+};
+
+#endif
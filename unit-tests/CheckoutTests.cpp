@@ -1,11 +1,49 @@
 #include <gtest/gtest.h>
 #include <optional>
+#include <numeric>
 #include <cmath>
-
+#include <sstream>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "../src/AsOfCatalog.hpp"
+#include "../src/CartEventQueue.hpp"
+#include "../src/CatalogCodegen.hpp"
+#include "../src/CatalogFile.hpp"
+#include "../src/CouponBook.hpp"
+#include "../src/FrozenCatalog.hpp"
+#include "../src/GtinIndex.hpp"
 #include "../src/Item.hpp"
+#include "../src/ItemCache.hpp"
 #include "../src/ItemDatabase.hpp"
+#include "../src/LiveCatalog.hpp"
+#include "../src/MemoryUsage.hpp"
+#include "../src/NumaTopology.hpp"
 #include "../src/Order.hpp"
+#include "../src/PriceHistory.hpp"
+#include "../src/PricingService.hpp"
+#include "../src/PromotionSimulator.hpp"
+#include "../src/ReplicatedCatalog.hpp"
+#include "../src/Repricer.hpp"
+#include "../src/SalesAggregator.hpp"
+#include "../src/SharedCatalog.hpp"
+#include "../src/SharedItemCatalog.hpp"
 #include "../src/Special.hpp"
+#include "../src/SpecialScheduler.hpp"
+#include "../src/StaticCatalog.hpp"
+#include "../src/StoreCatalog.hpp"
+#include "../src/StoreWorkload.hpp"
+#include "../src/TaxTable.hpp"
+#include "../src/WeightSession.hpp"
+
+#include "KioskCatalog.hpp" // Generated from unit-tests/KioskCatalog.txt
 
 /*************************** Item Tests **************************************/
 
@@ -72,6 +110,23 @@ TEST(ItemTests, SetGetSpecial) {
     ASSERT_EQ(nullptr, chip.getSpecial());
 }
 
+TEST(ItemTests, SetGetGtin) {
+    Item chip("Chips", Item::Sale_t::Unit, 3);
+    ASSERT_EQ(0U, chip.getGtin());
+
+    // Check digit must be valid
+    ASSERT_FALSE(chip.setGtin(36000291453ULL));
+    ASSERT_FALSE(chip.setGtin(123456789012345ULL)); // 15 digits
+    ASSERT_EQ(0U, chip.getGtin());
+
+    // UPC-A 036000291452
+    ASSERT_TRUE(chip.setGtin(36000291452ULL));
+    ASSERT_EQ(36000291452ULL, chip.getGtin());
+
+    ASSERT_TRUE(chip.setGtin(0));
+    ASSERT_EQ(0U, chip.getGtin());
+}
+
 /*************************** Database Tests **********************************/
 
 TEST(DatabaseTests, InsertIntoDatabase) {
@@ -224,6 +279,83 @@ TEST(DatabaseTests, SetItemSpecialNforXSuccess) {
     ASSERT_NE(nullptr, db.getItem("Chips")->getSpecial());
 }
 
+TEST(DatabaseTests, LookupByStringView) {
+    ItemDatabase db;
+    ASSERT_TRUE(db.insertItem({"Chips", Item::Sale_t::Unit, 3}));
+
+    // Slice of a scanner buffer, not null terminated
+    const char buf[] = "ChipsSalsa";
+    std::string_view name(buf, 5);
+    ASSERT_NE(nullptr, db.findItem(name));
+    ASSERT_EQ(nullptr, db.findItem(std::string_view(buf, 4)));
+    ASSERT_TRUE(db.setItemPrice(name, 2.5));
+    ASSERT_FLOAT_EQ(2.5, db.getItem(name)->getPrice());
+}
+
+// Append a valid GS1 check digit to an 11-13 digit number
+static uint64_t makeGtin(uint64_t body) {
+    unsigned int sum = 0;
+    unsigned int weight = 3;
+    for (uint64_t rest = body; rest > 0; rest /= 10) {
+        sum += (rest % 10) * weight;
+        weight = 4 - weight;
+    }
+    return body * 10 + (10 - sum % 10) % 10;
+}
+
+TEST(DatabaseTests, FindItemByGtinBeforeAndAfterFinalize) {
+    ItemDatabase db;
+    Item chip("Chips", Item::Sale_t::Unit, 3);
+    ASSERT_TRUE(chip.setGtin(makeGtin(3600029145ULL)));
+    ASSERT_TRUE(db.insertItem(chip));
+    ASSERT_TRUE(db.insertItem({"Apple", Item::Sale_t::Weight, 1.49}));
+
+    // Duplicate GTIN rejected
+    Item salsa("Salsa", Item::Sale_t::Unit, 4);
+    ASSERT_TRUE(salsa.setGtin(chip.getGtin()));
+    ASSERT_FALSE(db.insertItem(salsa));
+
+    ASSERT_EQ("Chips", db.findItemByGtin(chip.getGtin())->getName());
+    ASSERT_TRUE(db.finalize());
+    ASSERT_EQ("Chips", db.findItemByGtin(chip.getGtin())->getName());
+    ASSERT_EQ(nullptr, db.findItemByGtin(makeGtin(3600029146ULL)));
+
+    // Items inserted after finalize are still found
+    ASSERT_TRUE(salsa.setGtin(makeGtin(3600029146ULL)));
+    ASSERT_TRUE(db.insertItem(salsa));
+    ASSERT_EQ("Salsa", db.findItemByGtin(salsa.getGtin())->getName());
+    ASSERT_EQ("Chips", db.findItemByGtin(chip.getGtin())->getName());
+}
+
+TEST(DatabaseTests, GtinIndexLargeCatalog) {
+    const std::size_t numItems = 4000;
+    std::vector<uint64_t> gtins;
+    ItemDatabase db;
+    for (std::size_t i = 0; i < numItems; ++i) {
+        Item item("Item" + std::to_string(i), Item::Sale_t::Unit, 1);
+        gtins.push_back(makeGtin(7000000000ULL + i * 7919));
+        ASSERT_TRUE(item.setGtin(gtins.back()));
+        ASSERT_TRUE(db.insertItem(item));
+    }
+    ASSERT_TRUE(db.finalize());
+
+    for (std::size_t i = 0; i < numItems; ++i) {
+        ASSERT_EQ("Item" + std::to_string(i), db.findItemByGtin(gtins[i])->getName());
+    }
+
+    // Perfect hash slots are a permutation and the index stays a few bits per key
+    GtinIndex index;
+    ASSERT_TRUE(index.build(gtins));
+    std::vector<bool> seen(numItems, false);
+    for (uint64_t gtin : gtins) {
+        std::size_t slot = index.slot(gtin);
+        ASSERT_LT(slot, numItems);
+        ASSERT_FALSE(seen[slot]);
+        seen[slot] = true;
+    }
+    ASSERT_LE(index.memoryBytes() * 8, numItems * 8);
+}
+
 /***************************** Order Tests ***********************************/
 
 TEST(OrderTests, ScanItemUnitNotInDatabase) {
@@ -489,6 +621,190 @@ TEST(OrderTests, AddItemSpecialRemoveItemInvalidateSpecialWeight) {
     ASSERT_FLOAT_EQ(1.5 * (.75 - .3), ord.getTotalPrice());
 }
 
+TEST(OrderTests, SavingsMarkdownAndSpecial) {
+    ItemDatabase db;
+    db.insertItem({"Chips", Item::Sale_t::Unit, 3});
+    db.insertItem({"Apple", Item::Sale_t::Weight, 2});
+    db.setItemMarkdown("Chips", .5);
+    db.setItemSpecial("Apple", 1.0f, 1.0f, 50);
+    Order ord(db);
+    ASSERT_FLOAT_EQ(0, ord.getSavings());
+
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_FLOAT_EQ(.5 * 2, ord.getSavings());
+
+    ASSERT_TRUE(ord.ScanItem("Apple", 2.0f));
+    ASSERT_FLOAT_EQ(.5 * 2 + 1.0, ord.getSavings());
+
+    // Removing items removes their savings
+    ASSERT_TRUE(ord.RemoveItem("Chips", 5U));
+    ASSERT_TRUE(ord.RemoveItem("Apple", .5f));
+    ASSERT_FLOAT_EQ(.5, ord.getSavings());
+}
+
+TEST(OrderTests, ScanRemoveByStringView) {
+    ItemDatabase db;
+    db.insertItem({"Chips", Item::Sale_t::Unit, 3});
+    db.insertItem({"Apple", Item::Sale_t::Weight, 2});
+    Order ord(db);
+
+    const char buf[] = "ChipsApple";
+    ASSERT_TRUE(ord.ScanItem(std::string_view(buf, 5)));
+    ASSERT_TRUE(ord.ScanItem(std::string_view(buf, 5)));
+    ASSERT_TRUE(ord.ScanItem(std::string_view(buf + 5, 5), 1.5f));
+    ASSERT_FLOAT_EQ(3 * 2 + 2 * 1.5, ord.getTotalPrice());
+
+    ASSERT_TRUE(ord.RemoveItem(std::string_view(buf, 5), 1U));
+    ASSERT_TRUE(ord.RemoveItem(std::string_view(buf + 5, 5), 1.5f));
+    ASSERT_FLOAT_EQ(3, ord.getTotalPrice());
+}
+
+TEST(OrderTests, ScanBarcode) {
+    ItemDatabase db;
+    Item chip("Chips", Item::Sale_t::Unit, 3);
+    Item apple("Apple", Item::Sale_t::Weight, 2);
+    ASSERT_TRUE(chip.setGtin(36000291452ULL));
+    ASSERT_TRUE(apple.setGtin(40112ULL));
+    ASSERT_TRUE(db.insertItem(chip));
+    ASSERT_TRUE(db.insertItem(apple));
+    ASSERT_TRUE(db.finalize());
+    Order ord(db);
+
+    ASSERT_TRUE(ord.ScanBarcode(36000291452ULL));
+    ASSERT_FALSE(ord.ScanBarcode(36000291452ULL, 1.0f));
+    ASSERT_TRUE(ord.ScanBarcode(40112ULL, 1.5f));
+    ASSERT_FALSE(ord.ScanBarcode(12345678905ULL));
+    ASSERT_FLOAT_EQ(3 + 2 * 1.5, ord.getTotalPrice());
+
+    // Lines scanned by barcode are removable by name
+    ASSERT_TRUE(ord.RemoveItem("Chips", 1U));
+    ASSERT_FLOAT_EQ(2 * 1.5, ord.getTotalPrice());
+}
+
+TEST(OrderTests, ScanUnitsInOneStep) {
+    ItemDatabase db;
+    db.insertItem({"Soda", Item::Sale_t::Unit, 1.99});
+    db.insertItem({"Apple", Item::Sale_t::Weight, 1.49});
+    db.setItemSpecial("Soda", 3U, 5.0f);
+    Order ord(db);
+
+    ASSERT_FALSE(ord.ScanUnits("Soda", 0));
+    ASSERT_FALSE(ord.ScanUnits("Apple", 2));
+    ASSERT_FALSE(ord.ScanUnits("Unknown", 2));
+    ASSERT_TRUE(ord.ScanUnits("Soda", 4));
+    ASSERT_EQ(1U, ord.getNumLines());
+    ASSERT_FLOAT_EQ(5 + 1.99, ord.getTotalPrice());
+
+    // Voiding takes back all units of the scan
+    ASSERT_TRUE(ord.ScanUnits("Soda", 2));
+    ASSERT_FLOAT_EQ(10, ord.getTotalPrice());
+    ASSERT_TRUE(ord.VoidLastScan());
+    ASSERT_FLOAT_EQ(5 + 1.99, ord.getTotalPrice());
+
+    // A reset order prices the next basket from scratch
+    ord.Reset();
+    ASSERT_TRUE(ord.ScanUnits("Soda", 3));
+    ASSERT_FLOAT_EQ(5, ord.getTotalPrice());
+}
+
+TEST(OrderTests, ReceiptLines) {
+    ItemDatabase db;
+    db.insertItem({"Chips", Item::Sale_t::Unit, 3});
+    db.insertItem({"Apple", Item::Sale_t::Weight, 2});
+    db.insertItem({"Soda", Item::Sale_t::Unit, 1});
+    db.setItemMarkdown("Chips", .5);
+    db.setItemSpecial("Apple", 1.0f, 1.0f, 50);
+    Order ord(db);
+    ASSERT_EQ(0U, ord.getReceipt(nullptr, 0));
+
+    ASSERT_TRUE(ord.ScanItem("Soda"));
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_TRUE(ord.ScanItem("Apple", 2.0f));
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+
+    // Lines come back in scan order and add up to the order totals
+    Order::ReceiptLine lines[4];
+    ASSERT_EQ(3U, ord.getReceipt(lines, 4));
+    ASSERT_EQ("Soda", lines[0].name);
+    ASSERT_EQ("Chips", lines[1].name);
+    ASSERT_EQ("Apple", lines[2].name);
+
+    ASSERT_EQ(Item::Sale_t::Unit, lines[1].saleType);
+    ASSERT_FLOAT_EQ(2, lines[1].amount);
+    ASSERT_FLOAT_EQ(3, lines[1].unitPrice);
+    ASSERT_FLOAT_EQ(.5, lines[1].markdown);
+    ASSERT_EQ(SpecialParams::Type_t::None, lines[1].special.type);
+    ASSERT_FLOAT_EQ(1, lines[1].savings);
+
+    ASSERT_EQ(Item::Sale_t::Weight, lines[2].saleType);
+    ASSERT_EQ(SpecialParams::Type_t::BuyOneGetOneWeight, lines[2].special.type);
+    ASSERT_FLOAT_EQ(4, lines[2].regularPrice);
+    ASSERT_FLOAT_EQ(3, lines[2].totalPrice);
+
+    float total = 0, savings = 0;
+    for (std::size_t i = 0; i < 3; ++i) {
+        total += lines[i].totalPrice;
+        savings += lines[i].savings;
+    }
+    ASSERT_FLOAT_EQ(ord.getTotalPrice(), total);
+    ASSERT_FLOAT_EQ(ord.getSavings(), savings);
+}
+
+TEST(OrderTests, ReceiptSavingsAfterPriceChange) {
+    ItemDatabase db;
+    db.insertItem({"Chips", Item::Sale_t::Unit, 3});
+    db.insertItem({"Apple", Item::Sale_t::Weight, 2});
+    db.setItemMarkdown("Chips", .5);
+    Order ord(db);
+    auto receiptSavings = [&ord]() {
+        Order::ReceiptLine lines[2];
+        float savings = 0;
+        for (std::size_t i = 0; i < ord.getReceipt(lines, 2); ++i) {
+            savings += lines[i].savings;
+        }
+        return savings;
+    };
+
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_TRUE(ord.ScanItem("Apple", 1.0f));
+
+    // Rescanning reprices the whole line, so the savings follow the new price
+    ASSERT_TRUE(db.setItemPrice("Chips", 4));
+    ASSERT_TRUE(db.setItemPrice("Apple", 3));
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_TRUE(ord.ScanItem("Apple", 1.0f));
+    ASSERT_FLOAT_EQ(1, ord.getSavings());
+    ASSERT_FLOAT_EQ(receiptSavings(), ord.getSavings());
+
+    ASSERT_TRUE(ord.VoidLastScan());
+    ASSERT_FLOAT_EQ(receiptSavings(), ord.getSavings());
+
+    ASSERT_TRUE(db.setItemPrice("Chips", 2));
+    ord.Reprice();
+    ASSERT_TRUE(ord.RemoveItem("Chips", 1U));
+    ASSERT_FLOAT_EQ(.5, ord.getSavings());
+    ASSERT_FLOAT_EQ(receiptSavings(), ord.getSavings());
+}
+
+TEST(OrderTests, ReceiptSmallBuffer) {
+    ItemDatabase db;
+    for (const char* name : { "A", "B", "C", "D", "E" }) {
+        db.insertItem({name, Item::Sale_t::Unit, 1});
+    }
+    Order ord(db);
+    for (const char* name : { "E", "C", "A", "D", "B" }) {
+        ASSERT_TRUE(ord.ScanItem(name));
+    }
+    ASSERT_TRUE(ord.RemoveItem("C", 1U));
+
+    // Only the first lines by scan order are written
+    Order::ReceiptLine lines[2];
+    ASSERT_EQ(4U, ord.getReceipt(lines, 2));
+    ASSERT_EQ("E", lines[0].name);
+    ASSERT_EQ("A", lines[1].name);
+}
+
 /***************************** Special Tests *********************************/
 
 TEST(SpecialTests, BuyOneGetOneFreeUnitInvalidPercentPrice) {
@@ -712,6 +1028,21 @@ TEST(SpecialTests, BuyOneGetOneXPercentWeightTwoSpecialsLesserAmount) {
     delete sp;
 }
 
+TEST(SpecialTests, BuyOneGetOneWeightTinyNeeded) {
+    // A needed weight below the float step of the amount still prices in bounded time
+    SpecialParams tiny = BuyOneGetOneWeight(1, 0, 50).getParams();
+    tiny.needed = 1e-9f;
+    ASSERT_FALSE(tiny.isValid());
+    ASSERT_FLOAT_EQ(3, tiny.calcPrice(3, 1));
+    tiny.receive = 1e-9f;
+    ASSERT_NEAR(2.25, tiny.calcPrice(3, 1), 1e-3);
+
+    ItemDatabase db;
+    db.insertItem({"Apple", Item::Sale_t::Weight, 2});
+    ASSERT_FALSE(db.setItemSpecial("Apple", 1e-9f, 0.0f, 50));
+    ASSERT_TRUE(db.setItemSpecial("Apple", SpecialParams::kMinSpecialWeight, 0.0f, 50));
+}
+
 // Use case #5
 TEST(SpecialTests, NforXNotEnough) {
     unsigned int numNeeded = 3;
@@ -940,6 +1271,2509 @@ TEST(SpecialTests, NforXLimitExceeded) {
     delete sp;
 }
 
+/***************************** Tax Tests *************************************/
+
+TEST(TaxTests, RatesAndRounding) {
+    TaxTable taxes;
+    ASSERT_FALSE(taxes.setRate(Item::kNumTaxCategories, 5));
+    ASSERT_FALSE(taxes.setRate(0, 101));
+    ASSERT_FALSE(taxes.setRounding(TaxTable::Rounding_t::HalfUp, 0, true));
+    ASSERT_TRUE(taxes.setRate(0, 7));
+    ASSERT_TRUE(taxes.setRate(1, 2.5));
+    ASSERT_FLOAT_EQ(2.5, taxes.getRate(1));
+
+    float subtotals[Item::kNumTaxCategories] = {};
+    subtotals[0] = 1.5;  // .105 tax
+    subtotals[1] = 4.7;  // .1175 tax
+    ASSERT_FLOAT_EQ(.11 + .12, taxes.calcTax(subtotals));
+
+    ASSERT_TRUE(taxes.setRounding(TaxTable::Rounding_t::HalfEven, .01, true));
+    ASSERT_FLOAT_EQ(.10 + .12, taxes.calcTax(subtotals));
+    ASSERT_TRUE(taxes.setRounding(TaxTable::Rounding_t::Down, .01, true));
+    ASSERT_FLOAT_EQ(.10 + .11, taxes.calcTax(subtotals));
+    ASSERT_TRUE(taxes.setRounding(TaxTable::Rounding_t::Up, .05, true));
+    ASSERT_FLOAT_EQ(.15 + .15, taxes.calcTax(subtotals));
+
+    // Rounding only the total
+    ASSERT_TRUE(taxes.setRounding(TaxTable::Rounding_t::HalfUp, .01, false));
+    ASSERT_FLOAT_EQ(.22, taxes.calcTax(subtotals));
+}
+
+TEST(TaxTests, IncrementAndResidue) {
+    TaxTable taxes;
+    ASSERT_TRUE(taxes.setRate(0, 10));
+    ASSERT_TRUE(taxes.setRate(1, 10));
+
+    // Exactly a cent of tax stays a cent when rounding up
+    float subtotals[Item::kNumTaxCategories] = {};
+    subtotals[0] = .1;
+    ASSERT_TRUE(taxes.setRounding(TaxTable::Rounding_t::Up, .01, true));
+    ASSERT_FLOAT_EQ(.01, taxes.calcTax(subtotals));
+
+    // Residue left by removals is not taxed, in either direction
+    subtotals[0] = 0;
+    subtotals[1] = 1e-6f;
+    ASSERT_FLOAT_EQ(0, taxes.calcTax(subtotals));
+    subtotals[1] = -1e-6f;
+    ASSERT_TRUE(taxes.setRounding(TaxTable::Rounding_t::Down, .01, false));
+    ASSERT_FLOAT_EQ(0, taxes.calcTax(subtotals));
+}
+
+TEST(TaxTests, OrderKeepsTaxableSubtotals) {
+    ItemDatabase db;
+    db.insertItem({"Chips", Item::Sale_t::Unit, 3});
+    db.insertItem({"Apple", Item::Sale_t::Weight, 2});
+    db.insertItem({"Soda", Item::Sale_t::Unit, 1});
+    ASSERT_TRUE(db.setItemTaxCategory("Chips", 1));
+    ASSERT_TRUE(db.setItemTaxCategory("Soda", 2));
+    ASSERT_FALSE(db.setItemTaxCategory("Soda", Item::kNumTaxCategories));
+    db.setItemSpecial("Chips", 1U, 1U, 100);
+
+    TaxTable taxes;
+    taxes.setRate(1, 10);
+    taxes.setRate(2, 20);
+    Order ord(db);
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_TRUE(ord.ScanItem("Apple", 1.5f));
+    ASSERT_TRUE(ord.ScanItem("Soda"));
+
+    // Tax is charged on the price after specials
+    ASSERT_FLOAT_EQ(3, ord.getTaxableSubtotal(0));
+    ASSERT_FLOAT_EQ(3, ord.getTaxableSubtotal(1));
+    ASSERT_FLOAT_EQ(1, ord.getTaxableSubtotal(2));
+    ASSERT_FLOAT_EQ(.3 + .2, ord.getTax(taxes));
+
+    ASSERT_TRUE(ord.RemoveItem("Soda", 1U));
+    ASSERT_FLOAT_EQ(0, ord.getTaxableSubtotal(2));
+    ASSERT_FLOAT_EQ(.3, ord.getTax(taxes));
+
+    // A line moves to the new category of its item the next time it changes
+    ASSERT_TRUE(db.setItemTaxCategory("Chips", 2));
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_FLOAT_EQ(0, ord.getTaxableSubtotal(1));
+    ASSERT_FLOAT_EQ(6, ord.getTaxableSubtotal(2));
+    ASSERT_FLOAT_EQ(1.2, ord.getTax(taxes));
+}
+
+TEST(TaxTests, CatalogDeltaTaxRecord) {
+    ItemDatabase db;
+    std::istringstream in("item,Chips,unit,3\ntax,Chips,3\n");
+    ASSERT_TRUE(loadCatalog(in, db));
+    ASSERT_EQ(3U, db.findItem("Chips")->getTaxCategory());
+
+    CatalogDelta delta;
+    delta.setItemTaxCategory("Chips", Item::kNumTaxCategories);
+    ASSERT_FALSE(db.applyDelta(delta));
+    ASSERT_EQ(3U, db.findItem("Chips")->getTaxCategory());
+}
+
+/***************************** Coupon Tests **********************************/
+
+// Database and book with one coupon of each scope
+static void fillCouponBook(ItemDatabase& db, CouponBook& book) {
+    db.insertItem({"Chips", Item::Sale_t::Unit, 3});
+    db.insertItem({"Salsa", Item::Sale_t::Unit, 4});
+    db.insertItem({"Apple", Item::Sale_t::Weight, 2});
+
+    Coupon chips;
+    chips.id = 1;
+    chips.value = 1;
+    chips.minAmount = 2;
+    chips.items = { "Chips" };
+    ASSERT_TRUE(book.addCoupon(chips));
+
+    Coupon snacks;
+    snacks.id = 2;
+    snacks.scope = Coupon::Scope_t::Group;
+    snacks.discount = Coupon::Discount_t::Percent;
+    snacks.value = 10;
+    snacks.items = { "Chips", "Salsa", "Chips" };
+    ASSERT_TRUE(book.addCoupon(snacks));
+
+    Coupon order;
+    order.id = 3;
+    order.scope = Coupon::Scope_t::Order;
+    order.value = 5;
+    order.minAmount = 20;
+    order.loyalty = true;
+    ASSERT_TRUE(book.addCoupon(order));
+}
+
+TEST(CouponTests, AddCouponValidation) {
+    ItemDatabase db;
+    CouponBook book;
+    fillCouponBook(db, book);
+    ASSERT_EQ(3U, book.size());
+    ASSERT_EQ(2U, book.getItemCoupons("Chips").size());
+    ASSERT_EQ(1U, book.getItemCoupons("Salsa").size());
+    ASSERT_TRUE(book.getItemCoupons("Apple").empty());
+
+    Coupon coupon;
+    coupon.id = 1;
+    coupon.items = { "Apple" };
+    ASSERT_FALSE(book.addCoupon(coupon)); // Duplicate id
+    coupon.id = 4;
+    coupon.items.clear();
+    ASSERT_FALSE(book.addCoupon(coupon)); // Item coupon without item
+    coupon.items = { "Apple" };
+    coupon.discount = Coupon::Discount_t::Percent;
+    coupon.value = 101;
+    ASSERT_FALSE(book.addCoupon(coupon));
+    ASSERT_EQ(-1, book.findCoupon(4));
+}
+
+TEST(CouponTests, RedeemAndRecheck) {
+    ItemDatabase db;
+    CouponBook book;
+    fillCouponBook(db, book);
+    Order ord(db);
+
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_FALSE(ord.RedeemCoupon(book, 1)); // Needs two bags
+    ASSERT_FALSE(ord.RedeemCoupon(book, 9)); // Unknown coupon
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_TRUE(ord.ScanItem("Salsa"));
+    ASSERT_TRUE(ord.RedeemCoupon(book, 1));
+    ASSERT_FALSE(ord.RedeemCoupon(book, 1)); // Already redeemed
+    ASSERT_TRUE(ord.RedeemCoupon(book, 2));
+    ASSERT_FLOAT_EQ(1 + 1, ord.getCouponDiscount());
+    ASSERT_FLOAT_EQ(10 - 2, ord.getTotalPrice());
+    ASSERT_FLOAT_EQ(2, ord.getSavings());
+
+    // Coupons follow the lines they apply to
+    ASSERT_TRUE(ord.ScanItem("Salsa"));
+    ASSERT_FLOAT_EQ(1 + 1.4, ord.getCouponDiscount());
+    ASSERT_TRUE(ord.RemoveItem("Chips", 1U));
+    ASSERT_FLOAT_EQ(1.1, ord.getCouponDiscount());
+    ASSERT_FLOAT_EQ(11 - 1.1, ord.getTotalPrice());
+
+    // Coupons from another book are rejected
+    CouponBook other;
+    ASSERT_FALSE(ord.RedeemCoupon(other, 2));
+}
+
+TEST(CouponTests, LoyaltyOrderCoupon) {
+    ItemDatabase db;
+    CouponBook book;
+    fillCouponBook(db, book);
+    Order ord(db);
+    ASSERT_TRUE(ord.ScanItem("Apple", 12.0f));
+
+    // Loyalty coupons need a member and the minimum order price
+    ASSERT_FALSE(ord.RedeemCoupon(book, 3));
+    ord.setLoyaltyMember(true);
+    ASSERT_TRUE(ord.RedeemCoupon(book, 3));
+    ASSERT_FLOAT_EQ(19, ord.getTotalPrice());
+
+    ASSERT_TRUE(ord.RemoveItem("Apple", 4.0f));
+    ASSERT_FLOAT_EQ(0, ord.getCouponDiscount());
+    ASSERT_FLOAT_EQ(16, ord.getTotalPrice());
+
+    ASSERT_TRUE(ord.ScanItem("Apple", 4.0f));
+    ASSERT_TRUE(ord.RedeemCoupon(book, 3));
+    ord.setLoyaltyMember(false);
+    ASSERT_FLOAT_EQ(24, ord.getTotalPrice());
+
+    const uint32_t batch[] = { 1, 2, 3 };
+    ASSERT_EQ(0U, ord.RedeemCoupons(book, batch, 3));
+}
+
+TEST(CouponTests, StackedCouponsCapAtOrderPrice) {
+    ItemDatabase db;
+    CouponBook book;
+    fillCouponBook(db, book);
+    Coupon order;
+    order.id = 4;
+    order.scope = Coupon::Scope_t::Order;
+    order.value = 6;
+    ASSERT_TRUE(book.addCoupon(order));
+
+    // The order coupon takes the whole $6 and the Chips coupon would stack on top
+    Order ord(db);
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_TRUE(ord.RedeemCoupon(book, 4));
+    ASSERT_FLOAT_EQ(0, ord.getTotalPrice());
+    ASSERT_TRUE(ord.RedeemCoupon(book, 1));
+    ASSERT_FLOAT_EQ(6, ord.getCouponDiscount());
+    ASSERT_FLOAT_EQ(0, ord.getTotalPrice());
+
+    // Both apply in full once the order costs more
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_FLOAT_EQ(7, ord.getCouponDiscount());
+    ASSERT_FLOAT_EQ(2, ord.getTotalPrice());
+    ASSERT_TRUE(ord.RemoveItem("Chips", 1U));
+    ASSERT_FLOAT_EQ(0, ord.getTotalPrice());
+}
+
+/***************************** Special Scheduler Tests ***********************/
+
+TEST(SpecialSchedulerTests, WindowsBecomeTransitions) {
+    ItemDatabase db;
+    db.insertItem({"Beer", Item::Sale_t::Unit, 4});
+    db.insertItem({"Apple", Item::Sale_t::Weight, 2});
+    db.setItemSpecial("Beer", 1U, 1U, 100);
+    auto happyHour = std::make_shared<NforX>(2, 5);
+    auto weekend = std::make_shared<NforX>(3, 6);
+
+    SpecialScheduler scheduler;
+    ASSERT_FALSE(scheduler.addWindow("Beer", happyHour, 200, 100));
+    ASSERT_FALSE(scheduler.addWindow("Beer", nullptr, 100, 200));
+    ASSERT_TRUE(scheduler.addWindow("Beer", happyHour, 100, 200));
+    ASSERT_TRUE(scheduler.addWindow("Beer", weekend, 150, 300));
+    ASSERT_TRUE(scheduler.build(db));
+    ASSERT_EQ(3U, scheduler.getNumTransitions()); // 100 happy hour, 150 weekend, 300 back to BOGO
+    ASSERT_EQ(100, scheduler.getNextTransition());
+
+    Order ord(db);
+    ASSERT_EQ(0U, scheduler.advanceTo(db, 99));
+    ASSERT_TRUE(ord.ScanItem("Beer"));
+    ASSERT_TRUE(ord.ScanItem("Beer"));
+    ASSERT_FLOAT_EQ(4, ord.getTotalPrice());
+
+    const uint64_t epoch = db.getEpoch();
+    ASSERT_EQ(1U, scheduler.advanceTo(db, 120));
+    ASSERT_EQ(epoch + 1, db.getEpoch());
+    ASSERT_EQ(SpecialParams::Type_t::NforX, db.findItem("Beer")->getSpecial()->getParams().type);
+    ASSERT_FLOAT_EQ(4, ord.getTotalPrice()); // Kept at scanned price by default
+
+    ASSERT_EQ(2U, scheduler.advanceTo(db, 1000));
+    ASSERT_EQ(SpecialParams::Type_t::BuyOneGetOneUnit, db.findItem("Beer")->getSpecial()->getParams().type);
+    ASSERT_EQ(INT64_MAX, scheduler.getNextTransition());
+
+    // Specials must match the sale type
+    SpecialScheduler invalid;
+    ASSERT_TRUE(invalid.addWindow("Apple", happyHour, 100, 200));
+    ASSERT_FALSE(invalid.build(db));
+}
+
+TEST(SpecialSchedulerTests, WeeklyWindowsAndRepricing) {
+    ItemDatabase db;
+    db.insertItem({"Wings", Item::Sale_t::Unit, 1});
+    const int64_t day = 24 * 60 * 60;
+    const int64_t sunday = 3 * day; // 1970-01-04
+
+    // Saturday and Sunday from 16:00 to 18:00 during two weeks
+    SpecialScheduler scheduler(SpecialScheduler::Reprice_t::RepriceIfLower);
+    ASSERT_TRUE(scheduler.addWeeklyWindow("Wings", std::make_shared<NforX>(10, 5), 0x41, 16 * 3600, 18 * 3600, sunday, sunday + 14 * day));
+    ASSERT_TRUE(scheduler.build(db));
+    ASSERT_EQ(2U * 4U, scheduler.getNumTransitions());
+    ASSERT_EQ(sunday + 16 * 3600, scheduler.getNextTransition());
+
+    Order ord(db);
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(ord.ScanItem("Wings"));
+    }
+    ASSERT_FLOAT_EQ(10, ord.getTotalPrice());
+
+    // Open orders get the cheaper happy hour price, but keep it once it ends
+    std::vector<Order*> open = { &ord };
+    ASSERT_EQ(1U, scheduler.advanceTo(db, sunday + 17 * 3600, open));
+    ASSERT_FLOAT_EQ(5, ord.getTotalPrice());
+    ASSERT_EQ(1U, scheduler.advanceTo(db, sunday + 19 * 3600, open));
+    ASSERT_FLOAT_EQ(5, ord.getTotalPrice());
+    ASSERT_EQ(sunday + 6 * day + 16 * 3600, scheduler.getNextTransition());
+}
+
+TEST(SpecialSchedulerTests, OverlappingWindowsOverAYear) {
+    ItemDatabase db;
+    db.insertItem({"Wings", Item::Sale_t::Unit, 1});
+    const int64_t day = 24 * 60 * 60;
+    auto promo = std::make_shared<NforX>(4, 3);
+    auto happyHour = std::make_shared<NforX>(10, 5);
+    auto tie = std::make_shared<NforX>(2, 1);
+
+    // A month long promotion under a daily happy hour, which starts later and so wins
+    SpecialScheduler scheduler;
+    ASSERT_TRUE(scheduler.addWindow("Wings", promo, 100 * day, 130 * day));
+    ASSERT_TRUE(scheduler.addWeeklyWindow("Wings", happyHour, 0x7f, 16 * 3600, 18 * 3600, 0, 365 * day));
+    ASSERT_TRUE(scheduler.addWindow("Wings", tie, 200 * day + 16 * 3600, 200 * day + 17 * 3600));
+    ASSERT_TRUE(scheduler.build(db));
+    ASSERT_EQ(2U * 365U + 2U + 1U, scheduler.getNumTransitions());
+
+    ASSERT_EQ(2U * 105U + 1U, scheduler.advanceTo(db, 105 * day + 12 * 3600));
+    ASSERT_EQ(promo.get(), db.findItem("Wings")->getSpecial());
+    ASSERT_EQ(1U, scheduler.advanceTo(db, 105 * day + 17 * 3600));
+    ASSERT_EQ(happyHour.get(), db.findItem("Wings")->getSpecial());
+
+    // Of windows starting together the one added last wins
+    scheduler.advanceTo(db, 200 * day + 16 * 3600);
+    ASSERT_EQ(tie.get(), db.findItem("Wings")->getSpecial());
+    scheduler.advanceTo(db, 200 * day + 17 * 3600);
+    ASSERT_EQ(happyHour.get(), db.findItem("Wings")->getSpecial());
+    scheduler.advanceTo(db, 365 * day);
+    ASSERT_EQ(nullptr, db.findItem("Wings")->getSpecial());
+}
+
+/**************************** Store Catalog Tests ****************************/
+TEST(StoreCatalogTests, OverridesLayerOnSharedBase) {
+    auto chain = std::make_shared<ItemDatabase>();
+    Item soup("Soup", Item::Sale_t::Unit, 2);
+    ASSERT_TRUE(soup.setGtin(36000291452ULL));
+    chain->insertItem(soup);
+    chain->insertItem({"Beef", Item::Sale_t::Weight, 5});
+    chain->finalize();
+
+    StoreCatalog store(chain);
+    ASSERT_EQ(chain->findItem("Soup"), store.findItem("Soup"));
+    ASSERT_EQ(nullptr, store.findItem("Milk"));
+
+    ASSERT_TRUE(store.setItemPrice("Soup", 3));
+    ASSERT_TRUE(store.setItemMarkdown("Soup", 1));
+    ASSERT_FALSE(store.setItemPrice("Milk", 3));
+    ASSERT_FALSE(store.setItemMarkdown("Beef", 6)); // Larger than price
+    ASSERT_EQ(1U, store.getNumOverrides());
+
+    ASSERT_FLOAT_EQ(3, store.findItem("Soup")->getPrice());
+    ASSERT_FLOAT_EQ(1, store.findItem("Soup")->getMarkdown());
+    ASSERT_FLOAT_EQ(3, store.findItemByGtin(36000291452ULL)->getPrice());
+    ASSERT_FLOAT_EQ(2, chain->findItem("Soup")->getPrice()); // Chain untouched
+
+    // Specials must match the sale type
+    ASSERT_FALSE(store.setItemSpecial("Beef", std::make_shared<NforX>(2, 5)));
+    ASSERT_TRUE(store.setItemSpecial("Beef", std::make_shared<BuyOneGetOneWeight>(2, 1, 50)));
+    ASSERT_NE(nullptr, store.findItem("Beef")->getSpecial());
+    ASSERT_EQ(nullptr, chain->findItem("Beef")->getSpecial());
+
+    ASSERT_TRUE(store.resetItem("Beef"));
+    ASSERT_FALSE(store.resetItem("Beef"));
+    ASSERT_EQ(chain->findItem("Beef"), store.findItem("Beef"));
+}
+
+TEST(StoreCatalogTests, OrdersUseStorePrices) {
+    auto chain = std::make_shared<ItemDatabase>();
+    chain->insertItem({"Soup", Item::Sale_t::Unit, 2});
+    chain->setItemSpecial("Soup", 2U, 3.0f);
+
+    StoreCatalog north(chain), south(chain);
+    ASSERT_TRUE(south.setItemPrice("Soup", 1.5));
+    ASSERT_TRUE(south.setItemSpecial("Soup", nullptr));
+
+    Order chainOrder(*chain), northOrder(north), southOrder(south);
+    for (int i = 0; i < 2; ++i) {
+        ASSERT_TRUE(chainOrder.ScanItem("Soup"));
+        ASSERT_TRUE(northOrder.ScanItem("Soup"));
+        ASSERT_TRUE(southOrder.ScanItem("Soup"));
+    }
+    ASSERT_FLOAT_EQ(3, chainOrder.getTotalPrice());
+    ASSERT_FLOAT_EQ(3, northOrder.getTotalPrice());
+    ASSERT_FLOAT_EQ(3, southOrder.getTotalPrice());
+    ASSERT_FALSE(southOrder.ScanItem("Milk"));
+}
+
+TEST(StoreCatalogTests, ReplaceBase) {
+    auto chain = std::make_shared<ItemDatabase>();
+    chain->insertItem({"Soup", Item::Sale_t::Unit, 2});
+    chain->insertItem({"Milk", Item::Sale_t::Unit, 4});
+
+    StoreCatalog store(chain);
+    const std::size_t emptyBytes = store.memoryBytes();
+    ASSERT_TRUE(store.setItemMarkdown("Soup", 0.5));
+    ASSERT_TRUE(store.setItemPrice("Milk", 3));
+    ASSERT_GT(store.memoryBytes(), emptyBytes);
+
+    // New chain prices show through, store fields stay and dropped items lose their override
+    auto next = std::make_shared<ItemDatabase>();
+    next->insertItem({"Soup", Item::Sale_t::Unit, 2.5});
+    store.setBase(next);
+    ASSERT_EQ(1U, store.getNumOverrides());
+    ASSERT_FLOAT_EQ(2.5, store.findItem("Soup")->getPrice());
+    ASSERT_FLOAT_EQ(0.5, store.findItem("Soup")->getMarkdown());
+    ASSERT_EQ(nullptr, store.findItem("Milk"));
+    ASSERT_EQ(next.get(), &store.getBase());
+}
+
+/**************************** Cart Event Tests *******************************/
+TEST(CartEventTests, OrderChangesAreStreamed) {
+    ItemDatabase db;
+    db.insertItem({"Soup", Item::Sale_t::Unit, 2});
+    db.insertItem({"Beef", Item::Sale_t::Weight, 5});
+    db.setItemSpecial("Soup", 1U, 1U, 100);
+
+    CartEventQueue queue(16);
+    Order ord(db);
+    ord.setEventQueue(&queue);
+    CartEvent event;
+
+    // New line and order total
+    ASSERT_TRUE(ord.ScanItem("Soup"));
+    ASSERT_TRUE(queue.pop(event));
+    ASSERT_EQ(CartEvent::Type_t::LineAdded, event.type);
+    ASSERT_STREQ("Soup", event.name);
+    ASSERT_FLOAT_EQ(1, event.amount);
+    ASSERT_FLOAT_EQ(2, event.price);
+    ASSERT_TRUE(queue.pop(event));
+    ASSERT_EQ(CartEvent::Type_t::TotalChanged, event.type);
+    ASSERT_FLOAT_EQ(2, event.price);
+    ASSERT_FALSE(queue.pop(event));
+
+    // Second unit triggers the special
+    ASSERT_TRUE(ord.ScanItem("Soup"));
+    ASSERT_TRUE(queue.pop(event));
+    ASSERT_EQ(CartEvent::Type_t::LineChanged, event.type);
+    ASSERT_FLOAT_EQ(2, event.amount);
+    ASSERT_TRUE(queue.pop(event));
+    ASSERT_EQ(CartEvent::Type_t::SpecialApplied, event.type);
+    ASSERT_EQ(SpecialParams::Type_t::BuyOneGetOneUnit, event.special.type);
+    ASSERT_FLOAT_EQ(2, event.savings);
+    ASSERT_TRUE(queue.pop(event));
+    ASSERT_EQ(CartEvent::Type_t::TotalChanged, event.type);
+    ASSERT_FLOAT_EQ(2, event.price);
+    ASSERT_FLOAT_EQ(2, event.savings);
+
+    // Failed operations send nothing, removals send the removed line
+    ASSERT_FALSE(ord.ScanItem("Milk"));
+    ASSERT_TRUE(ord.ScanItem("Beef", 2));
+    ASSERT_TRUE(queue.pop(event));
+    const uint64_t beefSequence = event.sequence;
+    ASSERT_TRUE(queue.pop(event));
+    ASSERT_TRUE(ord.RemoveItem("Beef", 5.0f));
+    ASSERT_TRUE(queue.pop(event));
+    ASSERT_EQ(CartEvent::Type_t::LineRemoved, event.type);
+    ASSERT_EQ(beefSequence, event.sequence);
+    ASSERT_TRUE(queue.pop(event));
+    ASSERT_EQ(CartEvent::Type_t::TotalChanged, event.type);
+    ASSERT_FLOAT_EQ(2, event.price);
+    ASSERT_FALSE(queue.pop(event));
+
+    // Detached orders send nothing
+    ord.setEventQueue(nullptr);
+    ASSERT_TRUE(ord.ScanItem("Soup"));
+    ASSERT_FALSE(queue.pop(event));
+}
+
+TEST(CartEventTests, FullQueueOverflows) {
+    ItemDatabase db;
+    db.insertItem({"Soup", Item::Sale_t::Unit, 2});
+
+    CartEventQueue queue(3);
+    ASSERT_EQ(4U, queue.getCapacity());
+    Order ord(db);
+    ord.setEventQueue(&queue);
+
+    ASSERT_TRUE(ord.ScanItem("Soup"));
+    ASSERT_TRUE(ord.ScanItem("Soup"));
+    ASSERT_FALSE(queue.takeOverflow());
+    ASSERT_TRUE(ord.ScanItem("Soup")); // Scanning works even if the display is behind
+    ASSERT_TRUE(queue.takeOverflow());
+    ASSERT_FALSE(queue.takeOverflow());
+    ASSERT_FLOAT_EQ(6, ord.getTotalPrice());
+
+    CartEvent event;
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.pop(event));
+    }
+    ASSERT_FALSE(queue.pop(event));
+}
+
+TEST(CartEventTests, DisplayThreadDrainsInOrder) {
+    CartEventQueue queue(64);
+    const uint64_t count = 10000;
+
+    // Both sides yield while waiting so the test stays quick on a single CPU
+    std::thread display([&]() {
+        CartEvent event;
+        uint64_t expected = 0;
+        while (expected < count) {
+            if (queue.pop(event)) {
+                EXPECT_EQ(expected, event.sequence);
+                ++expected;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    CartEvent event{};
+    for (uint64_t i = 0; i < count; ++i) {
+        event.sequence = i;
+        while (!queue.push(event)) {
+            std::this_thread::yield();
+        }
+    }
+    display.join();
+    CartEvent rest;
+    ASSERT_FALSE(queue.pop(rest));
+}
+
+/*************************** Sales Aggregator Tests **************************/
+TEST(SalesAggregatorTests, OrdersRecordIntoLanes) {
+    ItemDatabase db;
+    db.insertItem({"Soup", Item::Sale_t::Unit, 2});
+    db.insertItem({"Beef", Item::Sale_t::Weight, 5});
+    db.insertItem({"Milk", Item::Sale_t::Unit, 4});
+    db.setItemSpecial("Soup", 1U, 1U, 100);
+    db.setItemMarkdown("Beef", 1);
+
+    SalesAggregator sales(db.getItems().size(), 2);
+    Order first(db), second(db);
+    first.setSalesLane(&sales.getLane(0));
+    second.setSalesLane(&sales.getLane(1));
+
+    ASSERT_TRUE(first.ScanItem("Soup"));
+    ASSERT_TRUE(first.ScanItem("Soup"));
+    ASSERT_TRUE(first.ScanItem("Milk"));
+    ASSERT_TRUE(second.ScanItem("Soup"));
+    ASSERT_TRUE(second.ScanItem("Beef", 2));
+    ASSERT_TRUE(second.RemoveItem("Beef", 0.5f));
+    ASSERT_FALSE(second.ScanItem("Bread"));
+
+    // Nothing is visible before the merge
+    ASSERT_EQ(0, sales.getTotals().revenue);
+    sales.merge();
+
+    const uint32_t soup = db.findItem("Soup")->getCatalogIndex();
+    const uint32_t beef = db.findItem("Beef")->getCatalogIndex();
+    ASSERT_DOUBLE_EQ(3, sales.getItemSales(soup).amount);
+    ASSERT_DOUBLE_EQ(4, sales.getItemSales(soup).revenue);
+    ASSERT_DOUBLE_EQ(2, sales.getItemSales(soup).savings);
+    ASSERT_DOUBLE_EQ(1.5, sales.getItemSales(beef).amount);
+    ASSERT_DOUBLE_EQ(6, sales.getItemSales(beef).revenue);
+    ASSERT_DOUBLE_EQ(1.5, sales.getItemSales(beef).savings);
+
+    const double total = first.getTotalPrice() + second.getTotalPrice();
+    ASSERT_DOUBLE_EQ(total, sales.getTotals().revenue);
+    ASSERT_DOUBLE_EQ(first.getSavings() + second.getSavings(), sales.getTotals().savings);
+}
+
+TEST(SalesAggregatorTests, TopItems) {
+    ItemDatabase db;
+    db.insertItem({"Soup", Item::Sale_t::Unit, 2});
+    db.insertItem({"Milk", Item::Sale_t::Unit, 4});
+    db.insertItem({"Eggs", Item::Sale_t::Unit, 3});
+    db.insertItem({"Salt", Item::Sale_t::Unit, 1});
+
+    SalesAggregator sales(db.getItems().size(), 1);
+    Order ord(db);
+    ord.setSalesLane(&sales.getLane(0));
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(ord.ScanItem("Soup"));
+    }
+    ASSERT_TRUE(ord.ScanItem("Milk"));
+    ASSERT_TRUE(ord.ScanItem("Eggs"));
+    ASSERT_TRUE(ord.ScanItem("Eggs"));
+    ASSERT_TRUE(ord.ScanItem("Salt"));
+    ASSERT_TRUE(ord.RemoveItem("Salt", 1U)); // Undone sales are left out
+    sales.merge();
+
+    auto top = sales.getTopItems(2);
+    ASSERT_EQ(2U, top.size());
+    ASSERT_EQ("Soup", db.getItems()[top[0].first].getName()); // 6 revenue, before Eggs by index
+    ASSERT_EQ("Eggs", db.getItems()[top[1].first].getName());
+
+    top = sales.getTopItems(10, SalesAggregator::Rank_t::Amount);
+    ASSERT_EQ(3U, top.size());
+    ASSERT_EQ("Soup", db.getItems()[top[0].first].getName());
+    ASSERT_EQ("Eggs", db.getItems()[top[1].first].getName());
+    ASSERT_EQ("Milk", db.getItems()[top[2].first].getName());
+    ASSERT_TRUE(sales.getTopItems(0).empty());
+}
+
+TEST(SalesAggregatorTests, LanesRecordConcurrently) {
+    const std::size_t numItems = 5000;
+    const unsigned int numLanes = 4;
+    SalesAggregator sales(numItems, numLanes);
+
+    std::vector<std::thread> lanes;
+    for (unsigned int l = 0; l < numLanes; ++l) {
+        lanes.emplace_back([&sales, l]() {
+            SalesAggregator::Lane& lane = sales.getLane(l);
+            for (uint32_t item = 0; item < numItems; ++item) {
+                lane.record(item, 1, static_cast<float>(item % 7), 0);
+            }
+        });
+    }
+    // Merging while lanes record sees a consistent subset
+    sales.merge();
+    ASSERT_LE(sales.getTotals().amount, numItems * numLanes);
+    for (auto& lane : lanes) {
+        lane.join();
+    }
+
+    sales.merge();
+    ASSERT_DOUBLE_EQ(numItems * numLanes, sales.getTotals().amount);
+    ASSERT_DOUBLE_EQ(numLanes, sales.getItemSales(123).amount);
+    ASSERT_DOUBLE_EQ(6 * numLanes, sales.getTopItems(1)[0].second.revenue);
+    ASSERT_EQ(6U, sales.getTopItems(1)[0].first);
+}
+
+/**************************** Weight Session Tests ***************************/
+TEST(WeightSessionTests, EstimateMatchesSpecial) {
+    BuyOneGetOneWeight bogo(2, 1, 50);
+    BuyOneGetOneWeight limited(1.5, 0.5, 100, 7.25);
+    for (float weight = 0; weight < 20; weight += 0.125f) {
+        ASSERT_NEAR(bogo.calcPrice(weight, 3), WeightSession::estimatePrice(bogo.getParams(), weight, 3), 1e-3) << weight;
+        ASSERT_NEAR(limited.calcPrice(weight, 3), WeightSession::estimatePrice(limited.getParams(), weight, 3), 1e-3) << weight;
+    }
+    ASSERT_FLOAT_EQ(7.5, WeightSession::estimatePrice({}, 2.5, 3));
+}
+
+TEST(WeightSessionTests, StableWeightIsCommittedOnce) {
+    ItemDatabase db;
+    db.insertItem({"Beef", Item::Sale_t::Weight, 4});
+    db.setItemSpecial("Beef", 1.0f, 1.0f, 50);
+
+    Order ord(db);
+    ASSERT_TRUE(ord.ScanItem("Beef", 1));
+    ASSERT_EQ(nullptr, ord.getWeighing());
+    ASSERT_TRUE(ord.OpenWeighing("Beef", {0.01f, 3}));
+    ASSERT_FALSE(ord.OpenWeighing("Beef"));
+
+    // Product is still moving
+    ASSERT_EQ(WeightSession::State_t::Settling, ord.AddWeightSample(0.5f));
+    ASSERT_EQ(WeightSession::State_t::Settling, ord.AddWeightSample(1.2f));
+    ASSERT_FLOAT_EQ(1.2, ord.getWeighing()->getWeight());
+    ASSERT_FLOAT_EQ(2.8, ord.getWeighing()->getPrice()); // 1 lb half off and 0.2 lb full price
+    ASSERT_FALSE(ord.CommitWeighing());
+
+    // Jitter within tolerance settles on the average
+    ASSERT_EQ(WeightSession::State_t::Settling, ord.AddWeightSample(0.995f));
+    ASSERT_EQ(WeightSession::State_t::Settling, ord.AddWeightSample(1.005f));
+    ASSERT_EQ(WeightSession::State_t::Stable, ord.AddWeightSample(1.0f));
+    ASSERT_FLOAT_EQ(1, ord.getWeighing()->getWeight());
+    ASSERT_FLOAT_EQ(2, ord.getWeighing()->getPrice());
+    ASSERT_FLOAT_EQ(4, ord.getTotalPrice()); // Nothing scanned yet
+
+    ASSERT_TRUE(ord.CommitWeighing());
+    ASSERT_EQ(nullptr, ord.getWeighing());
+    ASSERT_FLOAT_EQ(6, ord.getTotalPrice());
+    ASSERT_EQ(1U, ord.getNumLines());
+}
+
+TEST(WeightSessionTests, EmptyScaleAndCancel) {
+    ItemDatabase db;
+    db.insertItem({"Beef", Item::Sale_t::Weight, 4});
+    db.insertItem({"Soup", Item::Sale_t::Unit, 2});
+
+    Order ord(db);
+    ASSERT_FALSE(ord.OpenWeighing("Soup"));
+    ASSERT_FALSE(ord.OpenWeighing("Milk"));
+    ASSERT_EQ(WeightSession::State_t::Empty, ord.AddWeightSample(1));
+    ASSERT_FALSE(ord.CommitWeighing());
+
+    ASSERT_TRUE(ord.OpenWeighing("Beef", {0.01f, 2}));
+    ASSERT_EQ(WeightSession::State_t::Settling, ord.AddWeightSample(2));
+    ASSERT_EQ(WeightSession::State_t::Stable, ord.AddWeightSample(2));
+    ASSERT_EQ(WeightSession::State_t::Empty, ord.AddWeightSample(0)); // Product taken off
+    ASSERT_FLOAT_EQ(0, ord.getWeighing()->getPrice());
+    ASSERT_FALSE(ord.CommitWeighing());
+
+    ord.CancelWeighing();
+    ASSERT_EQ(nullptr, ord.getWeighing());
+    ASSERT_FLOAT_EQ(0, ord.getTotalPrice());
+    ASSERT_TRUE(ord.OpenWeighing("Beef"));
+}
+
+/**************************** Static Catalog Tests ***************************/
+// Build an ItemDatabase with the same items as a generated catalog
+static void fillFromStaticCatalog(ItemDatabase& db) {
+    for (const StaticItem& entry : KioskCatalog::kItems) {
+        Item item(std::string(entry.name), entry.saleType, entry.price);
+        item.setMarkdown(entry.markdown);
+        item.setGtin(entry.gtin);
+        switch (entry.special.type) {
+            case SpecialParams::Type_t::BuyOneGetOneUnit:
+                item.setSpecial(std::make_shared<BuyOneGetOneUnit>(entry.special.needed, entry.special.receive, entry.special.value * 100,
+                                                                   entry.special.limit));
+                break;
+            case SpecialParams::Type_t::BuyOneGetOneWeight:
+                item.setSpecial(std::make_shared<BuyOneGetOneWeight>(entry.special.needed, entry.special.receive, entry.special.value * 100,
+                                                                     entry.special.limit));
+                break;
+            case SpecialParams::Type_t::NforX:
+                item.setSpecial(std::make_shared<NforX>(entry.special.needed, entry.special.value, entry.special.limit));
+                break;
+            default:
+                break;
+        }
+        db.insertItem(item);
+    }
+}
+
+TEST(StaticCatalogTests, GeneratedCatalogIsConstexpr) {
+    using KioskOrder = StaticOrder<KioskCatalog>;
+    static_assert(KioskOrder::kNumItems == 5);
+    static_assert(KioskCatalog::kItems[KioskOrder::indexOf("Soup")].gtin == 36000291452ULL);
+    static_assert(KioskOrder::indexOf("Milk") == KioskOrder::kNotFound);
+    static_assert(KioskOrder::indexOfGtin(4006381333931ULL) == KioskOrder::indexOf("Bananas"));
+    static_assert(KioskCatalog::kItems[KioskOrder::indexOf("Chips")].special.type == SpecialParams::Type_t::BuyOneGetOneUnit);
+
+    KioskOrder ord;
+    ASSERT_TRUE(ord.ScanItem<KioskOrder::indexOf("Cola")>());
+    ASSERT_TRUE(ord.ScanItem<KioskOrder::indexOf("Cola")>());
+    ASSERT_TRUE(ord.ScanItem<KioskOrder::indexOf("Cola")>());
+    ASSERT_TRUE(ord.ScanItem<KioskOrder::indexOf("Ground Beef")>(1.5));
+    ASSERT_FALSE(ord.ScanItem<KioskOrder::indexOf("Ground Beef")>(0));
+    ASSERT_FLOAT_EQ(3 + 1.5 * 5.99, ord.getTotalPrice());
+    ASSERT_FLOAT_EQ(3, ord.getAmount("Cola"));
+    ASSERT_EQ(2U, ord.getNumLines());
+}
+
+TEST(StaticCatalogTests, PricesLikeOrder) {
+    ItemDatabase db;
+    fillFromStaticCatalog(db);
+    Order dynamic(db);
+    StaticOrder<KioskCatalog> kiosk;
+
+    auto both = [&](auto action) {
+        const bool expected = action(dynamic);
+        ASSERT_EQ(expected, action(kiosk));
+        ASSERT_EQ(dynamic.getTotalPrice(), kiosk.getTotalPrice());
+        ASSERT_EQ(dynamic.getSavings(), kiosk.getSavings());
+        ASSERT_EQ(dynamic.getNumLines(), kiosk.getNumLines());
+    };
+    for (int i = 0; i < 8; ++i) {
+        both([](auto& ord) { return ord.ScanItem("Chips"); });
+        both([](auto& ord) { return ord.ScanItem("Cola"); });
+        both([](auto& ord) { return ord.ScanItem("Ground Beef", 0.7f); });
+    }
+    both([](auto& ord) { return ord.ScanBarcode(36000291452ULL); });
+    both([](auto& ord) { return ord.ScanBarcode(4006381333931ULL, 2.25f); });
+    both([](auto& ord) { return ord.ScanBarcode(4006381333932ULL, 2.25f); });
+    both([](auto& ord) { return ord.ScanItem("Milk"); });
+    both([](auto& ord) { return ord.ScanItem("Soup", 1.0f); });
+    both([](auto& ord) { return ord.RemoveItem("Chips", 4U); });
+    both([](auto& ord) { return ord.RemoveItem("Ground Beef", 1.3f); });
+    both([](auto& ord) { return ord.RemoveItem("Cola", 0U); });
+    both([](auto& ord) { return ord.RemoveItem("Soup", 5U); });
+    both([](auto& ord) { return ord.RemoveItem("Soup", 1U); });
+}
+
+TEST(StaticCatalogTests, WriteCatalogHeader) {
+    ItemDatabase db;
+    db.insertItem({"Pie \"Apple\"", Item::Sale_t::Unit, 0.1f});
+    db.insertItem({"Bread", Item::Sale_t::Unit, 3});
+
+    std::ostringstream out;
+    ASSERT_FALSE(writeCatalogHeader(db, "9Kiosk", out));
+    ASSERT_FALSE(writeCatalogHeader(db, "Kiosk Catalog", out));
+    ASSERT_TRUE(writeCatalogHeader(db, "Kiosk", out));
+
+    const std::string header = out.str();
+    ASSERT_NE(std::string::npos, header.find("struct Kiosk {"));
+    ASSERT_NE(std::string::npos, header.find("#ifndef __KIOSK_HPP__"));
+    ASSERT_NE(std::string::npos, header.find("\"Pie \\\"Apple\\\"\""));
+    ASSERT_NE(std::string::npos, header.find("0.100000001f"));
+    ASSERT_LT(header.find("Bread"), header.find("Pie")); // Sorted by name
+}
+
+/**************************** Store Workload Tests ***************************/
+TEST(StoreWorkloadTests, CatalogMix) {
+    StoreWorkload::Params params;
+    params.numItems = 4000;
+    params.weightShare = 0.25;
+    params.bogoUnitShare = 0.1;
+    params.nforxShare = 0.2;
+    params.bogoWeightShare = 0;
+    StoreWorkload workload(params);
+
+    ItemDatabase db;
+    ASSERT_TRUE(workload.fillCatalog(db));
+    ASSERT_EQ(params.numItems, db.getItems().size());
+
+    std::size_t weight = 0, bogoUnit = 0, nforx = 0, bogoWeight = 0;
+    for (const auto& item : db.getItems()) {
+        weight += (Item::Sale_t::Weight == item.getSaleType());
+        const auto type = item.getSpecial() ? item.getSpecial()->getParams().type : SpecialParams::Type_t::None;
+        bogoUnit += (SpecialParams::Type_t::BuyOneGetOneUnit == type);
+        nforx += (SpecialParams::Type_t::NforX == type);
+        bogoWeight += (SpecialParams::Type_t::BuyOneGetOneWeight == type);
+    }
+    ASSERT_NEAR(0.25, weight / 4000.0, 0.03);
+    ASSERT_NEAR(0.1, bogoUnit / 3000.0, 0.03);
+    ASSERT_NEAR(0.2, nforx / 3000.0, 0.03);
+    ASSERT_EQ(0U, bogoWeight);
+}
+
+TEST(StoreWorkloadTests, BasketsAreRepeatableAndSkewed) {
+    StoreWorkload::Params params;
+    params.numItems = 1000;
+    params.meanBasketSize = 20;
+    params.voidRate = 0.1;
+    StoreWorkload workload(params);
+
+    std::mt19937_64 rng1(7), rng2(7);
+    std::vector<StoreWorkload::Action> a, b;
+    std::vector<std::size_t> counts(params.numItems);
+    std::size_t scans = 0, removals = 0;
+    for (int basket = 0; basket < 500; ++basket) {
+        workload.generateBasket(rng1, a);
+        workload.generateBasket(rng2, b);
+        ASSERT_EQ(a.size(), b.size());
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            ASSERT_EQ(a[i].item, b[i].item);
+            if (StoreWorkload::Action::Type_t::Scan == a[i].type) {
+                ++counts[a[i].item];
+                ++scans;
+                ASSERT_EQ(Item::Sale_t::Weight == workload.getSaleType(a[i].item), a[i].weight > 0);
+            } else {
+                ++removals; // Voids follow the scan of the same item
+                ASSERT_EQ(a[i - 1].item, a[i].item);
+            }
+        }
+    }
+    ASSERT_NEAR(20, scans / 500.0, 3);
+    ASSERT_NEAR(0.1, static_cast<double>(removals) / scans, 0.02);
+
+    // With Zipf popularity the top 10% of items get most scans
+    std::sort(counts.rbegin(), counts.rend());
+    const std::size_t top = std::accumulate(counts.begin(), counts.begin() + 100, std::size_t(0));
+    ASSERT_GT(top, scans / 2);
+}
+
+TEST(StoreWorkloadTests, BasketsRunThroughOrders) {
+    StoreWorkload::Params params;
+    params.numItems = 500;
+    StoreWorkload workload(params);
+    ItemDatabase db;
+    ASSERT_TRUE(workload.fillCatalog(db));
+
+    std::mt19937_64 rng(3);
+    std::vector<StoreWorkload::Action> basket;
+    for (int i = 0; i < 50; ++i) {
+        Order ord(db);
+        workload.generateBasket(rng, basket);
+        for (const auto& action : basket) {
+            const std::string& name = workload.getName(action.item);
+            const bool byWeight = (Item::Sale_t::Weight == workload.getSaleType(action.item));
+            if (StoreWorkload::Action::Type_t::Scan == action.type) {
+                ASSERT_TRUE(byWeight ? ord.ScanItem(name, action.weight) : ord.ScanItem(name));
+            } else {
+                ASSERT_TRUE(byWeight ? ord.RemoveItem(name, action.weight) : ord.RemoveItem(name, 1U));
+            }
+        }
+        ASSERT_GE(ord.getTotalPrice(), 0);
+    }
+}
+
+/***************************** Replicated Catalog Tests **********************/
+
+TEST(ReplicatedCatalogTests, ParseCpuList) {
+    std::vector<int> cpus;
+    ASSERT_TRUE(NumaTopology::parseCpuList("0-3,8,10-11", cpus));
+    ASSERT_EQ(std::vector<int>({0, 1, 2, 3, 8, 10, 11}), cpus);
+    ASSERT_TRUE(NumaTopology::parseCpuList("5", cpus));
+    ASSERT_EQ(std::vector<int>({5}), cpus);
+
+    ASSERT_FALSE(NumaTopology::parseCpuList("3-1", cpus));
+    ASSERT_FALSE(NumaTopology::parseCpuList("0-", cpus));
+    ASSERT_FALSE(NumaTopology::parseCpuList("a,1", cpus));
+    ASSERT_FALSE(NumaTopology::parseCpuList("1;2", cpus));
+
+    // Invalid lists fall back to a single node that can run anywhere
+    NumaTopology topology({"0-3", "x"});
+    ASSERT_EQ(1U, topology.getNumNodes());
+    ASSERT_TRUE(topology.getCpus(0).empty());
+    ASSERT_TRUE(topology.pinThread(0));
+    ASSERT_FALSE(topology.pinThread(1));
+
+    NumaTopology twoNodes({"0-1,4", "2-3"});
+    ASSERT_EQ(2U, twoNodes.getNumNodes());
+    ASSERT_EQ(1U, twoNodes.getNodeOfCpu(3));
+    ASSERT_EQ(0U, twoNodes.getNodeOfCpu(4));
+}
+
+TEST(ReplicatedCatalogTests, ReplicaPerNode) {
+    ItemDatabase db;
+    db.insertItem({"Chips", Item::Sale_t::Unit, 3});
+    db.insertItem({"Apple", Item::Sale_t::Weight, 1.49});
+    db.setItemSpecial("Chips", 1U, 1U, 100);
+
+    ReplicatedCatalog catalog(db, NumaTopology({"0", "0"}));
+    ASSERT_EQ(2U, catalog.getTopology().getNumNodes());
+    ASSERT_EQ(1U, catalog.getLaneNode(3));
+    auto first = catalog.getReplica(0);
+    auto second = catalog.getReplica(1);
+    ASSERT_NE(first, second);
+    ASSERT_NE(&first->getItems()[0], &second->getItems()[0]);
+
+    // Orders price the same on every node
+    for (const auto& replica : {first, second}) {
+        Order ord(*replica);
+        ASSERT_TRUE(ord.ScanItem("Chips"));
+        ASSERT_TRUE(ord.ScanItem("Chips"));
+        ASSERT_TRUE(ord.ScanItem("Apple", 2));
+        ASSERT_FLOAT_EQ(3 + 2 * 1.49, ord.getTotalPrice());
+    }
+}
+
+TEST(ReplicatedCatalogTests, DeltaReachesEveryNodeOrNone) {
+    ItemDatabase db;
+    db.insertItem({"Chips", Item::Sale_t::Unit, 3});
+    ReplicatedCatalog catalog(db, NumaTopology({"0", "0"}));
+    auto before = catalog.getReplica(1);
+
+    CatalogDelta delta;
+    delta.setItemPrice("Chips", 2.5);
+    delta.insertItem("Soda", Item::Sale_t::Unit, 1.99);
+    ASSERT_TRUE(catalog.applyDelta(delta));
+    ASSERT_EQ(1U, catalog.getVersion());
+    for (unsigned int node = 0; node < 2; ++node) {
+        ASSERT_FLOAT_EQ(2.5, catalog.getReplica(node)->getItem("Chips")->getPrice());
+        ASSERT_TRUE(catalog.getReplica(node)->getItem("Soda").has_value());
+    }
+    // Replicas taken before the update stay valid and unchanged
+    ASSERT_FLOAT_EQ(3, before->getItem("Chips")->getPrice());
+
+    CatalogDelta invalid;
+    invalid.setItemPrice("Chips", 1);
+    invalid.setItemPrice("Unknown", 1);
+    ASSERT_FALSE(catalog.applyDelta(invalid));
+    ASSERT_EQ(1U, catalog.getVersion());
+    for (unsigned int node = 0; node < 2; ++node) {
+        ASSERT_FLOAT_EQ(2.5, catalog.getReplica(node)->getItem("Chips")->getPrice());
+    }
+    ASSERT_FLOAT_EQ(2.5, catalog.getLocalReplica()->getItem("Chips")->getPrice());
+}
+
+/***************************** Item Cache Tests ******************************/
+
+TEST(ItemCacheTests, RepeatScansSkipCatalog) {
+    ItemDatabase db;
+    Item chip("Chips", Item::Sale_t::Unit, 3);
+    ASSERT_TRUE(chip.setGtin(makeGtin(3600029145ULL)));
+    ASSERT_TRUE(db.insertItem(chip));
+    ASSERT_TRUE(db.insertItem({"Apple", Item::Sale_t::Weight, 1.49}));
+
+    Order ord(db);
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(ord.ScanItem("Chips"));
+    }
+    ASSERT_TRUE(ord.ScanItem("Apple", 1));
+    ASSERT_TRUE(ord.RemoveItem("Chips", 1U));
+    ASSERT_TRUE(ord.ScanBarcode(chip.getGtin()));
+    ASSERT_TRUE(ord.ScanBarcode(chip.getGtin()));
+    ASSERT_FALSE(ord.ScanItem("Unknown"));
+    ASSERT_FLOAT_EQ(6 * 3 + 1.49, ord.getTotalPrice());
+
+    // Only the first lookup of each name and GTIN, and the unknown item, reach the catalog
+    ASSERT_EQ(4U, ord.getItemCache().getMisses());
+    ASSERT_EQ(6U, ord.getItemCache().getHits());
+}
+
+TEST(ItemCacheTests, CatalogChangesEmptyCache) {
+    ItemDatabase db;
+    db.insertItem({"Chips", Item::Sale_t::Unit, 3});
+    ItemCache cache(db);
+    const Item* first = cache.findItem("Chips");
+    ASSERT_EQ(first, cache.findItem("Chips"));
+
+    // Inserting may move items, so the cached pointer must not be returned anymore
+    for (int i = 0; i < 100; ++i) {
+        db.insertItem({"Item" + std::to_string(i), Item::Sale_t::Unit, 1});
+    }
+    ASSERT_EQ(db.findItem("Chips"), cache.findItem("Chips"));
+    ASSERT_EQ(1U, cache.getHits());
+    ASSERT_EQ(2U, cache.getMisses());
+
+    Order ord(db);
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_TRUE(db.setItemPrice("Chips", 2));
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    // The line is repriced at the new price of the catalog, not the cached one
+    ASSERT_FLOAT_EQ(2 * 2, ord.getTotalPrice());
+}
+
+TEST(ItemCacheTests, EntriesKeepSpecials) {
+    ItemDatabase db;
+    db.insertItem({"Chips", Item::Sale_t::Unit, 3});
+    db.insertItem({"Apple", Item::Sale_t::Weight, 2});
+    ASSERT_TRUE(db.setItemSpecial("Chips", 2U, 1U, 100));
+    ItemCache cache(db);
+    const ItemCache::Entry& entry = cache.findEntry("Chips");
+    ASSERT_EQ(db.findItem("Chips"), entry.item);
+    ASSERT_EQ(SpecialParams::Type_t::BuyOneGetOneUnit, entry.special.type);
+    ASSERT_FLOAT_EQ(2, entry.special.needed);
+    ASSERT_EQ(SpecialParams::Type_t::None, cache.findEntry("Apple").special.type);
+    ASSERT_EQ(nullptr, cache.findEntry("Unknown").item);
+
+    // A new special changes the epoch, so the next lookup copies it again
+    ASSERT_TRUE(db.setItemSpecial("Chips", 3U, 6.0f));
+    ASSERT_EQ(SpecialParams::Type_t::NforX, cache.findEntry("Chips").special.type);
+    ASSERT_EQ(4U, cache.getMisses());
+}
+
+TEST(ItemCacheTests, CachedSpecialsPriceLikeItems) {
+    ItemDatabase db;
+    db.insertItem({"Chips", Item::Sale_t::Unit, 3});
+    db.insertItem({"Soda", Item::Sale_t::Unit, 1.5});
+    db.insertItem({"Apple", Item::Sale_t::Weight, 2});
+    ASSERT_TRUE(db.setItemSpecial("Chips", 2U, 1U, 50, 6U));
+    ASSERT_TRUE(db.setItemSpecial("Soda", 3U, 4.0f));
+    ASSERT_TRUE(db.setItemSpecial("Apple", 1.0f, 0.5f, 100, 0.0f));
+
+    Order ord(db);
+    for (int i = 0; i < 8; ++i) {
+        ASSERT_TRUE(ord.ScanItem("Chips"));
+        ASSERT_TRUE(ord.ScanItem("Soda"));
+        ASSERT_TRUE(ord.ScanItem("Apple", 0.75f));
+    }
+    ASSERT_TRUE(ord.RemoveItem("Soda", 1U));
+    ASSERT_TRUE(ord.RemoveItem("Apple", 0.5f));
+    const float total = db.findItem("Chips")->getSpecial()->calcPrice(8, 3) +
+                        db.findItem("Soda")->getSpecial()->calcPrice(7, 1.5) +
+                        db.findItem("Apple")->getSpecial()->calcPrice(5.5, 2);
+    ASSERT_NEAR(total, ord.getTotalPrice(), 1e-4);
+    ASSERT_GT(ord.getItemCache().getHits(), 20U);
+}
+
+TEST(ItemCacheTests, StoreOverridesEmptyCache) {
+    auto base = std::make_shared<ItemDatabase>();
+    base->insertItem({"Chips", Item::Sale_t::Unit, 3});
+    StoreCatalog store(base);
+    ItemCache cache(store);
+    ASSERT_EQ(&base->getItems()[0], cache.findItem("Chips"));
+
+    // Override replaces the item seen by the store
+    ASSERT_TRUE(store.setItemPrice("Chips", 2));
+    ASSERT_FLOAT_EQ(2, cache.findItem("Chips")->getPrice());
+    ASSERT_TRUE(store.resetItem("Chips"));
+    ASSERT_EQ(&base->getItems()[0], cache.findItem("Chips"));
+    ASSERT_EQ(0U, cache.getHits());
+}
+
+/***************************** Void Scan Tests *******************************/
+
+TEST(VoidScanTests, VoidRestoresLines) {
+    ItemDatabase db;
+    db.insertItem({"Chips", Item::Sale_t::Unit, 3});
+    db.insertItem({"Apple", Item::Sale_t::Weight, 1.49});
+    db.setItemSpecial("Chips", 2U, 1U, 100);
+
+    Order ord(db);
+    ASSERT_FALSE(ord.VoidLastScan());
+    ASSERT_TRUE(ord.ScanItem("Apple", 1.1));
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_TRUE(ord.ScanItem("Apple", 0.7));
+    ASSERT_EQ(5U, ord.getNumVoidableScans());
+    ASSERT_FLOAT_EQ(6 + 1.8 * 1.49, ord.getTotalPrice());
+
+    // Weight goes back to exactly what it was
+    ASSERT_TRUE(ord.VoidLastScan());
+    Order::ReceiptLine lines[2];
+    ASSERT_EQ(2U, ord.getReceipt(lines, 2));
+    ASSERT_EQ(1.1f, lines[0].amount);
+    ASSERT_FLOAT_EQ(6 + 1.1 * 1.49, ord.getTotalPrice());
+
+    // Free item of the special voided
+    ASSERT_TRUE(ord.VoidLastScan());
+    ASSERT_FLOAT_EQ(6 + 1.1 * 1.49, ord.getTotalPrice());
+    ASSERT_TRUE(ord.VoidLastScan());
+    ASSERT_TRUE(ord.VoidLastScan());
+    ASSERT_EQ(1U, ord.getNumLines());
+    ASSERT_TRUE(ord.VoidLastScan());
+    ASSERT_EQ(0U, ord.getNumLines());
+    ASSERT_NEAR(0, ord.getTotalPrice(), 1e-5);
+    ASSERT_NEAR(0, ord.getSavings(), 1e-5);
+    ASSERT_FALSE(ord.VoidLastScan());
+}
+
+TEST(VoidScanTests, VoidKeepsPricingOfLine) {
+    ItemDatabase db;
+    db.insertItem({"Chips", Item::Sale_t::Unit, 3});
+    db.insertItem({"Salsa", Item::Sale_t::Unit, 4});
+
+    Order ord(db);
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_TRUE(db.setItemPrice("Chips", 2));
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_FLOAT_EQ(4, ord.getTotalPrice());
+
+    // Line goes back to the price it was scanned at
+    ASSERT_TRUE(ord.VoidLastScan());
+    ASSERT_FLOAT_EQ(3, ord.getTotalPrice());
+    ASSERT_FLOAT_EQ(3, ord.getTaxableSubtotal(0));
+
+    // Added lines keep their place on the receipt
+    ASSERT_TRUE(ord.ScanItem("Salsa"));
+    ASSERT_TRUE(ord.VoidLastScan());
+    ASSERT_TRUE(ord.ScanItem("Salsa"));
+    Order::ReceiptLine lines[2];
+    ASSERT_EQ(2U, ord.getReceipt(lines, 2));
+    ASSERT_EQ(0U, lines[0].sequence);
+    ASSERT_EQ(1U, lines[1].sequence);
+}
+
+TEST(VoidScanTests, RemovalsClearVoidableScans) {
+    ItemDatabase db;
+    db.insertItem({"Chips", Item::Sale_t::Unit, 3});
+    CartEventQueue queue(64);
+
+    Order ord(db);
+    ord.setEventQueue(&queue);
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_TRUE(ord.RemoveItem("Chips", 1U));
+    ASSERT_EQ(0U, ord.getNumVoidableScans());
+    ASSERT_FALSE(ord.VoidLastScan());
+
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ord.Reprice();
+    ASSERT_FALSE(ord.VoidLastScan());
+
+    // Voids are sent to the customer display like any other change
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_TRUE(ord.VoidLastScan());
+    CartEvent event;
+    CartEvent last{};
+    CartEvent line{};
+    while (queue.pop(event)) {
+        if (CartEvent::Type_t::LineChanged == event.type) {
+            line = event;
+        }
+        last = event;
+    }
+    ASSERT_EQ(CartEvent::Type_t::TotalChanged, last.type);
+    ASSERT_FLOAT_EQ(6, last.price);
+    ASSERT_FLOAT_EQ(2, line.amount);
+}
+
+/***************************** Memory Usage Tests ****************************/
+
+TEST(MemoryUsageTests, DatabaseBreakdown) {
+    ItemDatabase db;
+    const ItemDatabase::MemoryUsage empty = db.getMemoryUsage();
+    ASSERT_EQ(0U, empty.names);
+    ASSERT_EQ(0U, empty.specials);
+
+    db.insertItem({"Chips", Item::Sale_t::Unit, 3});
+    ASSERT_EQ(0U, db.getMemoryUsage().names); // Short names are stored inline
+    const std::string longName = "Extra Large Family Size Tortilla Chips";
+    db.insertItem({longName, Item::Sale_t::Unit, 5});
+    ItemDatabase::MemoryUsage usage = db.getMemoryUsage();
+    ASSERT_GE(usage.names, 2 * longName.size());
+    ASSERT_GT(usage.records, empty.records);
+    ASSERT_GT(usage.indexes, empty.indexes);
+
+    ASSERT_TRUE(db.setItemSpecial("Chips", 1U, 1U, 100));
+    usage = db.getMemoryUsage();
+    ASSERT_GE(usage.specials, sizeof(BuyOneGetOneUnit));
+    ASSERT_EQ(usage.total(), db.memoryBytes());
+
+    // A special shared by several items is counted once
+    auto special = std::make_shared<NforX>(3, 5);
+    CatalogDelta delta;
+    delta.setItemSpecial("Chips", special);
+    delta.setItemSpecial(longName, special);
+    ASSERT_TRUE(db.applyDelta(delta));
+    ASSERT_EQ(kSharedControlBytes + special->memoryBytes(), db.getMemoryUsage().specials);
+}
+
+TEST(MemoryUsageTests, DatabaseReserve) {
+    ItemDatabase db;
+    db.reserve(200);
+    db.insertItem({"Item0", Item::Sale_t::Unit, 1});
+    const Item* first = db.findItem("Item0");
+    const std::size_t records = db.getMemoryUsage().records;
+    for (int i = 1; i < 200; ++i) {
+        ASSERT_TRUE(db.insertItem({"Item" + std::to_string(i), Item::Sale_t::Unit, 1}));
+    }
+
+    // Records were neither moved nor grown
+    ASSERT_EQ(first, db.findItem("Item0"));
+    ASSERT_EQ(records, db.getMemoryUsage().records);
+}
+
+TEST(MemoryUsageTests, ReserveInvalidatesCache) {
+    ItemDatabase db;
+    db.insertItem({"Chips", Item::Sale_t::Unit, 3});
+    Order ord(db);
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+
+    // Growing moves the records, so the order must look the item up again
+    const uint64_t epoch = db.getEpoch();
+    db.reserve(1000);
+    ASSERT_EQ(epoch + 1, db.getEpoch());
+    db.reserve(10);
+    ASSERT_EQ(epoch + 1, db.getEpoch());
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_FLOAT_EQ(6, ord.getTotalPrice());
+}
+
+TEST(MemoryUsageTests, OrderBytes) {
+    ItemDatabase db;
+    const std::string longName = "Extra Large Family Size Tortilla Chips";
+    db.insertItem({longName, Item::Sale_t::Unit, 5});
+    db.insertItem({"Apple", Item::Sale_t::Weight, 1.49});
+
+    Order ord(db);
+    const std::size_t empty = ord.memoryBytes();
+    ASSERT_GE(empty, sizeof(Order));
+    ASSERT_TRUE(ord.ScanItem(longName));
+    ASSERT_GE(ord.memoryBytes(), empty + longName.size());
+    ASSERT_TRUE(ord.OpenWeighing("Apple"));
+    ASSERT_TRUE(ord.ScanItem("Apple", 1));
+
+    // Reserving the cart adds its buckets and the voidable scans up front
+    const std::size_t scanned = ord.memoryBytes();
+    ord.reserve(100);
+    ASSERT_GE(ord.memoryBytes(), scanned + 100 * sizeof(void*));
+}
+
+/***************************** Allocation Tests ******************************/
+
+// Global allocation hook. Counts allocations of the whole process while enabled
+static std::atomic<bool> gCountAllocations{false};
+static std::atomic<std::size_t> gAllocations{0};
+
+void* operator new(std::size_t size) {
+    if (gCountAllocations.load(std::memory_order_relaxed)) {
+        gAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    void* ptr = std::malloc(size ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    if (gCountAllocations.load(std::memory_order_relaxed)) {
+        gAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    const std::size_t alignment = static_cast<std::size_t>(align);
+    void* ptr = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+// GCC pairs inlined new expressions with the free below and warns, but the hook allocates with malloc
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+#pragma GCC diagnostic pop
+
+// Counts allocations from construction until stop
+class AllocationCounter {
+public:
+    AllocationCounter() {
+        gAllocations = 0;
+        gCountAllocations = true;
+    }
+    ~AllocationCounter() {
+        gCountAllocations = false;
+    }
+    std::size_t stop() {
+        gCountAllocations = false;
+        return gAllocations;
+    }
+};
+
+static const std::string kLongName = "Extra Large Family Size Tortilla Chips";
+
+static void fillAllocationDatabase(ItemDatabase& db) {
+    Item chip("Chips", Item::Sale_t::Unit, 3);
+    ASSERT_TRUE(chip.setGtin(makeGtin(3600029145ULL)));
+    ASSERT_TRUE(db.insertItem(chip));
+    ASSERT_TRUE(db.insertItem({kLongName, Item::Sale_t::Unit, 5}));
+    ASSERT_TRUE(db.insertItem({"Soda", Item::Sale_t::Unit, 1.99}));
+    ASSERT_TRUE(db.insertItem({"Apple", Item::Sale_t::Weight, 1.49}));
+    ASSERT_TRUE(db.setItemSpecial("Chips", 1U, 1U, 50));
+    ASSERT_TRUE(db.setItemSpecial("Soda", 3U, 5.0f));
+    ASSERT_TRUE(db.setItemSpecial("Apple", 1.0f, .5f, 100));
+}
+
+// Scripted lane workload touching every scan and removal path. Returns number of failed operations
+static int runAllocationScript(Order& ord) {
+    int failed = 0;
+    for (int i = 0; i < 3; ++i) {
+        failed += !ord.ScanItem("Chips");
+        failed += !ord.ScanBarcode(makeGtin(3600029145ULL));
+        failed += !ord.ScanItem(kLongName);
+        failed += !ord.ScanItem("Soda");
+        failed += !ord.ScanItem("Apple", 0.4f);
+    }
+    failed += !ord.RemoveItem("Chips", 2U);
+    failed += !ord.RemoveItem("Apple", 0.5f);
+    failed += !ord.ScanItem("Apple", 1.25f);
+    failed += !ord.VoidLastScan();
+    failed += !ord.RemoveItem(kLongName, 5U);
+    failed += !ord.ScanItem(kLongName);
+    failed += !ord.VoidLastScan();
+    failed += !ord.ScanItem(kLongName);
+    return failed;
+}
+
+TEST(AllocationTests, SteadyStateScansDontAllocate) {
+    ItemDatabase db;
+    fillAllocationDatabase(db);
+    CartEventQueue queue(1024);
+    SalesAggregator sales(db.getItems().size(), 1);
+
+    // Warm up the order, queue and sales lane with one customer
+    Order ord(db);
+    ord.setEventQueue(&queue);
+    ord.setSalesLane(&sales.getLane(0));
+    ASSERT_EQ(0, runAllocationScript(ord));
+    const float total = ord.getTotalPrice();
+    ord.Reset();
+
+    int failed = 0;
+    std::size_t allocations = 0;
+    {
+        AllocationCounter counter;
+        for (int customer = 0; customer < 10; ++customer) {
+            failed += runAllocationScript(ord);
+            ord.Reset();
+        }
+        allocations = counter.stop();
+    }
+    ASSERT_EQ(0, failed);
+    ASSERT_EQ(0U, allocations);
+
+    ASSERT_EQ(0, runAllocationScript(ord));
+    ASSERT_FLOAT_EQ(total, ord.getTotalPrice());
+}
+
+TEST(AllocationTests, HookSeesAllocations) {
+    ItemDatabase db;
+    fillAllocationDatabase(db);
+
+    // A fresh order has to allocate its cart, so the hook must see it
+    std::size_t allocations = 0;
+    {
+        AllocationCounter counter;
+        Order ord(db);
+        ord.ScanItem(kLongName);
+        allocations = counter.stop();
+    }
+    ASSERT_GT(allocations, 0U);
+}
+
+TEST(AllocationTests, ResetStartsNewCustomer) {
+    ItemDatabase db;
+    fillAllocationDatabase(db);
+    CartEventQueue queue(1024);
+
+    Order ord(db);
+    ord.setEventQueue(&queue);
+    ord.setLoyaltyMember(true);
+    ASSERT_EQ(0, runAllocationScript(ord));
+    ASSERT_TRUE(ord.OpenWeighing("Apple"));
+    ord.Reset();
+
+    ASSERT_EQ(0U, ord.getNumLines());
+    ASSERT_EQ(0U, ord.getNumVoidableScans());
+    ASSERT_EQ(nullptr, ord.getWeighing());
+    ASSERT_FLOAT_EQ(0, ord.getTotalPrice());
+    ASSERT_FLOAT_EQ(0, ord.getSavings());
+    ASSERT_FLOAT_EQ(0, ord.getTaxableSubtotal(0));
+    ASSERT_FALSE(ord.VoidLastScan());
+
+    // Display is told the order is empty
+    CartEvent event, last{};
+    while (queue.pop(event)) {
+        last = event;
+    }
+    ASSERT_EQ(CartEvent::Type_t::TotalChanged, last.type);
+    ASSERT_FLOAT_EQ(0, last.price);
+
+    ASSERT_TRUE(ord.ScanItem("Soda"));
+    Order::ReceiptLine line;
+    ASSERT_EQ(1U, ord.getReceipt(&line, 1));
+    ASSERT_EQ(0U, line.sequence);
+}
+
+// Catalog that runs out of memory building the items it is asked for
+class FailingCatalog : public ItemCatalog {
+public:
+    explicit FailingCatalog(const ItemDatabase& db) : mDatabase(db) {}
+    const Item* findItem(std::string_view name) const override {
+        if (mFail) {
+            throw std::bad_alloc();
+        }
+        return mDatabase.findItem(name);
+    }
+    const Item* findItemByGtin(uint64_t) const override { throw std::bad_alloc(); }
+    uint64_t getEpoch() const override { return mEpoch; }
+
+    bool mFail = false;
+    uint64_t mEpoch = 0;
+
+private:
+    const ItemDatabase& mDatabase;
+};
+
+TEST(AllocationTests, OutOfMemoryFailsScan) {
+    ItemDatabase db;
+    fillAllocationDatabase(db);
+    FailingCatalog catalog(db);
+    Order ord(catalog);
+    ASSERT_TRUE(ord.ScanItem("Soda"));
+
+    // Lookups that cannot allocate fail the operation instead of escaping the noexcept calls
+    catalog.mFail = true;
+    ++catalog.mEpoch;
+    ASSERT_FALSE(ord.ScanItem("Soda"));
+    ASSERT_FALSE(ord.ScanBarcode(makeGtin(3600029145ULL)));
+    ASSERT_FALSE(ord.RemoveItem("Soda", 1U));
+    ASSERT_FALSE(ord.VoidLastScan());
+    ASSERT_EQ(1U, ord.getNumLines());
+
+    catalog.mFail = false;
+    ASSERT_TRUE(ord.VoidLastScan());
+    ASSERT_EQ(0U, ord.getNumLines());
+}
+
+/***************************** Repricer Tests ********************************/
+
+// Build a set of baskets cycling through the items in the database
+static std::vector<Basket> makeBaskets(std::size_t count) {
+    std::vector<Basket> baskets(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        baskets[i].push_back({"Chips", static_cast<unsigned int>(i % 4 + 1)});
+        baskets[i].push_back({"Apple", 0.25f * (i % 7 + 1)});
+        if (i % 3 == 0) {
+            baskets[i].push_back({"Soda", 3U});
+        }
+    }
+    return baskets;
+}
+
+static void fillRepriceDatabase(ItemDatabase& db) {
+    db.insertItem({"Chips", Item::Sale_t::Unit, 3});
+    db.insertItem({"Soda", Item::Sale_t::Unit, 1.99});
+    db.insertItem({"Apple", Item::Sale_t::Weight, 1.49});
+    db.setItemSpecial("Chips", 1U, 1U, 50);
+    db.setItemSpecial("Soda", 3U, 5.0f);
+    db.setItemSpecial("Apple", 1.0f, .5f, 100);
+}
+
+TEST(RepricerTests, MatchesSequentialOrders) {
+    ItemDatabase db;
+    fillRepriceDatabase(db);
+    auto baskets = makeBaskets(1000);
+
+    Repricer repricer(db, 4);
+    auto result = repricer.reprice(baskets);
+    ASSERT_EQ(baskets.size(), result.totals.size());
+    ASSERT_EQ(0U, result.failedLines);
+
+    // Lines are scanned in one step each. Scanning unit by unit prices the same up to rounding
+    for (std::size_t i = 0; i < baskets.size(); ++i) {
+        Order ord(db), perUnit(db);
+        for (const auto& line : baskets[i]) {
+            if (std::holds_alternative<unsigned int>(line.amount)) {
+                ASSERT_TRUE(ord.ScanUnits(line.name, std::get<unsigned int>(line.amount)));
+                for (unsigned int n = 0; n < std::get<unsigned int>(line.amount); ++n) {
+                    perUnit.ScanItem(line.name);
+                }
+            } else {
+                ord.ScanItem(line.name, std::get<float>(line.amount));
+                perUnit.ScanItem(line.name, std::get<float>(line.amount));
+            }
+        }
+        ASSERT_EQ(ord.getTotalPrice(), result.totals[i]);
+        ASSERT_EQ(ord.getSavings(), result.savings[i]);
+        ASSERT_NEAR(perUnit.getTotalPrice(), result.totals[i], 1e-4);
+        ASSERT_NEAR(perUnit.getSavings(), result.savings[i], 1e-4);
+    }
+}
+
+TEST(RepricerTests, DeterministicAcrossThreadCounts) {
+    ItemDatabase db;
+    fillRepriceDatabase(db);
+    auto baskets = makeBaskets(5000);
+
+    auto single = Repricer(db, 1).reprice(baskets);
+    for (unsigned int threads : {2U, 3U, 8U}) {
+        auto multi = Repricer(db, threads).reprice(baskets);
+        ASSERT_EQ(single.totals, multi.totals);
+        ASSERT_EQ(single.savings, multi.savings);
+        ASSERT_EQ(single.total, multi.total);
+        ASSERT_EQ(single.totalSavings, multi.totalSavings);
+    }
+}
+
+TEST(RepricerTests, FailedLinesCounted) {
+    ItemDatabase db;
+    fillRepriceDatabase(db);
+    std::vector<Basket> baskets = { { {"Chips", 1U}, {"Unknown", 1U}, {"Apple", 2U} }, {} };
+
+    auto result = Repricer(db, 2).reprice(baskets);
+    ASSERT_EQ(2U, result.failedLines);
+    ASSERT_FLOAT_EQ(3, result.totals[0]);
+    ASSERT_FLOAT_EQ(0, result.totals[1]);
+    ASSERT_FLOAT_EQ(3, result.total);
+}
+
+/***************************** Promotion Simulator Tests *********************/
+
+TEST(PromotionSimulatorTests, CurrentPricingMatchesOrders) {
+    ItemDatabase db;
+    fillRepriceDatabase(db);
+    std::vector<Basket> baskets = makeBaskets(1000);
+    // Split lines are combined like an order does
+    baskets[1].push_back({"Chips", 1U});
+    baskets[2].push_back({"Apple", 0.5f});
+
+    PromotionSimulator sim(db);
+    ASSERT_EQ(0U, sim.addBaskets(baskets));
+    sim.build();
+    ASSERT_EQ(1000U, sim.getNumBaskets());
+    ASSERT_EQ(4U, sim.getNumAmounts("Chips"));
+
+    const RepriceResult expected = Repricer(db, 1).reprice(baskets);
+    double revenue = 0, discount = 0;
+    for (const char* name : {"Chips", "Soda", "Apple"}) {
+        const Item* item = db.findItem(name);
+        PromotionOutcome outcome;
+        ASSERT_TRUE(sim.evaluate(name, item->getSpecial()->getParams(), outcome));
+        ASSERT_DOUBLE_EQ(0, outcome.revenueDelta);
+        revenue += outcome.revenue;
+        discount += outcome.discount;
+    }
+    ASSERT_NEAR(expected.total, revenue, 1e-6 * expected.total);
+    ASSERT_NEAR(expected.totalSavings, discount, 1e-6 * expected.total);
+}
+
+TEST(PromotionSimulatorTests, CandidatesMatchRepricing) {
+    ItemDatabase db;
+    fillRepriceDatabase(db);
+    const std::vector<Basket> baskets = makeBaskets(1000);
+    PromotionSimulator sim(db);
+    sim.addBaskets(baskets);
+    sim.build();
+
+    // Chips at 3 for $5, 2 for $5 or BOGO free instead of BOGO 50%
+    const std::vector<SpecialParams> candidates = {
+        NforX(3, 5).getParams(), NforX(2, 5, 4).getParams(), BuyOneGetOneUnit(1, 1, 100).getParams(), SpecialParams{}};
+    std::vector<PromotionOutcome> outcomes;
+    ASSERT_TRUE(sim.evaluate("Chips", candidates, outcomes));
+    ASSERT_EQ(candidates.size(), outcomes.size());
+
+    const double before = Repricer(db, 1).reprice(baskets).total;
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        ItemDatabase variant;
+        fillRepriceDatabase(variant);
+        CatalogDelta delta;
+        if (SpecialParams::Type_t::NforX == candidates[i].type) {
+            delta.setItemNforX("Chips", candidates[i].needed, candidates[i].value, candidates[i].limit);
+        } else if (SpecialParams::Type_t::None == candidates[i].type) {
+            delta.clearItemSpecial("Chips");
+        } else {
+            delta.setItemBogo("Chips", candidates[i].needed, candidates[i].receive, candidates[i].value * 100);
+        }
+        ASSERT_TRUE(variant.applyDelta(delta));
+        const double after = Repricer(variant, 1).reprice(baskets).total;
+        ASSERT_NEAR(after - before, outcomes[i].revenueDelta, 1e-6 * before) << i;
+        ASSERT_DOUBLE_EQ(-outcomes[i].revenueDelta, outcomes[i].discountDelta);
+    }
+    // No special means no discount on chips
+    ASSERT_NEAR(0, outcomes[3].discount, 1e-6);
+}
+
+TEST(PromotionSimulatorTests, InvalidInput) {
+    ItemDatabase db;
+    fillRepriceDatabase(db);
+    PromotionSimulator sim(db);
+    std::vector<Basket> baskets(1);
+    baskets[0] = {{"Chips", 2U}, {"Unknown", 1U}, {"Chips", 1.5f}, {"Apple", 0U}};
+    ASSERT_EQ(3U, sim.addBaskets(baskets));
+
+    PromotionOutcome outcome;
+    ASSERT_FALSE(sim.evaluate("Chips", NforX(3, 5).getParams(), outcome)); // Not built yet
+    sim.build();
+    ASSERT_TRUE(sim.evaluate("Chips", NforX(3, 5).getParams(), outcome));
+    ASSERT_FLOAT_EQ(2, outcome.amount);
+    ASSERT_FALSE(sim.evaluate("Unknown", SpecialParams{}, outcome));
+    ASSERT_FALSE(sim.evaluate("Chips", BuyOneGetOneWeight(1, 1, 50).getParams(), outcome));
+    ASSERT_FALSE(sim.evaluate("Apple", NforX(3, 5).getParams(), outcome));
+    SpecialParams empty;
+    empty.type = SpecialParams::Type_t::NforX;
+    ASSERT_FALSE(sim.evaluate("Chips", empty, outcome));
+    SpecialParams tiny = BuyOneGetOneWeight(1, 0, 50).getParams();
+    tiny.needed = 1e-9f;
+    ASSERT_FALSE(sim.evaluate("Apple", tiny, outcome));
+}
+
+/***************************** Shared Catalog Tests **************************/
+
+// Returns shared memory name unique to this test process
+static std::string sharedName(const std::string& suffix) {
+    return "/checkout_tests_" + std::to_string(getpid()) + "_" + suffix;
+}
+
+TEST(SharedCatalogTests, PublishAndRead) {
+    const std::string name = sharedName("publish");
+    ItemDatabase db;
+    fillRepriceDatabase(db);
+    Item milk("Milk", Item::Sale_t::Unit, 2.5);
+    ASSERT_TRUE(milk.setGtin(makeGtin(3600029145ULL)));
+    ASSERT_TRUE(milk.setTaxCategory(2));
+    ASSERT_TRUE(db.insertItem(milk));
+    ASSERT_TRUE(db.setItemMarkdown("Milk", .5));
+
+    SharedCatalog publisher;
+    ASSERT_TRUE(publisher.create(name, 16, 256));
+    SharedCatalog reader;
+    ASSERT_TRUE(reader.open(name));
+    ASSERT_TRUE(SharedCatalog::unlink(name));
+    SharedCatalog::Record record;
+    ASSERT_EQ(0U, reader.getVersion());
+    ASSERT_EQ(0U, reader.size());
+    ASSERT_FALSE(reader.findItem("Milk", record));
+
+    ASSERT_TRUE(publisher.publish(db));
+    ASSERT_EQ(1U, reader.getVersion());
+    ASSERT_EQ(4U, reader.size());
+    uint64_t version = 0;
+    ASSERT_TRUE(reader.findItem("Milk", record, &version));
+    ASSERT_EQ(1U, version);
+    ASSERT_FLOAT_EQ(2.5, record.price);
+    ASSERT_FLOAT_EQ(.5, record.markdown);
+    ASSERT_EQ(2U, record.taxCategory);
+    std::string found;
+    ASSERT_TRUE(reader.findItemByGtin(makeGtin(3600029145ULL), record, found));
+    ASSERT_EQ("Milk", found);
+    ASSERT_FALSE(reader.findItemByGtin(makeGtin(3600029146ULL), record, found));
+
+    // Orders in a lane price through the shared catalog like against the database
+    SharedItemCatalog lane(reader);
+    Order shared(lane), local(db);
+    for (Order* ord : {&shared, &local}) {
+        for (int i = 0; i < 3; ++i) {
+            ASSERT_TRUE(ord->ScanItem("Chips"));
+        }
+        ASSERT_TRUE(ord->ScanItem("Apple", 1.5));
+        ASSERT_TRUE(ord->ScanBarcode(makeGtin(3600029145ULL)));
+    }
+    ASSERT_FLOAT_EQ(local.getTotalPrice(), shared.getTotalPrice());
+
+    // A change reaches the lane with the next version
+    ASSERT_TRUE(db.setItemPrice("Soda", 2.5));
+    ASSERT_TRUE(publisher.publish(db));
+    ASSERT_EQ(2U, lane.getEpoch());
+    ASSERT_FLOAT_EQ(2.5, lane.findItem("Soda")->getPrice());
+}
+
+TEST(SharedCatalogTests, Limits) {
+    const std::string name = sharedName("limits");
+    SharedCatalog missing;
+    ASSERT_FALSE(missing.open(name));
+    ASSERT_EQ(0U, missing.getVersion());
+
+    ItemDatabase db;
+    fillRepriceDatabase(db);
+    SharedCatalog publisher;
+    ASSERT_TRUE(publisher.create(name, 2, 64));
+    ASSERT_FALSE(publisher.publish(db));
+    ASSERT_EQ(0U, publisher.getVersion());
+
+    SharedCatalog reader;
+    ASSERT_TRUE(reader.open(name));
+    ASSERT_TRUE(SharedCatalog::unlink(name));
+    ItemDatabase small;
+    ASSERT_TRUE(small.insertItem({"Chips", Item::Sale_t::Unit, 3}));
+    ASSERT_FALSE(reader.publish(small));
+    ASSERT_TRUE(publisher.publish(small));
+    ASSERT_EQ(1U, reader.getVersion());
+    ASSERT_EQ(1U, reader.size());
+}
+
+TEST(SharedCatalogTests, RestartKeepsOldMappings) {
+    const std::string name = sharedName("restart");
+    ItemDatabase db;
+    fillRepriceDatabase(db);
+    auto publisher = std::make_unique<SharedCatalog>();
+    ASSERT_TRUE(publisher->create(name, 4, 64));
+    ASSERT_TRUE(publisher->publish(db));
+    SharedCatalog old;
+    ASSERT_TRUE(old.open(name));
+
+    // A restarted publisher with another size leaves the mapping of the old segment intact
+    publisher = std::make_unique<SharedCatalog>();
+    ASSERT_TRUE(publisher->create(name, 64, 1024));
+    SharedCatalog::Record record;
+    ASSERT_EQ(1U, old.getVersion());
+    ASSERT_TRUE(old.findItem("Chips", record));
+    ASSERT_FLOAT_EQ(3, record.price);
+
+    SharedCatalog reopened;
+    ASSERT_TRUE(reopened.open(name));
+    ASSERT_TRUE(SharedCatalog::unlink(name));
+    ASSERT_EQ(0U, reopened.getVersion());
+    ASSERT_TRUE(publisher->publish(db));
+    ASSERT_TRUE(reopened.findItem("Chips", record));
+    ASSERT_EQ(1U, old.getVersion());
+}
+
+TEST(SharedCatalogTests, ReadersSeeWholeVersions) {
+    const std::string name = sharedName("concurrent");
+    constexpr uint64_t kVersions = 200;
+    SharedCatalog publisher;
+    ASSERT_TRUE(publisher.create(name, 16, 256));
+    SharedCatalog reader;
+    ASSERT_TRUE(reader.open(name));
+    ASSERT_TRUE(SharedCatalog::unlink(name));
+
+    // Every version sets the price of Chips to the version and its markdown to half of it
+    std::thread writer([&publisher]() {
+        ItemDatabase db;
+        fillRepriceDatabase(db);
+        for (uint64_t v = 1; v <= kVersions; ++v) {
+            db.setItemMarkdown("Chips", 0);
+            db.setItemPrice("Chips", static_cast<float>(v));
+            db.setItemMarkdown("Chips", v / 2.0f);
+            publisher.publish(db);
+        }
+    });
+
+    uint64_t last = 0;
+    unsigned int torn = 0;
+    while (last < kVersions) {
+        SharedCatalog::Record record;
+        uint64_t version = 0;
+        if (reader.findItem("Chips", record, &version)) {
+            if (version < last || record.price != static_cast<float>(version) || record.markdown != version / 2.0f) {
+                ++torn;
+            }
+            last = version;
+        }
+    }
+    writer.join();
+    ASSERT_EQ(0U, torn);
+}
+
+/***************************** Price History Tests ***************************/
+
+TEST(PriceHistoryTests, RunLengthAsOf) {
+    ItemDatabase db;
+    fillRepriceDatabase(db);
+    Item milk("Milk", Item::Sale_t::Unit, 2.5);
+    ASSERT_TRUE(milk.setGtin(makeGtin(3600029145ULL)));
+    ASSERT_TRUE(db.insertItem(milk));
+
+    PriceHistory history;
+    ASSERT_TRUE(history.record(db, 100));
+    ASSERT_TRUE(history.record(db, 200));
+    ASSERT_TRUE(db.setItemPrice("Chips", 4));
+    ASSERT_TRUE(history.record(db, 300));
+    ASSERT_TRUE(db.setItemSpecial("Chips", 2U, 5.0f));
+    ASSERT_TRUE(db.setItemMarkdown("Milk", .5));
+    ASSERT_TRUE(history.record(db, 400));
+
+    // Unchanged records take no space
+    ASSERT_EQ(4U, history.getNumItems());
+    ASSERT_EQ(3U, history.getNumVersions("Chips"));
+    ASSERT_EQ(1U, history.getNumVersions("Soda"));
+    ASSERT_EQ(400, history.getLatestTime());
+
+    PriceHistory::State state;
+    ASSERT_FALSE(history.findAsOf("Chips", 99, state));
+    ASSERT_FALSE(history.findAsOf("Bread", 500, state));
+    ASSERT_TRUE(history.findAsOf("Chips", 299, state));
+    ASSERT_FLOAT_EQ(3, state.price);
+    ASSERT_EQ(SpecialParams::Type_t::BuyOneGetOneUnit, state.special.type);
+    ASSERT_TRUE(history.findAsOf("Chips", 300, state));
+    ASSERT_FLOAT_EQ(4, state.price);
+    ASSERT_TRUE(history.findAsOf("Chips", 1000, state));
+    ASSERT_EQ(SpecialParams::Type_t::NforX, state.special.type);
+
+    auto before = history.getItemAsOfGtin(makeGtin(3600029145ULL), 399);
+    auto after = history.getItemAsOfGtin(makeGtin(3600029145ULL), 400);
+    ASSERT_TRUE(before && after);
+    ASSERT_EQ("Milk", after->getName());
+    ASSERT_FLOAT_EQ(0, before->getMarkdown());
+    ASSERT_FLOAT_EQ(.5, after->getMarkdown());
+}
+
+TEST(PriceHistoryTests, RecordsOnlyForward) {
+    ItemDatabase db;
+    fillRepriceDatabase(db);
+    PriceHistory history;
+    ASSERT_EQ(INT64_MIN, history.getLatestTime());
+    ASSERT_TRUE(history.record(db, 200));
+    ASSERT_FALSE(history.record(db, 100));
+
+    // Changes of an item at the same time replace each other, changing back leaves one version
+    Item chips = *db.getItem("Chips");
+    ASSERT_FALSE(history.record(chips, 150));
+    ASSERT_TRUE(chips.setPrice(5));
+    ASSERT_TRUE(history.record(chips, 250));
+    ASSERT_EQ(2U, history.getNumVersions("Chips"));
+    ASSERT_TRUE(chips.setPrice(3));
+    ASSERT_TRUE(history.record(chips, 250));
+    ASSERT_EQ(1U, history.getNumVersions("Chips"));
+    ASSERT_EQ(250, history.getLatestTime());
+}
+
+TEST(PriceHistoryTests, GtinMovesBetweenItems) {
+    const uint64_t gtin = makeGtin(3600029145ULL);
+    Item chips("Chips", Item::Sale_t::Unit, 3);
+    Item soda("Soda", Item::Sale_t::Unit, 1.99);
+    ASSERT_TRUE(chips.setGtin(gtin));
+    PriceHistory history;
+    ASSERT_TRUE(history.record(chips, 100));
+    ASSERT_TRUE(history.record(soda, 100));
+
+    // The barcode moves to Soda, which is recorded before Chips loses it
+    ASSERT_TRUE(chips.setGtin(0));
+    ASSERT_TRUE(soda.setGtin(gtin));
+    ASSERT_TRUE(history.record(soda, 200));
+    ASSERT_TRUE(history.record(chips, 200));
+    auto found = history.getItemAsOfGtin(gtin, 200);
+    ASSERT_TRUE(found);
+    ASSERT_EQ("Soda", found->getName());
+
+    AsOfCatalog asOf(history, 200);
+    ASSERT_NE(nullptr, asOf.findItemByGtin(gtin));
+    ASSERT_EQ("Soda", asOf.findItemByGtin(gtin)->getName());
+}
+
+TEST(PriceHistoryTests, GtinLookupsAsOfTime) {
+    const uint64_t gtin = makeGtin(3600029145ULL);
+    Item chips("Chips", Item::Sale_t::Unit, 3);
+    Item soda("Soda", Item::Sale_t::Unit, 1.99);
+    ASSERT_TRUE(chips.setGtin(gtin));
+    PriceHistory history;
+    ASSERT_TRUE(history.record(chips, 100));
+    ASSERT_TRUE(history.record(soda, 100));
+
+    // Chips gives up the barcode, which stays unused until Soda takes it
+    ASSERT_TRUE(chips.setGtin(0));
+    ASSERT_TRUE(history.record(chips, 200));
+    ASSERT_TRUE(soda.setGtin(gtin));
+    ASSERT_TRUE(history.record(soda, 300));
+    ASSERT_EQ(2U, history.getNumVersions("Chips"));
+
+    ASSERT_FALSE(history.getItemAsOfGtin(gtin, 50));
+    auto found = history.getItemAsOfGtin(gtin, 150);
+    ASSERT_TRUE(found);
+    ASSERT_EQ("Chips", found->getName());
+    ASSERT_EQ(gtin, found->getGtin());
+    ASSERT_FALSE(history.getItemAsOfGtin(gtin, 250));
+    found = history.getItemAsOfGtin(gtin, 300);
+    ASSERT_TRUE(found);
+    ASSERT_EQ("Soda", found->getName());
+
+    AsOfCatalog asOf(history, 150);
+    ASSERT_NE(nullptr, asOf.findItemByGtin(gtin));
+    ASSERT_EQ("Chips", asOf.findItemByGtin(gtin)->getName());
+}
+
+TEST(PriceHistoryTests, GtinReplacedAtSameTime) {
+    const uint64_t gtin = makeGtin(3600029145ULL);
+    Item chips("Chips", Item::Sale_t::Unit, 3);
+    Item soda("Soda", Item::Sale_t::Unit, 1.99);
+    PriceHistory history;
+    ASSERT_TRUE(history.record(soda, 100));
+    ASSERT_TRUE(soda.setGtin(gtin));
+    ASSERT_TRUE(history.record(soda, 200));
+
+    // A correction at the same time withdraws the claim of the replaced version
+    ASSERT_TRUE(chips.setGtin(gtin));
+    ASSERT_TRUE(history.record(chips, 300));
+    ASSERT_TRUE(chips.setGtin(0));
+    ASSERT_TRUE(history.record(chips, 300));
+    auto found = history.getItemAsOfGtin(gtin, 300);
+    ASSERT_TRUE(found);
+    ASSERT_EQ("Soda", found->getName());
+}
+
+TEST(PriceHistoryTests, OrderPricesAsOf) {
+    ItemDatabase db;
+    fillRepriceDatabase(db);
+    PriceHistory history;
+    ASSERT_TRUE(history.record(db, 100));
+    ItemDatabase then;
+    fillRepriceDatabase(then);
+    ASSERT_TRUE(db.setItemPrice("Chips", 4));
+    ASSERT_TRUE(db.setItemSpecial("Apple", 2.0f, 1.0f, 50));
+    ASSERT_TRUE(history.record(db, 200));
+
+    // A basket priced as of a past time matches the catalog of that time
+    AsOfCatalog asOf(history, 150);
+    Order past(asOf), expected(then);
+    for (Order* ord : {&past, &expected}) {
+        for (int i = 0; i < 3; ++i) {
+            ASSERT_TRUE(ord->ScanItem("Chips"));
+        }
+        ASSERT_TRUE(ord->ScanItem("Apple", 2.5));
+        ASSERT_TRUE(ord->ScanItem("Soda"));
+    }
+    ASSERT_FLOAT_EQ(expected.getTotalPrice(), past.getTotalPrice());
+
+    // Moving the view reprices against the later catalog
+    asOf.setTime(250);
+    ASSERT_EQ(1U, asOf.getEpoch());
+    past.Reprice();
+    Order now(db);
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(now.ScanItem("Chips"));
+    }
+    ASSERT_TRUE(now.ScanItem("Apple", 2.5));
+    ASSERT_TRUE(now.ScanItem("Soda"));
+    ASSERT_FLOAT_EQ(now.getTotalPrice(), past.getTotalPrice());
+
+    asOf.setTime(50);
+    ASSERT_EQ(nullptr, asOf.findItem("Chips"));
+}
+
+/***************************** Catalog File Tests ****************************/
+
+TEST(CatalogFileTests, LoadCatalog) {
+    std::istringstream in("# Test catalog\n"
+                          "item,Chips,unit,3\n"
+                          "item,Apple,weight,1.49\n"
+                          "\n"
+                          "markdown,Chips,.5\n"
+                          "bogo,Chips,1,1,100,4\n"
+                          "bogo,Apple,1.5,.5,50\n"
+                          "price,Apple,1.99\n");
+    ItemDatabase db;
+    ASSERT_TRUE(loadCatalog(in, db));
+
+    ASSERT_FLOAT_EQ(3, db.getItem("Chips")->getPrice());
+    ASSERT_FLOAT_EQ(.5, db.getItem("Chips")->getMarkdown());
+    ASSERT_NE(nullptr, db.getItem("Chips")->getSpecial());
+    ASSERT_EQ(Item::Sale_t::Weight, db.getItem("Apple")->getSaleType());
+    ASSERT_FLOAT_EQ(1.99, db.getItem("Apple")->getPrice());
+    ASSERT_NE(nullptr, db.getItem("Apple")->getSpecial());
+}
+
+TEST(CatalogFileTests, LoadCatalogInvalidRecord) {
+    for (const char* text : { "item,Chips,each,3\n", "item,Chips,unit,abc\n", "price,Chips,1\n",
+                              "item,Chips,unit,3\nnforx,Chips,-3,5\n", "coupon,Chips\n",
+                              "item,Chips,unit,3\nnforx,Chips,0,5\n", "item,Chips,unit,3\nbogo,Chips,0,0,50\n",
+                              "item,Apple,weight,1.49\nbogo,Apple,0,0,50\n" }) {
+        std::istringstream in(text);
+        ItemDatabase db;
+        ASSERT_FALSE(loadCatalog(in, db));
+    }
+}
+
+/***************************** Catalog Delta Tests ***************************/
+
+TEST(CatalogDeltaTests, ApplyDeltaPublishesOneEpoch) {
+    ItemDatabase db;
+    db.insertItem({"Chips", Item::Sale_t::Unit, 3});
+    db.insertItem({"Apple", Item::Sale_t::Weight, 1.49});
+    uint64_t epoch = db.getEpoch();
+
+    std::istringstream in("price,Chips,2.5\n"
+                          "bogo,Chips,2,1,100\n"
+                          "item,Soda,unit,1.99\n"
+                          "nforx,Soda,3,5\n"
+                          "markdown,Apple,.25\n");
+    CatalogDelta delta;
+    ASSERT_TRUE(delta.parse(in));
+    ASSERT_EQ(5U, delta.size());
+    ASSERT_TRUE(db.applyDelta(delta));
+
+    ASSERT_EQ(epoch + 1, db.getEpoch());
+    ASSERT_FLOAT_EQ(2.5, db.getItem("Chips")->getPrice());
+    ASSERT_NE(nullptr, db.getItem("Chips")->getSpecial());
+    ASSERT_NE(nullptr, db.getItem("Soda")->getSpecial());
+    ASSERT_FLOAT_EQ(.25, db.getItem("Apple")->getMarkdown());
+}
+
+TEST(CatalogDeltaTests, InvalidDeltaLeavesDatabaseUntouched) {
+    ItemDatabase db;
+    db.insertItem({"Chips", Item::Sale_t::Unit, 3});
+    db.insertItem({"Apple", Item::Sale_t::Weight, 1.49});
+    db.setItemSpecial("Chips", 1U, 1U, 100);
+    uint64_t epoch = db.getEpoch();
+
+    // Each delta has a valid change followed by an invalid one
+    std::vector<CatalogDelta> deltas(4);
+    deltas[0].setItemPrice("Chips", 1);
+    deltas[0].setItemPrice("Unknown", 1);
+    deltas[1].clearItemSpecial("Chips");
+    deltas[1].setItemNforX("Apple", 2, 3);
+    deltas[2].insertItem("Soda", Item::Sale_t::Unit, 1.99);
+    deltas[2].insertItem("Chips", Item::Sale_t::Unit, 1.99);
+    deltas[3].setItemPrice("Chips", 1);
+    deltas[3].setItemBogo("Chips", 1.5, 1, 100);
+
+    for (const auto& delta : deltas) {
+        ASSERT_FALSE(db.applyDelta(delta));
+    }
+    ASSERT_EQ(epoch, db.getEpoch());
+    ASSERT_FLOAT_EQ(3, db.getItem("Chips")->getPrice());
+    ASSERT_NE(nullptr, db.getItem("Chips")->getSpecial());
+    ASSERT_FALSE(db.getItem("Soda").has_value());
+}
+
+TEST(CatalogDeltaTests, ZeroAmountSpecialsRejected) {
+    ItemDatabase db;
+    db.insertItem({"Chips", Item::Sale_t::Unit, 3});
+    db.insertItem({"Apple", Item::Sale_t::Weight, 1.49});
+
+    // Specials that would divide by zero or loop forever when an item is scanned
+    std::vector<CatalogDelta> deltas(3);
+    deltas[0].setItemNforX("Chips", 0, 5);
+    deltas[1].setItemBogo("Chips", 0, 0, 50);
+    deltas[2].setItemBogo("Apple", 0, 0, 50);
+    for (const auto& delta : deltas) {
+        ASSERT_FALSE(db.applyDelta(delta));
+    }
+    ASSERT_FALSE(db.setItemSpecial("Chips", 0U, 5.0f));
+    ASSERT_FALSE(db.setItemSpecial("Chips", 0U, 0U, 50));
+    ASSERT_FALSE(db.setItemSpecial("Apple", 0.0f, 0.0f, 50));
+    ASSERT_EQ(nullptr, db.getItem("Chips")->getSpecial());
+    ASSERT_EQ(nullptr, db.getItem("Apple")->getSpecial());
+
+    // Receiving without needing anything is a plain discount and still allowed
+    ASSERT_TRUE(db.setItemSpecial("Apple", 0.0f, 1.0f, 50));
+    Order ord(db);
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_TRUE(ord.ScanItem("Apple", 2));
+    ASSERT_FLOAT_EQ(3 + 2 * 1.49 * .5, ord.getTotalPrice());
+}
+
+TEST(CatalogDeltaTests, SmallInsertsDoNotCopyCatalog) {
+    ItemDatabase db;
+    db.insertItem({"Chips", Item::Sale_t::Unit, 3});
+
+    // Records grow geometrically, so one insert per delta rarely moves the catalog
+    std::size_t moves = 0;
+    for (int i = 0; i < 1000; ++i) {
+        const Item* records = db.getItems().data();
+        CatalogDelta delta;
+        delta.insertItem("Item " + std::to_string(i), Item::Sale_t::Unit, 1);
+        ASSERT_TRUE(db.applyDelta(delta));
+        moves += (records != db.getItems().data());
+    }
+    ASSERT_LE(moves, 12U);
+}
+
+TEST(CatalogDeltaTests, ClearSpecialEndsPromotion) {
+    ItemDatabase db;
+    db.insertItem({"Chips", Item::Sale_t::Unit, 3});
+    db.setItemSpecial("Chips", 1U, 1U, 100);
+
+    CatalogDelta delta;
+    delta.clearItemSpecial("Chips");
+    ASSERT_TRUE(db.applyDelta(delta));
+    ASSERT_EQ(nullptr, db.getItem("Chips")->getSpecial());
+
+    Order ord(db);
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_FLOAT_EQ(6, ord.getTotalPrice());
+}
+
+/***************************** Live Catalog Tests ****************************/
+
+TEST(LiveCatalogTests, SnapshotsSeeWholeDeltas) {
+    auto db = std::make_shared<ItemDatabase>();
+    db->insertItem({"Chips", Item::Sale_t::Unit, 3});
+    db->insertItem({"Apple", Item::Sale_t::Weight, 1.49});
+    LiveCatalog catalog(db);
+    auto before = catalog.getSnapshot();
+
+    CatalogDelta delta;
+    delta.setItemPrice("Chips", 2.5);
+    delta.setItemBogo("Chips", 1, 1, 100);
+    delta.insertItem("Soda", Item::Sale_t::Unit, 1.99, makeGtin(3600029145ULL));
+    ASSERT_TRUE(catalog.applyDelta(delta));
+    ASSERT_EQ(1U, catalog.getEpoch());
+
+    // Snapshots taken before the delta do not see any of it
+    ASSERT_FLOAT_EQ(3, before->findItem("Chips")->getPrice());
+    ASSERT_EQ(nullptr, before->findItem("Chips")->getSpecial());
+    ASSERT_EQ(nullptr, before->findItem("Soda"));
+
+    auto after = catalog.getSnapshot();
+    ASSERT_EQ(3U, after->size());
+    ASSERT_EQ("Soda", after->findItemByGtin(makeGtin(3600029145ULL))->getName());
+    ASSERT_EQ(2U, after->findItem("Soda")->getCatalogIndex());
+    Order ord(*after);
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_TRUE(ord.ScanItem("Chips"));
+    ASSERT_TRUE(ord.ScanBarcode(makeGtin(3600029145ULL)));
+    ASSERT_FLOAT_EQ(2.5 + 1.99, ord.getTotalPrice());
+
+    // An invalid delta publishes nothing
+    CatalogDelta invalid;
+    invalid.setItemPrice("Apple", 1);
+    invalid.insertItem("Cola", Item::Sale_t::Unit, 1, makeGtin(3600029145ULL));
+    ASSERT_FALSE(catalog.applyDelta(invalid));
+    ASSERT_EQ(after, catalog.getSnapshot());
+    ASSERT_FLOAT_EQ(1.49, catalog.getSnapshot()->findItem("Apple")->getPrice());
+}
+
+TEST(LiveCatalogTests, MatchesDatabaseThroughFolds) {
+    ItemDatabase expected;
+    for (uint64_t i = 0; i < 64; ++i) {
+        Item item("Item " + std::to_string(i), Item::Sale_t::Unit, 1);
+        item.setGtin(makeGtin(7000000000ULL + i));
+        expected.insertItem(item);
+    }
+    expected.finalize();
+    LiveCatalog catalog(std::make_shared<const ItemDatabase>(expected));
+
+    // Small deltas pile up into layers that are merged and folded into the base
+    std::size_t maxLayers = 0;
+    for (uint64_t d = 0; d < 200; ++d) {
+        CatalogDelta delta;
+        delta.setItemPrice("Item " + std::to_string(d * 7 % 64), 1 + d % 10);
+        if (d % 5 == 0) {
+            delta.insertItem("New " + std::to_string(d), Item::Sale_t::Unit, 2, makeGtin(8000000000ULL + d));
+        }
+        ASSERT_TRUE(catalog.applyDelta(delta));
+        ASSERT_TRUE(expected.applyDelta(delta));
+        maxLayers = std::max(maxLayers, catalog.getSnapshot()->numLayers());
+    }
+    ASSERT_LE(maxLayers, 6U);
+
+    auto snapshot = catalog.getSnapshot();
+    ASSERT_EQ(200U, snapshot->getEpoch());
+    ASSERT_EQ(expected.getItems().size(), snapshot->size());
+    for (const auto& item : expected.getItems()) {
+        const Item* found = snapshot->findItemByGtin(item.getGtin());
+        ASSERT_NE(nullptr, found);
+        ASSERT_EQ(item.getName(), found->getName());
+        ASSERT_EQ(item.getPrice(), found->getPrice());
+        ASSERT_EQ(item.getCatalogIndex(), found->getCatalogIndex());
+    }
+}
+
+TEST(LiveCatalogTests, ReadersNeverSeeHalfADelta) {
+    auto db = std::make_shared<ItemDatabase>();
+    db->insertItem({"Chips", Item::Sale_t::Unit, 1});
+    db->insertItem({"Salsa", Item::Sale_t::Unit, 1});
+    LiveCatalog catalog(db);
+
+    // Every delta moves both prices together, so a snapshot must never show them apart
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+    std::thread reader([&]() {
+        while (!done.load()) {
+            auto snapshot = catalog.getSnapshot();
+            if (snapshot->findItem("Chips")->getPrice() != snapshot->findItem("Salsa")->getPrice()) {
+                ++torn;
+            }
+            std::this_thread::yield();
+        }
+    });
+    for (int i = 2; i < 2000; ++i) {
+        CatalogDelta delta;
+        delta.setItemPrice("Chips", i);
+        delta.setItemPrice("Salsa", i);
+        ASSERT_TRUE(catalog.applyDelta(delta));
+    }
+    done = true;
+    reader.join();
+    ASSERT_EQ(0, torn.load());
+    ASSERT_FLOAT_EQ(1999, catalog.getSnapshot()->findItem("Salsa")->getPrice());
+}
+
+/***************************** Item Search Tests *****************************/
+
+// Returns names of search results
+static std::vector<std::string> searchNames(const ItemDatabase& db, std::string_view query, std::size_t maxResults = 10) {
+    std::vector<std::string> names;
+    for (const Item* item : db.searchItems(query, maxResults)) {
+        names.push_back(item->getName());
+    }
+    return names;
+}
+
+TEST(ItemSearchTests, PrefixRanking) {
+    ItemDatabase db;
+    for (const char* name : { "Granny Smith Apple", "Apple Juice", "Apples Red Delicious", "Pineapple", "Apple", "Banana" }) {
+        ASSERT_TRUE(db.insertItem({name, Item::Sale_t::Unit, 1}));
+    }
+
+    // Names starting with the query rank first, shorter names first
+    std::vector<std::string> expected = { "Apple", "Apple Juice", "Apples Red Delicious", "Granny Smith Apple" };
+    ASSERT_EQ(expected, searchNames(db, "app"));
+    ASSERT_EQ(expected, searchNames(db, "APP"));
+    expected.resize(2);
+    ASSERT_EQ(expected, searchNames(db, "ap", 2));
+
+    // Every word must match
+    expected = { "Granny Smith Apple" };
+    ASSERT_EQ(expected, searchNames(db, "gr app"));
+    ASSERT_TRUE(searchNames(db, "juice banana").empty());
+    ASSERT_TRUE(searchNames(db, "  ").empty());
+}
+
+TEST(ItemSearchTests, TypoFallback) {
+    ItemDatabase db;
+    for (const char* name : { "Banana", "Bread", "Broccoli" }) {
+        ASSERT_TRUE(db.insertItem({name, Item::Sale_t::Unit, 1}));
+    }
+
+    std::vector<std::string> expected = { "Banana" };
+    ASSERT_EQ(expected, searchNames(db, "bnan"));   // Deletion
+    ASSERT_EQ(expected, searchNames(db, "bannan")); // Insertion
+    ASSERT_EQ(expected, searchNames(db, "bamana")); // Substitution
+    ASSERT_EQ(expected, searchNames(db, "abnana")); // Transposition
+    ASSERT_TRUE(searchNames(db, "xyzzy").empty());
+}
+
+TEST(ItemSearchTests, TyposStayCheapInLargeCatalog) {
+    ItemDatabase db;
+    const char* kinds[] = { "Apple", "Chicken Breast", "Cheddar", "Bread", "Juice" };
+    for (int i = 0; i < 30000; ++i) {
+        ASSERT_TRUE(db.insertItem({std::string("Smith ") + kinds[i % 5] + " " + std::to_string(i), Item::Sale_t::Unit, 1}));
+    }
+    ASSERT_TRUE(db.insertItem({"Granny Smith Apple", Item::Sale_t::Unit, 1}));
+
+    std::vector<std::string> expected = { "Granny Smith Apple" };
+    ASSERT_EQ(expected, searchNames(db, "granny smiht"));
+    ASSERT_EQ(10U, searchNames(db, "chicken smiht").size());
+
+    // A typo in a word other than the last matches nothing, and must not walk every name
+    // sharing the last word to find that out
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 20; ++i) {
+        ASSERT_TRUE(searchNames(db, "granyy smith").empty());
+        ASSERT_EQ(10U, searchNames(db, "chicken smiht").size());
+    }
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+}
+
+TEST(ItemSearchTests, StaysInSyncWithInserts) {
+    ItemDatabase db;
+    // Enough items to flush and merge runs several times
+    for (int i = 0; i < 5000; ++i) {
+        ASSERT_TRUE(db.insertItem({"Item " + std::to_string(i), Item::Sale_t::Unit, 1}));
+        if (i % 997 == 0) {
+            std::vector<std::string> expected = { "Item " + std::to_string(i) };
+            ASSERT_EQ(expected, searchNames(db, "item " + std::to_string(i), 1));
+        }
+    }
+    ASSERT_EQ(10U, searchNames(db, "it").size());
+
+    CatalogDelta delta;
+    delta.insertItem("Sparkling Water", Item::Sale_t::Unit, 1);
+    ASSERT_TRUE(db.applyDelta(delta));
+    std::vector<std::string> expected = { "Sparkling Water" };
+    ASSERT_EQ(expected, searchNames(db, "wat"));
+}
+
+/***************************** Frozen Catalog Tests **************************/
+
+// Database with one item of each special type
+static void fillFrozenDatabase(ItemDatabase& db) {
+    Item chips("Chips", Item::Sale_t::Unit, 3);
+    chips.setGtin(36000291452ULL);
+    db.insertItem(chips);
+    db.insertItem({"A very long product name that does not fit in small strings", Item::Sale_t::Unit, 2});
+    db.insertItem({"Soda", Item::Sale_t::Unit, 1.99});
+    db.insertItem({"Apple", Item::Sale_t::Weight, 1.49});
+    db.insertItem({"Bread", Item::Sale_t::Unit, 2.99});
+    db.setItemSpecial("Chips", 2U, 1U, 50, 6U);
+    db.setItemSpecial("Soda", 3U, 5.0f);
+    db.setItemSpecial("Apple", 1.0f, .5f, 100);
+    db.setItemMarkdown("Bread", .49);
+}
+
+TEST(FrozenCatalogTests, MatchesDatabasePricing) {
+    ItemDatabase db;
+    fillFrozenDatabase(db);
+    FrozenCatalog frozen(db);
+    ASSERT_EQ(db.getItems().size(), frozen.size());
+
+    for (const auto& item : db.getItems()) {
+        auto record = frozen.findItem(item.getName());
+        ASSERT_NE(nullptr, record);
+        ASSERT_EQ(item.getName(), frozen.getName(*record));
+        ASSERT_EQ(item.getSaleType(), record->saleType);
+
+        // Line prices match pricing through an order
+        for (float amount : {1.0f, 2.0f, 3.0f, 7.0f}) {
+            Order ord(db);
+            if (Item::Sale_t::Unit == item.getSaleType()) {
+                for (int n = 0; n < amount; ++n) {
+                    ord.ScanItem(item.getName());
+                }
+            } else {
+                ord.ScanItem(item.getName(), amount * .75f);
+                amount *= .75f;
+            }
+            ASSERT_EQ(ord.getTotalPrice(), FrozenCatalog::calcPrice(*record, amount));
+        }
+    }
+    ASSERT_EQ(nullptr, frozen.findItem("Salsa"));
+    ASSERT_EQ("Chips", frozen.getName(*frozen.findItemByGtin(36000291452ULL)));
+    ASSERT_EQ(nullptr, frozen.findItemByGtin(12345678905ULL));
+}
+
+TEST(FrozenCatalogTests, SaveAndLoad) {
+    ItemDatabase db;
+    fillFrozenDatabase(db);
+    FrozenCatalog frozen(db);
+
+    std::string path = ::testing::TempDir() + "frozen_catalog.bin";
+    ASSERT_TRUE(frozen.save(path));
+
+    FrozenCatalog loaded;
+    ASSERT_TRUE(loaded.load(path));
+    ASSERT_EQ(frozen.size(), loaded.size());
+    auto record = loaded.findItem("Soda");
+    ASSERT_NE(nullptr, record);
+    ASSERT_FLOAT_EQ(5.0 + 1.99, FrozenCatalog::calcPrice(*record, 4));
+    ASSERT_EQ("Chips", loaded.getName(*loaded.findItemByGtin(36000291452ULL)));
+
+    ASSERT_FALSE(loaded.load(path + ".missing"));
+    ASSERT_EQ(frozen.size(), loaded.size());
+}
+
+/***************************** Pricing Service Tests *************************/
+
+TEST(PricingServiceTests, PipelinedRequests) {
+    using namespace PricingProtocol;
+    ItemDatabase db;
+    db.insertItem({"Chips", Item::Sale_t::Unit, 3});
+    db.insertItem({"Apple", Item::Sale_t::Weight, 2});
+    db.setItemSpecial("Chips", 1U, 1U, 100);
+    PricingService service(db);
+
+    // Batch of requests across two sessions sent without waiting for responses
+    std::string req;
+    encodeRequest(req, Op_t::Open, 1);
+    encodeRequest(req, Op_t::Open, 2);
+    encodeRequest(req, Op_t::ScanUnit, 1, "Chips");
+    encodeRequest(req, Op_t::ScanUnit, 1, "Chips");
+    encodeRequest(req, Op_t::ScanWeight, 2, "Apple", 0, 1.5);
+    encodeRequest(req, Op_t::ScanUnit, 2, "Unknown");
+    encodeRequest(req, Op_t::RemoveWeight, 2, "Apple", 0, .5);
+    encodeRequest(req, Op_t::Close, 1);
+    encodeRequest(req, Op_t::Total, 1);
+
+    std::string rsp;
+    ASSERT_EQ(req.size(), service.handleRequests(1, req.data(), req.size(), rsp));
+    ASSERT_EQ(9 * sizeof(Response), rsp.size());
+
+    ASSERT_EQ(Status_t::Ok, decodeResponse(rsp, 0).status);
+    ASSERT_FLOAT_EQ(3, decodeResponse(rsp, 2).total);
+    ASSERT_FLOAT_EQ(3, decodeResponse(rsp, 3).total);
+    ASSERT_FLOAT_EQ(3, decodeResponse(rsp, 3).savings);
+    ASSERT_FLOAT_EQ(3, decodeResponse(rsp, 4).total);
+    ASSERT_EQ(Status_t::Failed, decodeResponse(rsp, 5).status);
+    ASSERT_FLOAT_EQ(2, decodeResponse(rsp, 6).total);
+    ASSERT_EQ(Status_t::Ok, decodeResponse(rsp, 7).status);
+    ASSERT_FLOAT_EQ(3, decodeResponse(rsp, 7).total);
+    ASSERT_EQ(Status_t::UnknownSession, decodeResponse(rsp, 8).status);
+    ASSERT_EQ(1U, service.getNumSessions());
+}
+
+TEST(PricingServiceTests, PartialRequestsWaitForRemainder) {
+    using namespace PricingProtocol;
+    ItemDatabase db;
+    db.insertItem({"Chips", Item::Sale_t::Unit, 3});
+    PricingService service(db);
+
+    std::string req;
+    encodeRequest(req, Op_t::Open, 7);
+    encodeRequest(req, Op_t::ScanUnit, 7, "Chips");
+
+    // Header of the scan is split across two reads
+    std::string rsp;
+    std::size_t split = sizeof(RequestHeader) + 5;
+    ASSERT_EQ(sizeof(RequestHeader), service.handleRequests(1, req.data(), split, rsp));
+    ASSERT_EQ(1 * sizeof(Response), rsp.size());
+
+    std::string rest = req.substr(sizeof(RequestHeader));
+    ASSERT_EQ(rest.size(), service.handleRequests(1, rest.data(), rest.size(), rsp));
+    ASSERT_EQ(2 * sizeof(Response), rsp.size());
+    ASSERT_FLOAT_EQ(3, decodeResponse(rsp, 1).total);
+}
+
+TEST(PricingServiceTests, SessionsBelongToClient) {
+    using namespace PricingProtocol;
+    ItemDatabase db;
+    db.insertItem({"Chips", Item::Sale_t::Unit, 3});
+    PricingService service(db);
+
+    // Both clients pick session 1, each only reaches its own order
+    std::string req, rsp;
+    encodeRequest(req, Op_t::Open, 1);
+    encodeRequest(req, Op_t::ScanUnit, 1, "Chips");
+    ASSERT_EQ(req.size(), service.handleRequests(10, req.data(), req.size(), rsp));
+    ASSERT_EQ(req.size(), service.handleRequests(11, req.data(), req.size(), rsp));
+    ASSERT_EQ(2U, service.getNumSessions());
+
+    std::string close;
+    encodeRequest(close, Op_t::Close, 1);
+    ASSERT_EQ(close.size(), service.handleRequests(11, close.data(), close.size(), rsp));
+    ASSERT_FLOAT_EQ(3, decodeResponse(rsp, 4).total);
+    ASSERT_EQ(close.size(), service.handleRequests(12, close.data(), close.size(), rsp));
+    ASSERT_EQ(Status_t::UnknownSession, decodeResponse(rsp, 5).status);
+    ASSERT_EQ(1U, service.getNumSessions());
+
+    // A client that disconnects without closing leaves no orders behind
+    service.closeClient(10);
+    ASSERT_EQ(0U, service.getNumSessions());
+}
+
+TEST(PricingServiceTests, SocketAnswersHalfClosedClient) {
+    using namespace PricingProtocol;
+    ItemDatabase db;
+    db.insertItem({"Chips", Item::Sale_t::Unit, 1});
+    PricingService service(db);
+    const std::string path = "/tmp/pricing-test-" + std::to_string(getpid()) + ".sock";
+    std::thread server([&]() { service.run(path); });
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    int fd = -1;
+    for (int attempt = 0; attempt < 500 && fd < 0; ++attempt) {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            close(fd);
+            fd = -1;
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+    ASSERT_GE(fd, 0);
+
+    // Pipeline more responses than the socket buffers but less than the pending limit, then shut down writing before reading
+    constexpr uint32_t numScans = 62000;
+    std::string req;
+    encodeRequest(req, Op_t::Open, 1);
+    for (uint32_t i = 0; i < numScans; ++i) {
+        encodeRequest(req, Op_t::ScanUnit, 1, "Chips");
+    }
+    encodeRequest(req, Op_t::Total, 1);
+    for (std::size_t sent = 0; sent < req.size();) {
+        ssize_t n = send(fd, req.data() + sent, req.size() - sent, MSG_NOSIGNAL);
+        ASSERT_GT(n, 0);
+        sent += static_cast<std::size_t>(n);
+    }
+    ASSERT_EQ(0, shutdown(fd, SHUT_WR));
+
+    std::string rsp;
+    char buf[64 * 1024];
+    ssize_t n;
+    while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) {
+        rsp.append(buf, static_cast<std::size_t>(n));
+    }
+    close(fd);
+    service.stop();
+    server.join();
+
+    ASSERT_EQ((numScans + 2) * sizeof(Response), rsp.size());
+    ASSERT_EQ(Status_t::Ok, decodeResponse(rsp, numScans + 1).status);
+    ASSERT_FLOAT_EQ(numScans, decodeResponse(rsp, numScans + 1).total);
+    ASSERT_EQ(0U, service.getNumSessions());
+}
+
 /***************************** Integration Tess ******************************/
 
 // Integration test with shopping cart consisting of multiple items, specials, markdown, etc